@@ -128,14 +128,60 @@ int dmeventd_lvm2_run(const char *cmdline)
 	return (lvm2_run(_lvm_handle, cmdline) == LVM2_COMMAND_SUCCEEDED);
 }
 
+/*
+ * Resolve internal "_dmeventd_*" name to its configured value.
+ */
+static const char *_internal_setting(const char *cmd)
+{
+	struct env_data *env_data;
+	const char *env = NULL;
+
+	/* Use _register_mutex for _env_registry/_mem_pool access,
+	 * _event_mutex only for lvm2_run() on cache miss. */
+	pthread_mutex_lock(&_register_mutex);
+	dm_list_iterate_items(env_data, &_env_registry)
+		if (!strcmp(cmd, env_data->cmd)) {
+			env = env_data->data;
+			break;
+		}
+	pthread_mutex_unlock(&_register_mutex);
+
+	if (env)
+		return env;
+
+	/* run lvm2 command to find out setting value */
+	dmeventd_lvm2_lock();
+	if (!dmeventd_lvm2_run(cmd) ||
+	    !(env = getenv(cmd))) {
+		dmeventd_lvm2_unlock();
+		log_error("Unable to find configured command.");
+		return NULL;
+	}
+	/* output of internal command passed via env var */
+	dmeventd_lvm2_unlock();
+
+	pthread_mutex_lock(&_register_mutex);
+	if (!(env = dm_pool_strdup(_mem_pool, env)) ||
+	    !(env_data = dm_pool_zalloc(_mem_pool, sizeof(*env_data))) ||
+	    !(env_data->cmd = dm_pool_strdup(_mem_pool, cmd))) {
+		pthread_mutex_unlock(&_register_mutex);
+		log_error("Unable to allocate env memory.");
+		return NULL;
+	}
+	env_data->data = env;
+	/* add to ENVVAR registry */
+	dm_list_add(&_env_registry, &env_data->list);
+	pthread_mutex_unlock(&_register_mutex);
+
+	return env;
+}
+
 int dmeventd_lvm2_command(struct dm_pool *mem, char *buffer, size_t size,
 			  const char *cmd, const char *device)
 {
 	static const char _internal_prefix[] =  "_dmeventd_";
 	char *vg = NULL, *lv = NULL, *layer;
 	int r;
-	struct env_data *env_data;
-	const char *env = NULL;
 
 	if (!dm_split_lvm_name(mem, device, &vg, &lv, &layer)) {
 		log_error("Unable to determine VG name from %s.",
@@ -148,45 +194,10 @@ int dmeventd_lvm2_command(struct dm_pool *mem, char *buffer, size_t size,
 	    (layer = strstr(lv, "_mlog")))
 		*layer = '\0';
 
-	if (!strncmp(cmd, _internal_prefix, sizeof(_internal_prefix) - 1)) {
-		/* Resolve internal command name to actual command string.
-		 * Use _register_mutex for _env_registry/_mem_pool access,
-		 * _event_mutex only for lvm2_run() on cache miss. */
-		pthread_mutex_lock(&_register_mutex);
-		dm_list_iterate_items(env_data, &_env_registry)
-			if (!strcmp(cmd, env_data->cmd)) {
-				env = env_data->data;
-				break;
-			}
-		pthread_mutex_unlock(&_register_mutex);
-
-		if (!env) {
-			/* run lvm2 command to find out setting value */
-			dmeventd_lvm2_lock();
-			if (!dmeventd_lvm2_run(cmd) ||
-			    !(env = getenv(cmd))) {
-				dmeventd_lvm2_unlock();
-				log_error("Unable to find configured command.");
-				return 0;
-			}
-			/* output of internal command passed via env var */
-			dmeventd_lvm2_unlock();
-
-			pthread_mutex_lock(&_register_mutex);
-			if (!(env = dm_pool_strdup(_mem_pool, env)) ||
-			    !(env_data = dm_pool_zalloc(_mem_pool, sizeof(*env_data))) ||
-			    !(env_data->cmd = dm_pool_strdup(_mem_pool, cmd))) {
-				pthread_mutex_unlock(&_register_mutex);
-				log_error("Unable to allocate env memory.");
-				return 0;
-			}
-			env_data->data = env;
-			/* add to ENVVAR registry */
-			dm_list_add(&_env_registry, &env_data->list);
-			pthread_mutex_unlock(&_register_mutex);
-		}
-		cmd = env;
-	}
+	/* Resolve internal command name to actual command string. */
+	if (!strncmp(cmd, _internal_prefix, sizeof(_internal_prefix) - 1) &&
+	    !(cmd = _internal_setting(cmd)))
+		return 0;
 
 	r = dm_snprintf(buffer, size, "%s %s/%s", cmd, vg, lv);
 
@@ -199,3 +210,24 @@ int dmeventd_lvm2_command(struct dm_pool *mem, char *buffer, size_t size,
 
 	return 1;
 }
+
+int dmeventd_lvm2_setting_int(const char *name, int *value)
+{
+	const char *str;
+	char *end;
+	long v;
+
+	if (!(str = _internal_setting(name)))
+		return 0;
+
+	errno = 0;
+	v = strtol(str, &end, 10);
+	if (errno || (end == str) || *end || (v < INT_MIN) || (v > INT_MAX)) {
+		log_error("Invalid value %s of %s.", str, name);
+		return 0;
+	}
+
+	*value = (int) v;
+
+	return 1;
+}
@@ -41,6 +41,9 @@ struct dm_pool *dmeventd_lvm2_pool(void);
 int dmeventd_lvm2_command(struct dm_pool *mem, char *buffer, size_t size,
 			  const char *cmd, const char *device);
 
+/* Integer value of internal "_dmeventd_*" setting */
+int dmeventd_lvm2_setting_int(const char *name, int *value);
+
 #define dmeventd_lvm2_run_with_lock(cmdline) \
 	({\
 		int rc;\
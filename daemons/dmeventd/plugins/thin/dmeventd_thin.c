@@ -15,9 +15,11 @@
 #include "lib/misc/lib.h"
 #include "daemons/dmeventd/plugins/lvm2/dmeventd_lvm.h"
 #include "daemons/dmeventd/libdevmapper-event.h"
+#include "lib/config/defaults.h"
 
 #include <sys/wait.h>
 #include <stdarg.h>
+#include <time.h>
 
 /* TODO - move this mountinfo code into library to be reusable */
 #ifdef __linux__
@@ -43,6 +45,15 @@
 
 #define THIN_DEBUG 0
 
+/* Number of usage samples used for time-to-full forecast (~2 mins with 10s delay) */
+#define FORECAST_SAMPLES	12
+
+struct forecast_sample {
+	time_t stamp;
+	uint64_t used_data_blocks;
+	uint64_t used_metadata_blocks;
+};
+
 struct dso_state {
 	struct dm_pool *mem;
 	dm_percent_t metadata_percent_check;
@@ -58,6 +69,12 @@ struct dso_state {
 	pid_t pid;
 	const char *argv[3];
 	char *cmd_str;
+	int forecast_seconds;		/* dmeventd/thin_forecast */
+	int forecast_triggered;
+	unsigned nr_samples;
+	unsigned next_sample;
+	struct forecast_sample samples[FORECAST_SAMPLES];
+	char *forecast_path;
 };
 
 DM_EVENT_LOG_FN("thin")
@@ -154,6 +171,83 @@ static int _wait_for_pid(struct dso_state *state)
 	return 1;
 }
 
+static time_t _now(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts))
+		return time(NULL);
+
+	return ts.tv_sec;
+}
+
+/*
+ * Seconds until 'total' is reached at the rate seen since the oldest
+ * remembered sample or -1 when usage is not growing.
+ */
+static int64_t _time_to_full(uint64_t old_used, uint64_t used, uint64_t total,
+			     time_t elapsed)
+{
+	if ((elapsed <= 0) || (used <= old_used))
+		return -1;
+
+	if (used >= total)
+		return 0;
+
+	return (int64_t) ((total - used) * (uint64_t) elapsed / (used - old_used));
+}
+
+/*
+ * Remember current usage and publish the forecast in THIN_FORECAST_DIR
+ * where lvs and 'lvextend --use-policies' can read it.
+ */
+static void _update_forecast(struct dso_state *state,
+			     const struct dm_status_thin_pool *tps,
+			     int64_t *data_seconds, int64_t *metadata_seconds)
+{
+	struct forecast_sample *oldest, *sample;
+	char tmp_path[PATH_MAX];
+	time_t now = _now();
+	FILE *fp;
+
+	*data_seconds = *metadata_seconds = -1;
+
+	oldest = &state->samples[(state->nr_samples < FORECAST_SAMPLES) ? 0 : state->next_sample];
+	if (state->nr_samples) {
+		*data_seconds = _time_to_full(oldest->used_data_blocks, tps->used_data_blocks,
+					      tps->total_data_blocks, now - oldest->stamp);
+		*metadata_seconds = _time_to_full(oldest->used_metadata_blocks, tps->used_metadata_blocks,
+						  tps->total_metadata_blocks, now - oldest->stamp);
+	}
+
+	sample = &state->samples[state->next_sample];
+	sample->stamp = now;
+	sample->used_data_blocks = tps->used_data_blocks;
+	sample->used_metadata_blocks = tps->used_metadata_blocks;
+	state->next_sample = (state->next_sample + 1) % FORECAST_SAMPLES;
+	if (state->nr_samples < FORECAST_SAMPLES)
+		state->nr_samples++;
+
+	if (!state->forecast_path)
+		return;
+
+	if (dm_snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", state->forecast_path) < 0)
+		return;
+
+	if (!(fp = fopen(tmp_path, "w"))) {
+		log_sys_debug("fopen", tmp_path);
+		return;
+	}
+
+	fprintf(fp, "%lld %lld %lld\n", (long long) time(NULL),
+		(long long) *data_seconds, (long long) *metadata_seconds);
+
+	if (fclose(fp))
+		log_sys_debug("fclose", tmp_path);
+	else if (rename(tmp_path, state->forecast_path))
+		log_sys_debug("rename", state->forecast_path);
+}
+
 void process_event(struct dm_task *dmt,
 		   enum dm_event_mask evmask,
 		   void **user)
@@ -167,6 +261,7 @@ void process_event(struct dm_task *dmt,
 	char *params;
 	int needs_policy = 0;
 	struct dm_task *new_dmt = NULL;
+	int64_t data_seconds, metadata_seconds;
 
 #if THIN_DEBUG
 	log_debug("Watch for tp-data:%.2f%%  tp-metadata:%.2f%%.",
@@ -236,14 +331,23 @@ void process_event(struct dm_task *dmt,
 		state->metadata_percent_check = CHECK_MINIMUM;
 		state->known_metadata_size = tps->total_metadata_blocks;
 		state->fails = 0;
+		state->nr_samples = state->next_sample = 0;
+		state->forecast_triggered = 0;
 	}
 
 	if (state->known_data_size != tps->total_data_blocks) {
 		state->data_percent_check = CHECK_MINIMUM;
 		state->known_data_size = tps->total_data_blocks;
 		state->fails = 0;
+		state->nr_samples = state->next_sample = 0;
+		state->forecast_triggered = 0;
 	}
 
+	if (state->forecast_seconds > 0)
+		_update_forecast(state, tps, &data_seconds, &metadata_seconds);
+	else
+		data_seconds = metadata_seconds = -1;
+
 	/*
 	 * Trigger action when threshold boundary is exceeded.
 	 * Report 80% threshold warning when it's used above 80%.
@@ -280,6 +384,21 @@ void process_event(struct dm_task *dmt,
 	} else
 		state->data_percent_check = CHECK_MINIMUM;
 
+	/* Run action once per pool size when it is predicted to be full soon */
+	if ((state->forecast_seconds > 0) && !state->forecast_triggered && !needs_policy) {
+		if ((state->data_percent > CHECK_MINIMUM) && (data_seconds >= 0) &&
+		    (data_seconds <= state->forecast_seconds)) {
+			log_info("Thin pool %s data is predicted to be full in " FMTd64 " seconds.",
+				 device, data_seconds);
+			needs_policy = state->forecast_triggered = 1;
+		} else if ((state->metadata_percent > CHECK_MINIMUM) && (metadata_seconds >= 0) &&
+			   (metadata_seconds <= state->forecast_seconds)) {
+			log_info("Thin pool %s metadata is predicted to be full in " FMTd64 " seconds.",
+				 device, metadata_seconds);
+			needs_policy = state->forecast_triggered = 1;
+		}
+	}
+
 	/* Reduce number of _use_policy() calls by power-of-2 factor till frequency of MAX_FAILS is reached.
 	 * Avoids too high number of error retries, yet shows some status messages in log regularly.
 	 * i.e. PV could have been pvmoved and VG/LV was locked for a while...
@@ -342,7 +461,7 @@ static void _restore_thread_signals(struct dso_state *state)
 }
 
 int register_device(const char *device_name,
-		    const char *uuid __attribute__((unused)),
+		    const char *uuid,
 		    int major __attribute__((unused)),
 		    int minor __attribute__((unused)),
 		    void **user)
@@ -384,6 +503,16 @@ int register_device(const char *device_name,
 	} else /* Unsupported command format */
 		goto inval;
 
+	if (!dmeventd_lvm2_setting_int("_dmeventd_thin_forecast", &state->forecast_seconds))
+		state->forecast_seconds = 0;
+
+	/* Forecast is published only when enabled */
+	if ((state->forecast_seconds > 0) && uuid && *uuid &&
+	    (dm_snprintf(cmd_str, sizeof(cmd_str), "%s/%s", THIN_FORECAST_DIR, uuid) > 0) &&
+	    dm_create_dir(THIN_FORECAST_DIR) &&
+	    !(state->forecast_path = dm_pool_strdup(state->mem, cmd_str)))
+		log_warn("WARNING: Failed to copy forecast path.");
+
 	state->max_fails = 1;
 	state->pid = -1;
 	*user = state;
@@ -430,6 +559,9 @@ int unregister_device(const char *device_name,
 
 	_restore_thread_signals(state);
 
+	if (state->forecast_path && unlink(state->forecast_path) && (errno != ENOENT))
+		log_sys_debug("unlink", state->forecast_path);
+
 	dmeventd_lvm2_exit_with_pool(state);
 
 	return 1;
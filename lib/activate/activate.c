@@ -374,6 +374,11 @@ int lv_activate_with_filter(struct cmd_context *cmd, const char *lvid_s, int exc
 {
 	return 1;
 }
+int lv_activate_list(struct cmd_context *cmd, struct dm_list *lvs, unsigned *activated)
+{
+	*activated = dm_list_size(lvs);
+	return 1;
+}
 int lv_mknodes(struct cmd_context *cmd, const struct logical_volume *lv)
 {
 	return 1;
@@ -2775,6 +2780,123 @@ int lv_activate_with_filter(struct cmd_context *cmd, const char *lvid_s, int exc
 	return 1;
 }
 
+/*
+ * Activate LVs accepted by lv_can_activate_in_batch() with one deptree.
+ * LVs needing error reporting from the checks in _lv_activate() take
+ * the single LV path.  When the shared tree fails, LVs are retried one
+ * by one so the failure is attributed to the right LV.
+ */
+int lv_activate_list(struct cmd_context *cmd, struct dm_list *lvs, unsigned *activated)
+{
+	struct dm_list batch, failed;
+	struct lv_activate_item *item, *tmp;
+	struct lv_list *lvl;
+	const struct logical_volume *lv;
+	struct dev_manager *dm;
+	struct lvinfo info;
+	int r = 1, batch_ok = 0;
+
+	*activated = 0;
+
+	if (!activation()) {
+		*activated = dm_list_size(lvs);
+		return 1;
+	}
+
+	dm_list_init(&batch);
+	dm_list_init(&failed);
+
+	dm_list_iterate_items(lvl, lvs) {
+		/* Like activate_lv(), activate the committed metadata */
+		if (!(lv = lv_committed(lvl->lv))) {
+			r = 0;
+			continue;
+		}
+
+		if (!_passes_activation_filter(cmd, lv)) {
+			log_verbose("Not activating %s since it does not pass "
+				    "activation filter.", display_lvname(lv));
+			(*activated)++;
+			continue;
+		}
+
+		if (!lv_can_activate_in_batch(lv) || lv_is_partial(lv) ||
+		    lv_has_unknown_segments(lv) || test_mode()) {
+			if (activate_lv(cmd, lv))
+				(*activated)++;
+			else
+				r = 0;
+			continue;
+		}
+
+		if (!(item = dm_pool_zalloc(cmd->mem, sizeof(*item))))
+			return_0;
+
+		item->lv = lv;
+		item->laopts.noscan = (lv->status & LV_NOSCAN) ? 1 : 0;
+		item->laopts.temporary = (lv->status & LV_TEMPORARY) ? 1 : 0;
+		item->laopts.read_only = _passes_readonly_filter(cmd, lv);
+
+		if (!lv_info_with_name_check(cmd, lv, 0, &info)) {
+			stack;
+			r = 0;
+			continue;
+		}
+
+		if (info.exists && !info.suspended && info.live_table &&
+		    (info.read_only == read_only_lv(lv, &item->laopts, NULL))) {
+			log_debug_activation("LV %s is already active.", display_lvname(lv));
+			(*activated)++;
+			continue;
+		}
+
+		log_debug_activation("Activating %s%s%s%s.", display_lvname(lv),
+				     item->laopts.read_only ? " read-only" : "",
+				     item->laopts.noscan ? " noscan" : "",
+				     item->laopts.temporary ? " temporary" : "");
+
+		lv_calculate_readahead(lv, NULL);
+		dm_list_add(&batch, &item->list);
+	}
+
+	if (dm_list_empty(&batch))
+		return r;
+
+	/* Pre-create udev cookie shared by the whole tree */
+	if (!fs_ensure_cookie(cmd))
+		return_0;
+
+	critical_section_inc(cmd, "activating");
+	item = dm_list_item(dm_list_first(&batch), struct lv_activate_item);
+	if ((dm = dev_manager_create(cmd, item->lv->vg->name, 1))) {
+		if (!(batch_ok = dev_manager_activate_lvs(dm, &batch)))
+			stack;
+		dev_manager_destroy(dm);
+	}
+
+	if (!batch_ok) {
+		log_debug_activation("Retrying activation of %u LVs one by one.",
+				     dm_list_size(&batch));
+		dm_list_iterate_items_safe(item, tmp, &batch)
+			if (!_lv_activate_lv(item->lv, &item->laopts)) {
+				stack;
+				dm_list_move(&failed, &item->list);
+			}
+	}
+	critical_section_dec(cmd, "activated");
+
+	if (!dm_list_empty(&failed))
+		r = 0;
+
+	dm_list_iterate_items(item, &batch) {
+		(*activated)++;
+		if (!monitor_dev_for_events(cmd, item->lv, &item->laopts, 1))
+			stack;
+	}
+
+	return r;
+}
+
 int lv_mknodes(struct cmd_context *cmd, const struct logical_volume *lv)
 {
 	int r;
@@ -2965,7 +3087,7 @@ int activate_lv_temporary(struct cmd_context *cmd, struct logical_volume *lv)
 
 int activate_lv(struct cmd_context *cmd, const struct logical_volume *lv)
 {
-	const struct logical_volume *active_lv;
+	const struct logical_volume *active_lv, *lv_com;
 	int ret;
 
 	/*
@@ -2984,50 +3106,103 @@ int activate_lv(struct cmd_context *cmd, const struct logical_volume *lv)
 		goto out;
 	}
 
+	if (!(lv_com = lv_committed(lv))) {
+		ret = 0;
+		goto_out;
+	}
+
 	ret = lv_activate_with_filter(cmd, NULL, 0,
 				      (lv->status & LV_NOSCAN) ? 1 : 0,
 				      (lv->status & LV_TEMPORARY) ? 1 : 0,
-				      lv_committed(lv));
+				      lv_com);
 out:
 	return ret;
 }
 
+/*
+ * Visible LVs built only from PV areas, with nothing stacked on them
+ * and no pending snapshot, merge or pvmove, map to a single dm device
+ * and can share one activation deptree with other such LVs.
+ */
+int lv_can_activate_in_batch(const struct logical_volume *lv)
+{
+	const struct lv_segment *seg;
+	uint32_t s;
+
+	if (!lv_is_visible(lv) || lv_is_pvmove(lv) || lv_is_locked(lv) ||
+	    lv_is_origin(lv) || lv_is_cow(lv) || lv_is_merging_origin(lv) ||
+	    lv_is_external_origin(lv) || lv_is_historical(lv) ||
+	    !dm_list_empty(&lv->segs_using_this_lv))
+		return 0;
+
+	dm_list_iterate_items(seg, &lv->segments) {
+		if (!seg_is_striped(seg))
+			return 0;
+		for (s = 0; s < seg->area_count; s++)
+			if (seg_type(seg, s) != AREA_PV)
+				return 0;
+	}
+
+	return 1;
+}
+
 int deactivate_lv(struct cmd_context *cmd, const struct logical_volume *lv)
 {
 	int ret;
 
-	ret = lv_deactivate(cmd, NULL, lv_committed(lv));
+	if (!(lv = lv_committed(lv)))
+		return_0;
+
+	ret = lv_deactivate(cmd, NULL, lv);
 
 	return ret;
 }
 
 int suspend_lv(struct cmd_context *cmd, const struct logical_volume *lv)
 {
+	const struct logical_volume *lv_old;
 	int ret;
 
+	/* Import before the critical section, nothing is parsed while suspended */
+	if (!vg_import_written(lv->vg) ||
+	    !(lv_old = lv_committed(lv)))
+		return_0;
+
 	critical_section_inc(cmd, "locking for suspend");
 
-	ret = lv_suspend_if_active(cmd, NULL, 0, 0, lv_committed(lv), lv);
+	ret = lv_suspend_if_active(cmd, NULL, 0, 0, lv_old, lv);
 
 	return ret;
 }
 
 int suspend_lv_origin(struct cmd_context *cmd, const struct logical_volume *lv)
 {
+	const struct logical_volume *lv_old;
 	int ret;
 
+	/* Import before the critical section, nothing is parsed while suspended */
+	if (!vg_import_written(lv->vg) ||
+	    !(lv_old = lv_committed(lv)))
+		return_0;
+
 	critical_section_inc(cmd, "locking for suspend");
 
-	ret = lv_suspend_if_active(cmd, NULL, 1, 0, lv_committed(lv), lv);
+	ret = lv_suspend_if_active(cmd, NULL, 1, 0, lv_old, lv);
 
 	return ret;
 }
 
 int resume_lv(struct cmd_context *cmd, const struct logical_volume *lv)
 {
+	const struct logical_volume *lv_com;
 	int ret;
 
-	ret = lv_resume_if_active(cmd, NULL, 0, 0, 0, lv_committed(lv));
+	/* Always leave critical section */
+	if (!(lv_com = lv_committed(lv))) {
+		stack;
+		ret = 0;
+	} else
+		ret = lv_resume_if_active(cmd, NULL, 0, 0, 0, lv_com);
 
 	critical_section_dec(cmd, "unlocking on resume");
 
@@ -3036,9 +3211,15 @@ int resume_lv(struct cmd_context *cmd, const struct logical_volume *lv)
 
 int resume_lv_origin(struct cmd_context *cmd, const struct logical_volume *lv)
 {
+	const struct logical_volume *lv_com;
 	int ret;
 
-	ret = lv_resume_if_active(cmd, NULL, 1, 0, 0, lv_committed(lv));
+	/* Always leave critical section */
+	if (!(lv_com = lv_committed(lv))) {
+		stack;
+		ret = 0;
+	} else
+		ret = lv_resume_if_active(cmd, NULL, 1, 0, 0, lv_com);
 
 	critical_section_dec(cmd, "unlocking on resume");
 
@@ -3047,9 +3228,15 @@ int resume_lv_origin(struct cmd_context *cmd, const struct logical_volume *lv)
 
 int revert_lv(struct cmd_context *cmd, const struct logical_volume *lv)
 {
+	const struct logical_volume *lv_com;
 	int ret;
 
-	ret = lv_resume_if_active(cmd, NULL, 0, 0, 1, lv_committed(lv));
+	/* Always leave critical section */
+	if (!(lv_com = lv_committed(lv))) {
+		stack;
+		ret = 0;
+	} else
+		ret = lv_resume_if_active(cmd, NULL, 0, 0, 1, lv_com);
 
 	critical_section_dec(cmd, "unlocking on revert");
 
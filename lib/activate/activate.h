@@ -92,6 +92,13 @@ struct lv_activate_opts {
 	const struct logical_volume *component_lv;
 };
 
+/* Entry of a list of LVs activated through a single deptree */
+struct lv_activate_item {
+	struct dm_list list;
+	const struct logical_volume *lv;
+	struct lv_activate_opts laopts;
+};
+
 void set_activation(int act, int silent);
 int activation(void);
 
@@ -133,11 +140,13 @@ int lv_activate(struct cmd_context *cmd, const char *lvid_s, int exclusive,
 		int noscan, int temporary, const struct logical_volume *lv);
 int lv_activate_with_filter(struct cmd_context *cmd, const char *lvid_s, int exclusive,
 			    int noscan, int temporary, const struct logical_volume *lv);
+int lv_activate_list(struct cmd_context *cmd, struct dm_list *lvs, unsigned *activated);
 int lv_deactivate(struct cmd_context *cmd, const char *lvid_s, const struct logical_volume *lv);
 
 int lv_mknodes(struct cmd_context *cmd, const struct logical_volume *lv);
 
 int activate_lv(struct cmd_context *cmd, const struct logical_volume *lv);
+int lv_can_activate_in_batch(const struct logical_volume *lv);
 int activate_lv_temporary(struct cmd_context *cmd, struct logical_volume *lv);
 int deactivate_lv(struct cmd_context *cmd, const struct logical_volume *lv);
 int suspend_lv(struct cmd_context *cmd, const struct logical_volume *lv);
@@ -27,6 +27,7 @@
 #include "lib/misc/lvm-exec.h"
 #include "lib/datastruct/str_list.h"
 #include "lib/misc/lvm-signal.h"
+#include "lib/misc/lvm-perf.h"
 
 #include <limits.h>
 #include <dirent.h>
@@ -4185,11 +4186,14 @@ static int _tree_action(struct dev_manager *dm, const struct logical_volume *lv,
 	/* Drop any cache before DM table manipulation within locked section
 	 * TODO: check if it makes sense to manage cache within lock */
 	dm_devs_cache_destroy();
+	dev_cache_invalidate_sysfs(0);
 
-	dtree = _create_partial_dtree(dm, lv, laopts->origin_only);
+	perf_phase_start(PERF_PHASE_ACTIVATION);
 
-	if (!dtree)
+	if (!(dtree = _create_partial_dtree(dm, lv, laopts->origin_only))) {
+		perf_phase_end(PERF_PHASE_ACTIVATION);
 		return_0;
+	}
 
 	if (!(root = dm_tree_find_node(dtree, 0, 0))) {
 		log_error("Lost dependency tree root node.");
@@ -4279,6 +4283,8 @@ out:
 out_no_root:
 	dm_tree_free(dtree);
 
+	perf_phase_end(PERF_PHASE_ACTIVATION);
+
 	return r;
 }
 
@@ -4295,6 +4301,90 @@ int dev_manager_activate(struct dev_manager *dm, const struct logical_volume *lv
 	return 1;
 }
 
+/*
+ * Activate a list of LVs from one VG through a single deptree.
+ * All new tables are loaded by one preload pass and resumed in
+ * dependency order under the shared udev cookie.  Callers pass
+ * only LVs without layered sub-devices, so no CLEAN tree is needed.
+ */
+int dev_manager_activate_lvs(struct dev_manager *dm, struct dm_list *lvs)
+{
+	const size_t DLID_SIZE = ID_LEN + sizeof(UUID_PREFIX) - 1;
+	struct lv_activate_item *item;
+	struct dm_tree *dtree;
+	struct dm_tree_node *root;
+	char *dlid;
+	int r = 0;
+
+	if (dm_list_empty(lvs))
+		return 1;
+
+	item = dm_list_item(dm_list_first(lvs), struct lv_activate_item);
+
+	log_debug_activation("Creating ACTIVATE tree for %u LVs in VG %s.",
+			     dm_list_size(lvs), item->lv->vg->name);
+
+	dm->activation = 1;
+	dm->suspend = 0;
+
+	dm_devs_cache_destroy();
+	dev_cache_invalidate_sysfs(0);
+
+	perf_phase_start(PERF_PHASE_ACTIVATION);
+
+	if (!(dtree = dm_tree_create())) {
+		log_debug_activation("Dtree creation failed for VG %s.",
+				     item->lv->vg->name);
+		perf_phase_end(PERF_PHASE_ACTIVATION);
+		return 0;
+	}
+
+	_set_optional_uuid_suffixes(dtree);
+
+	dm_list_iterate_items(item, lvs)
+		if (!_add_lv_to_dtree(dm, dtree, item->lv, 0)) {
+			stack;
+			goto out_no_root;
+		}
+
+	if (!(root = dm_tree_find_node(dtree, 0, 0))) {
+		log_error("Lost dependency tree root node.");
+		goto out_no_root;
+	}
+
+	/* Restore fs cookie */
+	dm_tree_set_cookie(root, fs_get_cookie());
+
+	/* Only the "LVM-" plus VG id part of the uuid is compared. */
+	item = dm_list_item(dm_list_first(lvs), struct lv_activate_item);
+	if (!(dlid = build_dm_uuid(dm->mem, item->lv, NULL)))
+		goto_out;
+
+	dm_list_iterate_items(item, lvs)
+		if (!_add_new_lv_to_dtree(dm, dtree, item->lv, &item->laopts, NULL))
+			goto_out;
+
+	if (!dm_tree_preload_children(root, dlid, DLID_SIZE))
+		goto_out;
+
+	if (!dm_tree_activate_children(root, dlid, DLID_SIZE))
+		goto_out;
+
+	if (!_create_lv_symlinks(dm, root))
+		log_warn("Failed to create symlinks for LVs in VG %s.", dm->vg_name);
+
+	r = 1;
+out:
+	/* Save fs cookie for udev settle, do not wait here */
+	fs_set_cookie(dm_tree_get_cookie(root));
+out_no_root:
+	dm_tree_free(dtree);
+
+	perf_phase_end(PERF_PHASE_ACTIVATION);
+
+	return r;
+}
+
 /* origin_only may only be set if we are resuming (not activating) an origin LV */
 int dev_manager_preload(struct dev_manager *dm, const struct logical_volume *lv,
 			struct lv_activate_opts *laopts, int *flush_required)
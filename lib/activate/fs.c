@@ -20,6 +20,7 @@
 #include "lib/misc/lvm-string.h"
 #include "lib/misc/lvm-file.h"
 #include "lib/mm/memlock.h"
+#include "lib/misc/lvm-perf.h"
 
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -502,8 +503,10 @@ void fs_unlock(void)
 		else
 			log_debug_activation("Syncing device names");
 		/* Wait for all processed udev devices */
+		perf_phase_start(PERF_PHASE_UDEV_WAIT);
 		if (!dm_udev_wait(_fs_cookie))
 			stack;
+		perf_phase_end(PERF_PHASE_UDEV_WAIT);
 		_fs_cookie = DM_COOKIE_AUTO_CREATE; /* Reset cookie */
 		dm_lib_release();
 		_pop_fs_ops();
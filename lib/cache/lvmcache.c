@@ -3000,6 +3000,20 @@ int lvmcache_vg_is_foreign(struct cmd_context *cmd, const char *vgname, const ch
 	return ret;
 }
 
+/*
+ * Returns the highest metadata seqno seen for the VG by the last scan,
+ * or 0 if the VG is not known.
+ */
+uint32_t lvmcache_vg_seqno(const char *vgname, const char *vgid)
+{
+	struct lvmcache_vginfo *vginfo;
+
+	if ((vginfo = lvmcache_vginfo_from_vgname(vgname, vgid)))
+		return vginfo->seqno;
+
+	return 0;
+}
+
 int lvmcache_vg_is_lockd_type(struct cmd_context *cmd, const char *vgname, const char *vgid)
 {
 	struct lvmcache_vginfo *vginfo;
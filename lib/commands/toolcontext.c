@@ -27,11 +27,13 @@
 #include "lib/format_text/format-text.h"
 #include "lib/mm/memlock.h"
 #include "lib/datastruct/str_list.h"
+#include "lib/datastruct/str_intern.h"
 #include "lib/metadata/segtype.h"
 #include "lib/cache/lvmcache.h"
 #include "lib/format_text/archiver.h"
 #include "lib/lvmpolld/lvmpolld-client.h"
 #include "lib/device/device_id.h"
+#include "lib/misc/lvm-perf.h"
 
 #include <locale.h>
 #include <sys/stat.h>
@@ -56,6 +58,32 @@
 
 static const size_t _linebuffer_size = 4096;
 
+/*
+ * Return a per-command shared copy of str.  Interned strings may be
+ * compared by pointer and stay valid until cmd_intern_reset(), which
+ * runs when the command's memory is released.
+ */
+const char *cmd_intern_str(struct cmd_context *cmd, const char *str)
+{
+	if (!cmd->str_intern && !(cmd->str_intern = str_intern_create()))
+		return_NULL;
+
+	return str_intern(cmd->str_intern, str);
+}
+
+void cmd_intern_reset(struct cmd_context *cmd)
+{
+	if (!cmd->str_intern)
+		return;
+
+	log_debug_mem("Interned %u strings, %u lookups shared.",
+		      str_intern_get_count(cmd->str_intern),
+		      str_intern_get_hits(cmd->str_intern));
+
+	str_intern_destroy(cmd->str_intern);
+	cmd->str_intern = NULL;
+}
+
 /*
  * Copy the input string, removing invalid characters.
  */
@@ -88,6 +116,36 @@ const char *system_id_from_string(struct cmd_context *cmd, const char *str)
 	return system_id;
 }
 
+/*
+ * Time spent in each startup phase is logged with -vvvv
+ * so command startup latency can be measured.  Command line
+ * debug settings are not known until the context exists, so
+ * the early phases are logged later by log_init_phases().
+ */
+static void _init_phase_done(struct cmd_context *cmd, perf_phase_t phase)
+{
+	perf_phase_end(phase);
+
+	if (cmd->init_phases_logged)
+		log_debug("Initialized %s in %" PRIu64 " us.",
+			  perf_phase_name(phase), perf_phase_usec(phase));
+}
+
+void log_init_phases(struct cmd_context *cmd)
+{
+	perf_phase_t phase;
+
+	if (cmd->init_phases_logged)
+		return;
+
+	for (phase = PERF_PHASE_CONFIG; phase <= PERF_PHASE_SEGTYPES; phase++)
+		if (perf_phase_calls(phase))
+			log_debug("Initialized %s in %" PRIu64 " us.",
+				  perf_phase_name(phase), perf_phase_usec(phase));
+
+	cmd->init_phases_logged = 1;
+}
+
 static const char *_read_system_id_from_file(struct cmd_context *cmd, const char *file)
 {
 	char *line = NULL;
@@ -1207,6 +1265,7 @@ static struct dev_filter *_init_filter_chain(struct cmd_context *cmd)
 	const struct dm_config_node *cn;
 	struct dev_filter *filters[MAX_FILTERS] = { 0 };
 	struct dev_filter *composite;
+	int use_cache = find_config_tree_bool(cmd, devices_regex_filter_cache_CFG, NULL);
 
 	/*
 	 * Filters listed in order: top one gets applied first.
@@ -1216,7 +1275,8 @@ static struct dev_filter *_init_filter_chain(struct cmd_context *cmd)
 
 	/* global regex filter. Optional. */
 	if ((cn = find_config_tree_node(cmd, devices_global_filter_CFG, NULL))) {
-		if (!(filters[nr_filt] = regex_filter_create(cn->v, 0, 1))) {
+		if (!(filters[nr_filt] = regex_filter_create(cn->v, 0, 1,
+								 use_cache ? GLOBAL_FILTER_CACHE_FILE : NULL))) {
 			log_error("Failed to create global regex device filter");
 			goto bad;
 		}
@@ -1225,7 +1285,8 @@ static struct dev_filter *_init_filter_chain(struct cmd_context *cmd)
 
 	/* regex filter. Optional. */
 	if ((cn = find_config_tree_node(cmd, devices_filter_CFG, NULL))) {
-		if (!(filters[nr_filt] = regex_filter_create(cn->v, 1, 0))) {
+		if (!(filters[nr_filt] = regex_filter_create(cn->v, 1, 0,
+								 use_cache ? FILTER_CACHE_FILE : NULL))) {
 			log_error("Failed to create regex device filter");
 			goto bad;
 		}
@@ -1326,6 +1387,8 @@ int init_filters(struct cmd_context *cmd, unsigned load_persistent_cache)
 		return 0;
 	}
 
+	perf_phase_start(PERF_PHASE_FILTERS);
+
 	filter = _init_filter_chain(cmd);
 	if (!filter)
 		goto_bad;
@@ -1352,12 +1415,15 @@ int init_filters(struct cmd_context *cmd, unsigned load_persistent_cache)
 	cmd->filter = pfilter;
 
 	cmd->initialized.filters = 1;
+	_init_phase_done(cmd, PERF_PHASE_FILTERS);
+
 	return 1;
 bad:
 	if (filter)
 		filter->destroy(filter);
 
 	cmd->initialized.filters = 0;
+	perf_phase_end(PERF_PHASE_FILTERS);
 	return 0;
 }
 
@@ -1430,7 +1496,13 @@ int lvm_register_segtype(struct segtype_library *seglib,
 	return 1;
 }
 
-static int _init_segtypes(struct cmd_context *cmd)
+static void _destroy_segtypes(struct cmd_context *cmd);
+
+/*
+ * Segment types are registered on first use, so commands
+ * that never look at LV segments do not pay for them.
+ */
+int init_segtypes(struct cmd_context *cmd)
 {
 	int i;
 	struct segment_type *segtype;
@@ -1450,44 +1522,57 @@ static int _init_segtypes(struct cmd_context *cmd)
 		NULL
 	};
 
+	if (cmd->initialized.segtypes)
+		return 1;
+
+	perf_phase_start(PERF_PHASE_SEGTYPES);
+
 	for (i = 0; init_segtype_array[i]; i++) {
 		if (!(segtype = init_segtype_array[i](cmd)))
-			return_0;
+			goto_bad;
 		segtype->library = NULL;
 		dm_list_add(&cmd->segtypes, &segtype->list);
 	}
 
 #ifdef RAID_INTERNAL
 	if (!init_raid_segtypes(cmd, &seglib))
-		return_0;
+		goto_bad;
 #endif
 
 #ifdef THIN_INTERNAL
 	if (!init_thin_segtypes(cmd, &seglib))
-		return_0;
+		goto_bad;
 #endif
 
 #ifdef CACHE_INTERNAL
 	if (!init_cache_segtypes(cmd, &seglib))
-		return_0;
+		goto_bad;
 #endif
 
 #ifdef VDO_INTERNAL
 	if (!init_vdo_segtypes(cmd, &seglib))
-		return_0;
+		goto_bad;
 #endif
 
 #ifdef WRITECACHE_INTERNAL
 	if (!init_writecache_segtypes(cmd, &seglib))
-		return_0;
+		goto_bad;
 #endif
 
 #ifdef INTEGRITY_INTERNAL
 	if (!init_integrity_segtypes(cmd, &seglib))
-		return_0;
+		goto_bad;
 #endif
 
+	cmd->initialized.segtypes = 1;
+	_init_phase_done(cmd, PERF_PHASE_SEGTYPES);
+
 	return 1;
+bad:
+	_destroy_segtypes(cmd);
+	perf_phase_end(PERF_PHASE_SEGTYPES);
+
+	return 0;
 }
 
 static int _init_hostname(struct cmd_context *cmd)
@@ -1733,6 +1818,9 @@ struct cmd_context *create_toolcontext(const char *system_dir,
 		goto out;
 	}
 
+	perf_reset();
+	perf_phase_start(PERF_PHASE_CONFIG);
+
 	if (!(cmd->libmem = dm_pool_create("library", 4 * 1024))) {
 		log_error("Library memory pool creation failed");
 		goto out;
@@ -1773,10 +1861,16 @@ struct cmd_context *create_toolcontext(const char *system_dir,
 	if (!_init_profiles(cmd))
 		goto_out;
 
+	_init_phase_done(cmd, PERF_PHASE_CONFIG);
+
+	perf_phase_start(PERF_PHASE_DEV_TYPES);
 	if (!(cmd->dev_types = create_dev_types(cmd->proc_dir,
 						find_config_tree_array(cmd, devices_types_CFG, NULL))))
 		goto_out;
 
+	_init_phase_done(cmd, PERF_PHASE_DEV_TYPES);
+
+	perf_phase_start(PERF_PHASE_DEV_CACHE_INIT);
 	init_use_aio(find_config_tree_bool(cmd, global_use_aio_CFG, NULL));
 
 	if (!_init_dev_cache(cmd))
@@ -1786,6 +1880,9 @@ struct cmd_context *create_toolcontext(const char *system_dir,
 
 	memlock_init(cmd);
 
+	_init_phase_done(cmd, PERF_PHASE_DEV_CACHE_INIT);
+
+	perf_phase_start(PERF_PHASE_FORMATS);
 	if (!_init_formats(cmd))
 		goto_out;
 
@@ -1796,9 +1893,6 @@ struct cmd_context *create_toolcontext(const char *system_dir,
 	if (!init_lvmcache_orphans(cmd))
 		goto_out;
 
-	if (!_init_segtypes(cmd))
-		goto_out;
-
 	if (!_init_backup(cmd))
 		goto_out;
 
@@ -1806,8 +1900,14 @@ struct cmd_context *create_toolcontext(const char *system_dir,
 
 	_init_globals(cmd);
 
-	if (set_connections && !init_connections(cmd))
-		goto_out;
+	_init_phase_done(cmd, PERF_PHASE_FORMATS);
+
+	if (set_connections) {
+		perf_phase_start(PERF_PHASE_CONNECTIONS);
+		if (!init_connections(cmd))
+			goto_out;
+		_init_phase_done(cmd, PERF_PHASE_CONNECTIONS);
+	}
 
 	if (set_filters && !init_filters(cmd, 1))
 		goto_out;
@@ -1838,16 +1938,18 @@ static void _destroy_formats(struct cmd_context *cmd, struct dm_list *formats)
 	}
 }
 
-static void _destroy_segtypes(struct dm_list *segtypes)
+static void _destroy_segtypes(struct cmd_context *cmd)
 {
 	struct dm_list *sgtl, *tmp;
 	struct segment_type *segtype;
 
-	dm_list_iterate_safe(sgtl, tmp, segtypes) {
+	dm_list_iterate_safe(sgtl, tmp, &cmd->segtypes) {
 		segtype = dm_list_item(sgtl, struct segment_type);
 		dm_list_del(&segtype->list);
 		segtype->ops->destroy(segtype);
 	}
+
+	cmd->initialized.segtypes = 0;
 }
 
 static void _destroy_dev_types(struct cmd_context *cmd)
@@ -1906,7 +2008,7 @@ int refresh_toolcontext(struct cmd_context *cmd)
 	lvmcache_destroy(cmd, 0, 0);
 	label_scan_drop(cmd);
 	label_exit();
-	_destroy_segtypes(&cmd->segtypes);
+	_destroy_segtypes(cmd);
 	_destroy_formats(cmd, &cmd->formats);
 
 	if (!dev_cache_exit())
@@ -2001,9 +2103,6 @@ int refresh_toolcontext(struct cmd_context *cmd)
 	if (!init_lvmcache_orphans(cmd))
 		return_0;
 
-	if (!_init_segtypes(cmd))
-		return_0;
-
 	if (!_init_backup(cmd))
 		return_0;
 
@@ -2035,7 +2134,7 @@ void destroy_toolcontext(struct cmd_context *cmd)
 	lvmcache_destroy(cmd, 0, 0);
 	label_scan_destroy(cmd);
 	label_exit();
-	_destroy_segtypes(&cmd->segtypes);
+	_destroy_segtypes(cmd);
 	_destroy_formats(cmd, &cmd->formats);
 	_destroy_filters(cmd);
 	dev_cache_exit();
@@ -2072,6 +2171,7 @@ void destroy_toolcontext(struct cmd_context *cmd)
 		free(cmd->linebuffer);
 	}
 
+	cmd_intern_reset(cmd);
 	destroy_config_context(cmd);
 
 	lvmpolld_disconnect();
@@ -59,6 +59,7 @@ struct profile_params;
 struct archive_params;
 struct backup_params;
 struct arg_values;
+struct str_intern;
 
 struct config_tree_list {
 	struct dm_list list;
@@ -69,6 +70,7 @@ struct cmd_context_initialized_parts {
 	unsigned config:1; /* used to reinitialize config if previous init was not successful */
 	unsigned filters:1;
 	unsigned connections:1;
+	unsigned segtypes:1;
 };
 
 struct cmd_report {
@@ -78,6 +80,8 @@ struct cmd_report {
 	struct dm_report_group *report_group;
 	struct dm_report *log_rh;
 	const char *log_name;
+	struct dm_report *perf_rh;
+	const char *perf_name;
 	log_report_t saved_log_report_state;
 };
 
@@ -89,6 +93,7 @@ struct cmd_context {
 	 */
 	struct dm_pool *libmem;			/* for permanent config data */
 	struct dm_pool *mem;			/* transient: cleared between each command */
+	struct str_intern *str_intern;		/* shared metadata strings, cleared with mem */
 
 	/*
 	 * Command line and arguments.
@@ -116,7 +121,7 @@ struct cmd_context {
 	const struct format_type *fmt;		/* current format to use by default */
 	struct format_type *fmt_backup;		/* format to use for backups */
 	struct dm_list formats;			/* available formats */
-	struct dm_list segtypes;		/* available segment types */
+	struct dm_list segtypes;		/* available segment types, see init_segtypes() */
 
 	/*
 	 * Machine and system identification.
@@ -135,6 +140,7 @@ struct cmd_context {
 	 * Initialization state.
 	 */
 	struct cmd_context_initialized_parts initialized;
+	unsigned init_phases_logged:1;		/* startup timings were logged */
 
 	/*
 	 * Switches.
@@ -314,6 +320,8 @@ int config_files_changed(struct cmd_context *cmd);
 int init_lvmcache_orphans(struct cmd_context *cmd);
 int init_filters(struct cmd_context *cmd, unsigned load_persistent_cache);
 int init_connections(struct cmd_context *cmd);
+int init_segtypes(struct cmd_context *cmd);
+void log_init_phases(struct cmd_context *cmd);
 int init_run_by_dmeventd(struct cmd_context *cmd);
 
 /*
@@ -327,4 +335,7 @@ struct format_type *get_format_by_name(struct cmd_context *cmd, const char *form
 
 const char *system_id_from_string(struct cmd_context *cmd, const char *str);
 
+const char *cmd_intern_str(struct cmd_context *cmd, const char *str);
+void cmd_intern_reset(struct cmd_context *cmd);
+
 #endif
@@ -382,6 +382,14 @@ cfg_array(devices_global_filter_CFG, "global_filter", devices_CFG_SECTION, CFG_D
 	"The syntax is the same as devices/filter. Devices rejected by\n"
 	"global_filter are not opened by LVM.\n")
 
+cfg(devices_regex_filter_cache_CFG, "regex_filter_cache", devices_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_REGEX_FILTER_CACHE, vsn(2, 3, 43), NULL, 0, NULL,
+	"Keep compiled filter and global_filter patterns in files.\n"
+	"The automaton built from the patterns is saved in " FILTER_CACHE_FILE "\n"
+	"and " GLOBAL_FILTER_CACHE_FILE ". Later commands with the same\n"
+	"patterns map the file instead of building it again, which helps\n"
+	"with long generated filter lists. The files are rewritten when\n"
+	"the patterns change.\n")
+
 cfg_runtime(devices_cache_CFG, "cache", devices_CFG_SECTION, 0, CFG_TYPE_STRING, vsn(1, 0, 0), vsn(1, 2, 19), NULL,
 	NULL)
 
@@ -416,6 +424,22 @@ cfg(devices_scan_lvs_CFG, "scan_lvs", devices_CFG_SECTION, CFG_DEFAULT_COMMENTED
 	"devices file or the filter. This option does not enable autoactivation\n"
 	"of layered VGs, which requires editing LVM udev rules (see LVM_PVSCAN_ON_LVS).\n")
 
+cfg(devices_scan_threads_CFG, "scan_threads", devices_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_INT, DEFAULT_SCAN_THREADS, vsn(2, 3, 43), NULL, 0, NULL,
+	"Number of threads used to enumerate devices in the scanned directories.\n"
+	"With a value above 1 device nodes and their symlinks are examined in\n"
+	"parallel, split by entries of the device directory or, when\n"
+	"obtain_device_list_from_udev is used, by names returned by udev.\n"
+	"This can reduce command startup time on systems with many devices\n"
+	"and /dev/disk/by-* links. The maximum is 64. 0 and 1 scan serially.\n")
+
+cfg(devices_scan_aliases_CFG, "scan_aliases", devices_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_SCAN_ALIASES, vsn(2, 3, 43), NULL, 0, NULL,
+	"Collect symlinks to devices as device aliases.\n"
+	"When disabled, only device nodes are added to the device cache and\n"
+	"symlinks (e.g. /dev/disk/by-id or /dev/mapper names) are skipped.\n"
+	"This saves time when devices are identified by devno or device ID,\n"
+	"but filter, global_filter and preferred_names patterns matching\n"
+	"symlinks do not apply and devices are displayed by node names.\n")
+
 cfg(devices_multipath_component_detection_CFG, "multipath_component_detection", devices_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_MULTIPATH_COMPONENT_DETECTION, vsn(2, 2, 89), NULL, 0, NULL,
 	"Ignore devices that are components of DM multipath devices.\n")
 
@@ -690,6 +714,15 @@ cfg(allocation_pvmove_max_segment_size_mb_CFG, "pvmove_max_segment_size_mb", all
 	"segment will be mirrored at once. Setting this to e.g. 10240 will\n"
 	"limit each mirroring operation to 10GiB chunks.\n")
 
+cfg(allocation_pvmove_parallel_segments_CFG, "pvmove_parallel_segments", allocation_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_INT, DEFAULT_PVMOVE_PARALLEL_SEGMENTS, vsn(2, 3, 43), NULL, 0, NULL,
+	"Number of pvmove segments mirrored at the same time.\n"
+	"By default pvmove copies one segment at a time. With a larger value\n"
+	"up to this many segments are copied concurrently, each by its own\n"
+	"mirror, preferring segments that write to different destination PVs.\n"
+	"The next segments start once all running ones have finished.\n"
+	"Combine with pvmove_max_segment_size_mb to split large LVs into\n"
+	"ranges that can be copied concurrently. The maximum is 64.\n")
+
 cfg(allocation_thin_pool_metadata_require_separate_pvs_CFG, "thin_pool_metadata_require_separate_pvs", allocation_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_THIN_POOL_METADATA_REQUIRE_SEPARATE_PVS, vsn(2, 2, 89), NULL, 0, NULL,
 	"Thin pool metadata and data will always use different PVs.\n")
 
@@ -920,6 +953,22 @@ cfg(log_command_log_selection_CFG, "command_log_selection", log_CFG_SECTION, CFG
 	"for the command log selection. For more information about selection\n"
         "criteria in general, see lvmreport(7) man page.\n")
 
+cfg(log_report_command_perf_CFG, "report_command_perf", log_CFG_SECTION, CFG_PROFILABLE | CFG_DEFAULT_COMMENTED | CFG_DISALLOW_INTERACTIVE, CFG_TYPE_BOOL, DEFAULT_COMMAND_PERF_REPORT, vsn(2, 3, 43), NULL, 0, NULL,
+	"Enable or disable LVM command performance reporting.\n"
+	"If enabled, LVM reports time spent in each processing phase\n"
+	"(config load, device scan, label scan, VG read, activation,\n"
+	"udev wait) together with counters of issued DM ioctls, bytes\n"
+	"read through the block cache and devices opened. The report is\n"
+	"added after any other reports of the command and with\n"
+	"report/output_format set to json or json_std it appears as\n"
+	"a separate perf section. Use log/command_perf_cols to define\n"
+	"fields to display.\n")
+
+cfg(log_command_perf_cols_CFG, "command_perf_cols", log_CFG_SECTION, CFG_PROFILABLE | CFG_DEFAULT_COMMENTED | CFG_DISALLOW_INTERACTIVE, CFG_TYPE_STRING, DEFAULT_COMMAND_PERF_COLS, vsn(2, 3, 43), NULL, 0, NULL,
+	"List of columns to report when reporting command performance.\n"
+	"Possible fields are perf_type, perf_name, perf_value, perf_unit\n"
+	"and perf_calls.\n")
+
 cfg(log_verbose_CFG, "verbose", log_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_INT, DEFAULT_VERBOSE, vsn(1, 0, 0), NULL, 0, NULL,
 	"Controls the messages sent to stdout or stderr.\n")
 
@@ -1191,6 +1240,26 @@ cfg(global_event_activation_CFG, "event_activation", global_CFG_SECTION, CFG_DEF
 	"services (via the lvm2-activation-generator), but the autoactivation\n"
 	"services and generator have been removed.\n")
 
+cfg(global_event_activation_coalesce_ms_CFG, "event_activation_coalesce_ms", global_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_INT, DEFAULT_EVENT_ACTIVATION_COALESCE_MS, vsn(2, 3, 43), NULL, 0, NULL,
+	"Coalesce event based autoactivation of a VG across arriving PVs.\n"
+	"When a PV appears, pvscan records it online and then waits for this\n"
+	"many milliseconds. If another PV from the same VG appears during\n"
+	"that time, the earlier pvscan leaves the VG to the later one and\n"
+	"exits without reading the VG metadata. Only the pvscan for the last\n"
+	"PV to arrive reads the VG metadata and checks if the VG is complete,\n"
+	"so a VG with many PVs is read and activated once rather than being\n"
+	"processed for every PV. Set to 0 to disable.\n")
+
+cfg(global_event_activation_table_CFG, "event_activation_table", global_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_EVENT_ACTIVATION_TABLE, vsn(2, 3, 43), NULL, 0, NULL,
+	"Keep the online state of PVs in a single table file.\n"
+	"By default, pvscan records each online PV in a separate file in\n"
+	"/run/lvm/pvs_online/, and checking if a VG is complete opens and\n"
+	"reads one file per PV. When enabled, the records are kept in the\n"
+	"file /run/lvm/pvs_online.tab which commands map into memory and\n"
+	"update under a file lock. This reduces the number of file\n"
+	"operations when many PVs appear at once. Changing this setting\n"
+	"takes effect for new events after pvscan --cache is run.\n")
+
 cfg(global_use_lvmetad_CFG, "use_lvmetad", global_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, 0, vsn(2, 2, 93), 0, vsn(2, 3, 0), NULL,
 	NULL)
 
@@ -1780,6 +1849,12 @@ cfg(activation_polling_interval_CFG, "polling_interval", activation_CFG_SECTION,
 	"is only one thing to wait for, there are no progress reports, but\n"
 	"the process is awoken immediately once the operation is complete.\n")
 
+cfg(activation_polling_rescan_vg_only_CFG, "polling_rescan_vg_only", activation_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_POLLING_RESCAN_VG_ONLY, vsn(2, 3, 43), NULL, 0, NULL,
+	"Rescan only the PVs of the VG between pvmove or lvconvert progress checks.\n"
+	"When disabled, all devices are scanned again at every polling\n"
+	"interval. When enabled, only the PVs of the polled VG are read, and\n"
+	"all devices are scanned only when the VG metadata has changed.\n")
+
 cfg(activation_auto_set_activation_skip_CFG, "auto_set_activation_skip", activation_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_AUTO_SET_ACTIVATION_SKIP, vsn(2,2,99), NULL, 0, NULL,
 	"Set the activation skip flag on new thin snapshot LVs.\n"
 	"The --setactivationskip option overrides this setting.\n"
@@ -1825,6 +1900,13 @@ cfg(metadata_check_pv_device_sizes_CFG, "check_pv_device_sizes", metadata_CFG_SE
 	"less than corresponding PV size. You should not disable this unless\n"
 	"you are absolutely sure about what you are doing!\n")
 
+cfg(metadata_check_written_metadata_CFG, "check_written_metadata", metadata_CFG_SECTION, CFG_ADVANCED | CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_CHECK_WRITTEN_METADATA, vsn(2, 3, 43), NULL, 0, NULL,
+	"Parse new metadata back before it is written to disk.\n"
+	"This verifies that the metadata text can be read again, but\n"
+	"costs a full parse and import of the VG for each update.\n"
+	"When disabled, the copy of the VG used for activation after\n"
+	"the update is created from the written text only when needed.\n")
+
 cfg(metadata_record_lvs_history_CFG, "record_lvs_history", metadata_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_BOOL, DEFAULT_RECORD_LVS_HISTORY, vsn(2, 2, 145), NULL, 0, NULL,
 	"When enabled, LVM keeps history records about removed LVs in\n"
 	"metadata. The information that is recorded in metadata for\n"
@@ -2222,6 +2304,14 @@ cfg(report_two_word_unknown_device_CFG, "two_word_unknown_device", report_CFG_SE
 	"Use the two words 'unknown device' in place of '[unknown]'.\n"
 	"This is displayed when the device for a PV is not known.\n")
 
+cfg(report_vg_read_threads_CFG, "vg_read_threads", report_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_INT, DEFAULT_REP_VG_READ_THREADS, vsn(2, 3, 43), NULL, 0, NULL,
+	"Number of threads used to parse VG metadata in reporting commands.\n"
+	"When a command that does not change VGs (e.g. vgs, lvs, pvs)\n"
+	"processes many VGs, the metadata of the next VGs is parsed on this\n"
+	"many threads ahead of being read. VGs are still read, reported and\n"
+	"displayed one at a time in the usual order. Set to 0 or 1 to parse\n"
+	"each VG when it is read. The maximum is 64.\n")
+
 cfg(dmeventd_mirror_library_CFG, "mirror_library", dmeventd_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_STRING, DEFAULT_DMEVENTD_MIRROR_LIB, vsn(1, 2, 3), NULL, 0, NULL,
 	"The library dmeventd uses when monitoring a mirror device.\n"
 	"libdevmapper-event-lvm2mirror.so attempts to recover from\n"
@@ -2251,6 +2341,18 @@ cfg(dmeventd_thin_command_CFG, "thin_command", dmeventd_CFG_SECTION, CFG_DEFAULT
 	"User handler is specified with the full path starting with '/'.\n")
 	/* TODO: systemd service handler */
 
+cfg(dmeventd_thin_forecast_CFG, "thin_forecast", dmeventd_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_INT, DEFAULT_DMEVENTD_THIN_FORECAST, vsn(2, 3, 43), NULL, 0, NULL,
+	"Run the thin command early when a thin pool is predicted to fill up.\n"
+	"The plugin keeps a short history of the data and metadata usage\n"
+	"of each monitored thin pool and predicts the number of seconds\n"
+	"until it is full at the current rate (reported by the lvs fields\n"
+	"data_time_to_full and metadata_time_to_full). When the usage is\n"
+	"above 50% and the prediction is below this many seconds, the thin\n"
+	"command runs without waiting for the next 5% increment, and\n"
+	"lvextend --use-policies extends the pool by the autoextend percent\n"
+	"even when the autoextend threshold is not reached yet.\n"
+	"Set to 0 to disable.\n")
+
 cfg(dmeventd_vdo_library_CFG, "vdo_library", dmeventd_CFG_SECTION, CFG_DEFAULT_COMMENTED, CFG_TYPE_STRING, DEFAULT_DMEVENTD_VDO_LIB, VDO_1ST_VSN, NULL, 0, NULL,
 	"The library dmeventd uses when monitoring a VDO pool device.\n"
 	"libdevmapper-event-lvm2vdo.so monitors the filling of a pool\n"
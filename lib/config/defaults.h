@@ -92,6 +92,7 @@
 #define DEFAULT_DMEVENTD_SNAPSHOT_LIB "libdevmapper-event-lvm2snapshot.so"
 #define DEFAULT_DMEVENTD_THIN_LIB "libdevmapper-event-lvm2thin.so"
 #define DEFAULT_DMEVENTD_THIN_COMMAND "lvm lvextend --use-policies"
+#define DEFAULT_DMEVENTD_THIN_FORECAST 0
 #define DEFAULT_DMEVENTD_VDO_LIB "libdevmapper-event-lvm2vdo.so"
 #define DEFAULT_DMEVENTD_VDO_COMMAND "lvm lvextend --use-policies"
 #define DEFAULT_DMEVENTD_MONITOR 1
@@ -159,6 +160,8 @@
 #define DEFAULT_CACHE_MODE "writethrough"
 
 #define DEFAULT_PVMOVE_MAX_SEGMENT_SIZE_MB 0
+#define DEFAULT_PVMOVE_PARALLEL_SEGMENTS 1
+#define DEFAULT_PVMOVE_PARALLEL_SEGMENTS_MAX 64
 
 
 /* VDO defaults */
@@ -200,6 +203,7 @@
 
 #define DEFAULT_STRIPESIZE 64	/* KB */
 #define DEFAULT_RECORD_LVS_HISTORY 0
+#define DEFAULT_CHECK_WRITTEN_METADATA 0
 #define DEFAULT_LVS_HISTORY_RETENTION_TIME 0
 #define DEFAULT_PVMETADATAIGNORE 0
 #define DEFAULT_PVMETADATACOPIES 1
@@ -228,6 +232,7 @@
 #endif
 
 #define DEFAULT_COMMAND_LOG_REPORT 0
+#define DEFAULT_COMMAND_PERF_REPORT 0
 #define DEFAULT_SYSLOG 0
 #define DEFAULT_VERBOSE 0
 #define DEFAULT_SILENT 0
@@ -257,6 +262,7 @@
 #define DEFAULT_USE_LINEAR_TARGET 1
 #define DEFAULT_STRIPE_FILLER "error"
 #define DEFAULT_RAID_REGION_SIZE   2048	/* KB */
+#define DEFAULT_POLLING_RESCAN_VG_ONLY 0
 #define DEFAULT_INTERVAL 15
 
 #define DEFAULT_MAX_HISTORY 100
@@ -273,6 +279,8 @@
 #define DEFAULT_TIME_FORMAT "%Y-%m-%d %T %z"
 
 #define DEFAULT_REP_OUTPUT_FORMAT "basic"
+#define DEFAULT_REP_VG_READ_THREADS 0
+#define DEFAULT_REP_VG_READ_THREADS_MAX 64
 #define DEFAULT_COMPACT_OUTPUT_COLS ""
 
 #define DEFAULT_COMMAND_LOG_SELECTION "!(log_type=status && message=success)"
@@ -284,6 +292,7 @@
 #define DEFAULT_PVSEGS_COLS "pv_name,vg_name,pv_fmt,pv_attr,pv_size,pv_free,pvseg_start,pvseg_size"
 #define DEFAULT_DEVTYPES_COLS "devtype_name,devtype_max_partitions,devtype_description"
 #define DEFAULT_COMMAND_LOG_COLS "log_seq_num,log_type,log_context,log_object_type,log_object_name,log_object_id,log_object_group,log_object_group_id,log_message,log_errno,log_ret_code"
+#define DEFAULT_COMMAND_PERF_COLS "perf_type,perf_name,perf_value,perf_unit,perf_calls"
 
 #define DEFAULT_LVS_COLS_VERB "lv_name,vg_name,seg_count,lv_attr,lv_size,lv_major,lv_minor,lv_kernel_major,lv_kernel_minor,pool_lv,origin,data_percent,metadata_percent,move_pv,copy_percent,mirror_log,convert_lv,lv_uuid,lv_profile"
 #define DEFAULT_VGS_COLS_VERB "vg_name,vg_attr,vg_extent_size,pv_count,lv_count,snap_count,vg_size,vg_free,vg_uuid,vg_profile"
@@ -320,6 +329,10 @@
 #define DEFAULT_VDO_POOL_AUTOEXTEND_PERCENT 20
 
 #define DEFAULT_SCAN_LVS 0
+#define DEFAULT_SCAN_THREADS 0
+#define DEFAULT_SCAN_THREADS_MAX 64
+#define DEFAULT_SCAN_ALIASES 1
+#define DEFAULT_REGEX_FILTER_CACHE 0
 
 #define DEFAULT_HINTS "all"
 
@@ -336,8 +349,16 @@
 #define PVS_ONLINE_DIR DEFAULT_RUN_DIR "/pvs_online"
 #define VGS_ONLINE_DIR DEFAULT_RUN_DIR "/vgs_online"
 #define PVS_LOOKUP_DIR DEFAULT_RUN_DIR "/pvs_lookup"
+#define VGS_ARRIVAL_DIR DEFAULT_RUN_DIR "/vgs_arrival"
+#define THIN_FORECAST_DIR DEFAULT_RUN_DIR "/thin_forecast"
+#define PVS_ONLINE_TABLE DEFAULT_RUN_DIR "/pvs_online.tab"
+
+#define DEFAULT_EVENT_ACTIVATION_COALESCE_MS 0
+#define DEFAULT_EVENT_ACTIVATION_TABLE 0
 
 #define DEVICES_IMPORT_PATH DEFAULT_RUN_DIR "/lvm-devices-import"
+#define GLOBAL_FILTER_CACHE_FILE DEFAULT_RUN_DIR "/global_filter.dfa"
+#define FILTER_CACHE_FILE DEFAULT_RUN_DIR "/filter.dfa"
 
 #define DEFAULT_DEVICE_ID_SYSFS_DIR "/sys/"  /* trailing / to match dm_sysfs_dir() */
 
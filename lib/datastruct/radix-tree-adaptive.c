@@ -23,6 +23,12 @@
 #include <string.h>
 #include <ctype.h>
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#  include <arm_neon.h>
+#endif
+
 /*----------------------------------------------------------------*/
 
 enum node_type {
@@ -498,6 +504,39 @@ static bool _insert(struct radix_tree *rt, struct value *v, const uint8_t *kb, c
 	return false;
 }
 
+/*
+ * Returns index of key k in node16 or -1.
+ * Compares all 16 keys at once when SIMD is available,
+ * keys past nr_entries are masked out.
+ */
+static inline int _node16_find(const struct node16 *n16, uint8_t k)
+{
+#if defined(__SSE2__)
+	__m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char) k),
+				     _mm_loadu_si128((const __m128i *) n16->keys));
+	unsigned mask = (unsigned) _mm_movemask_epi8(cmp) & ((1u << n16->nr_entries) - 1);
+
+	return mask ? __builtin_ctz(mask) : -1;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	uint8x16_t cmp = vceqq_u8(vdupq_n_u8(k), vld1q_u8(n16->keys));
+	/* Narrow to 4 bits per key */
+	uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+
+	if (n16->nr_entries < 16)
+		mask &= (UINT64_C(1) << (n16->nr_entries * 4)) - 1;
+
+	return mask ? (__builtin_ctzll(mask) >> 2) : -1;
+#else
+	unsigned i;
+
+	for (i = 0; i < n16->nr_entries; i++)
+		if (n16->keys[i] == k)
+			return i;
+
+	return -1;
+#endif
+}
+
 struct lookup_result {
 	struct value *v;
 	const uint8_t *kb;
@@ -506,6 +545,7 @@ struct lookup_result {
 static struct lookup_result _lookup_prefix(struct value *v, const uint8_t *kb, const uint8_t *ke)
 {
 	unsigned i;
+	int r;
 	struct value_chain *vc;
 	struct prefix_chain *pc;
 	struct node4 *n4;
@@ -544,11 +584,9 @@ static struct lookup_result _lookup_prefix(struct value *v, const uint8_t *kb, c
 		break;
 
 	case NODE16:
-		/* FIXME: use binary search or simd? */
 		n16 = v->value.ptr;
-		for (i = 0; i < n16->nr_entries; i++)
-			if (n16->keys[i] == *kb)
-				return _lookup_prefix(n16->values + i, kb + 1, ke);
+		if ((r = _node16_find(n16, *kb)) >= 0)
+			return _lookup_prefix(n16->values + r, kb + 1, ke);
 		break;
 
 	case NODE48:
@@ -964,31 +1002,88 @@ unsigned radix_tree_remove_prefix(struct radix_tree *rt, const void *prefix, siz
 
 /*----------------------------------------------------------------*/
 
-bool radix_tree_lookup(const struct radix_tree *rt, const void *key, size_t keylen,
-		       union radix_value *result)
+/* Read-only walk without recursion. */
+static bool _lookup(const struct value *v, const uint8_t *kb, const uint8_t *ke,
+		    union radix_value *result)
 {
-	const uint8_t *kb = key;
-	const uint8_t *ke = kb + keylen;
-	struct value root = rt->root;
-	struct value_chain *vc;
-	struct lookup_result lr = _lookup_prefix(&root, kb, ke);
-	if (lr.kb == ke) {
-		switch (lr.v->type) {
-		case VALUE:
-			*result = lr.v->value;
-			return true;
+	const struct value_chain *vc;
+	const struct prefix_chain *pc;
+	const struct node4 *n4;
+	const struct node48 *n48;
+	const struct node256 *n256;
+	unsigned i;
+	int r;
 
+	while (kb != ke) {
+		switch (v->type) {
 		case VALUE_CHAIN:
-			vc = lr.v->value.ptr;
-			*result = vc->value;
-			return true;
+			vc = v->value.ptr;
+			v = &vc->child;
+			continue;
+
+		case PREFIX_CHAIN:
+			pc = v->value.ptr;
+			if ((ke - kb < pc->len) || memcmp(kb, pc->prefix, pc->len))
+				return false;
+			kb += pc->len;
+			v = &pc->child;
+			continue;
+
+		case NODE4:
+			n4 = v->value.ptr;
+			for (i = 0; i < n4->nr_entries; i++)
+				if (n4->keys[i] == *kb)
+					break;
+			if (i == n4->nr_entries)
+				return false;
+			v = n4->values + i;
+			break;
+
+		case NODE16:
+			if ((r = _node16_find(v->value.ptr, *kb)) < 0)
+				return false;
+			v = ((const struct node16 *) v->value.ptr)->values + r;
+			break;
+
+		case NODE48:
+			n48 = v->value.ptr;
+			if ((i = n48->keys[*kb]) >= 48)
+				return false;
+			v = n48->values + i;
+			break;
+
+		case NODE256:
+			n256 = v->value.ptr;
+			v = n256->values + *kb;
+			break;
 
-		default:
+		default: /* UNSET, VALUE */
 			return false;
 		}
+		kb++;
 	}
 
-	return false;
+	switch (v->type) {
+	case VALUE:
+		*result = v->value;
+		return true;
+
+	case VALUE_CHAIN:
+		vc = v->value.ptr;
+		*result = vc->value;
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool radix_tree_lookup(const struct radix_tree *rt, const void *key, size_t keylen,
+		       union radix_value *result)
+{
+	const uint8_t *kb = key;
+
+	return _lookup(&rt->root, kb, kb + keylen, result);
 }
 
 /* FIXME: build up the keys too */
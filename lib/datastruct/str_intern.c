@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "lib/misc/lib.h"
+#include "lib/datastruct/str_intern.h"
+
+struct str_intern {
+	struct dm_pool *mem;
+	struct dm_hash_table *table;
+	unsigned hits;
+};
+
+struct str_intern *str_intern_create(void)
+{
+	struct str_intern *si;
+	struct dm_pool *mem;
+
+	if (!(mem = dm_pool_create("str_intern", 4096)))
+		return_NULL;
+
+	if (!(si = dm_pool_zalloc(mem, sizeof(*si))) ||
+	    !(si->table = dm_hash_create(1024))) {
+		dm_pool_destroy(mem);
+		return_NULL;
+	}
+
+	si->mem = mem;
+
+	return si;
+}
+
+void str_intern_destroy(struct str_intern *si)
+{
+	if (!si)
+		return;
+
+	dm_hash_destroy(si->table);
+	dm_pool_destroy(si->mem);
+}
+
+const char *str_intern(struct str_intern *si, const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *s;
+
+	if ((s = dm_hash_lookup_binary(si->table, str, len))) {
+		si->hits++;
+		return s;
+	}
+
+	if (!(s = dm_pool_alloc_aligned(si->mem, len, 1)))
+		return_NULL;
+
+	memcpy(s, str, len);
+
+	if (!dm_hash_insert_binary(si->table, s, len, s))
+		return_NULL;
+
+	return s;
+}
+
+unsigned str_intern_get_count(const struct str_intern *si)
+{
+	return dm_hash_get_num_entries((struct dm_hash_table *) si->table);
+}
+
+unsigned str_intern_get_hits(const struct str_intern *si)
+{
+	return si->hits;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LVM_STR_INTERN_H
+#define LVM_STR_INTERN_H
+
+struct str_intern;
+
+/*
+ * Interning table: identical strings share one read-only copy, so
+ * interned strings can be compared by pointer.  All strings are freed
+ * together by str_intern_destroy().
+ */
+struct str_intern *str_intern_create(void);
+void str_intern_destroy(struct str_intern *si);
+
+/* Return the shared copy of str, adding it if needed. NULL on failure. */
+const char *str_intern(struct str_intern *si, const char *str);
+
+/* Number of distinct strings and number of lookups served by a shared copy. */
+unsigned str_intern_get_count(const struct str_intern *si);
+unsigned str_intern_get_hits(const struct str_intern *si);
+
+#endif
@@ -140,8 +140,9 @@ int str_list_match_item(const struct dm_list *sll, const char *str)
 	if (!str)
 		return 0;
 
+	/* Interned strings match by pointer */
 	dm_list_iterate_items(sl, sll)
-		if (!strcmp(str, sl->str))
+		if ((str == sl->str) || !strcmp(str, sl->str))
 			return 1;
 
 	return 0;
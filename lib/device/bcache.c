@@ -18,6 +18,7 @@
 #include "lib/log/lvm-logging.h"
 #include "lib/log/log.h"
 #include "lib/misc/lvm-signal.h"
+#include "lib/misc/lvm-perf.h"
 
 #include <errno.h>
 #include <fcntl.h>
@@ -909,6 +910,9 @@ static void _issue_low_level(struct block *b, enum dir d)
 
 	dm_list_move(&cache->io_pending, &b->list);
 
+	if (d == DIR_READ)
+		perf_count(PERF_COUNTER_BCACHE_READ_BYTES, (se - sb) << SECTOR_SHIFT);
+
 	if (!cache->engine->issue(cache->engine, d, b->di, sb, se, b->data, b)) {
 		/* FIXME: if io_submit() set an errno, return that instead of EIO? */
 		_complete_io(b, -EIO);
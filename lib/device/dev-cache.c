@@ -25,6 +25,7 @@
 #include "lib/activate/activate.h"
 #include "lib/misc/lvm-string.h"
 #include "lib/mm/xlate.h"
+#include "lib/misc/lvm-perf.h"
 
 #ifdef UDEV_SYNC_SUPPORT
 #include <libudev.h>
@@ -32,6 +33,7 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <locale.h>
+#include <pthread.h>
 #include <time.h>
 /* coverity[unnecessary_header] needed for MuslC */
 #include <sys/file.h>
@@ -58,12 +60,15 @@ static struct {
 	struct radix_tree *dm_devnos; /* references dm_devs entries */
 	struct radix_tree *sysfs_only_devices; /* see comments in _get_device_for_sysfs_dev_name_using_devno */
 	struct radix_tree *devices;
+	struct radix_tree *sysfs_attrs; /* see dev_cache_invalidate_sysfs */
 	struct dm_regex *preferred_names_matcher;
 	const char *dev_dir;
 	int use_dm_devs_cache;
 
 	size_t dev_dir_len;
 	int has_scanned;
+	unsigned scan_threads;
+	int skip_aliases;
 	dev_t st_dev;
 	struct dm_list dirs;
 	struct dm_list files;
@@ -418,6 +423,187 @@ static inline uint32_t _shuffle_devno(dev_t d)
 	//return (uint32_t) d;
 }
 
+/*
+ * Cache of /sys/dev/block/<major>:<minor>/<attribute> contents.
+ *
+ * Filters, device_id and dev-type code read the same small sysfs
+ * attributes for each device, often several times in one command.
+ * Values are remembered together with failures (errno) until
+ * dev_cache_invalidate_sysfs() drops them, which happens on each
+ * dev_cache_scan() and whenever DM devices are going to be changed.
+ * The key is the shuffled devno followed by the attribute name, so all
+ * attributes of one device can be dropped by prefix.
+ */
+#define SYSFS_ATTR_MAX_SIZE 4096	/* sysfs attributes fit in a page */
+
+struct sysfs_attr {
+	int err;	/* errno when attribute could not be read */
+	int len;
+	char value[0];
+};
+
+static void _sysfs_attr_dtr(void *context __attribute__((unused)),
+			    union radix_value v)
+{
+	free(v.ptr);
+}
+
+static struct sysfs_attr *_sysfs_attr_read(const char *path)
+{
+	char buf[SYSFS_ATTR_MAX_SIZE];
+	struct sysfs_attr *sa;
+	ssize_t len = 0;
+	int err = 0;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) < 0)
+		err = errno;
+	else {
+		if ((len = read(fd, buf, sizeof(buf))) < 0) {
+			err = errno;
+			len = 0;
+		}
+		if (close(fd))
+			log_sys_debug("close", path);
+	}
+
+	if (!(sa = malloc(sizeof(*sa) + len)))
+		return_NULL;
+
+	sa->err = err;
+	sa->len = (int) len;
+	memcpy(sa->value, buf, len);
+
+	return sa;
+}
+
+static const struct sysfs_attr *_sysfs_attr_get(dev_t devno, const char *attribute,
+						struct sysfs_attr **uncached)
+{
+	char path[PATH_MAX];
+	const char *sysfs_dir = dm_sysfs_dir();
+	size_t attr_len = strlen(attribute);
+	uint8_t key[sizeof(uint32_t) + NAME_LEN];
+	uint32_t d = _shuffle_devno(devno);
+	struct sysfs_attr *sa;
+
+	*uncached = NULL;
+
+	if (!sysfs_dir || !*sysfs_dir)
+		return NULL;
+
+	if (attr_len > NAME_LEN) {
+		log_error(INTERNAL_ERROR "Sysfs attribute name %s is too long.", attribute);
+		return NULL;
+	}
+
+	memcpy(key, &d, sizeof(d));
+	memcpy(key + sizeof(d), attribute, attr_len);
+
+	if (_cache.sysfs_attrs &&
+	    (sa = radix_tree_lookup_ptr(_cache.sysfs_attrs, key, sizeof(d) + attr_len)))
+		return sa;
+
+	if (dm_snprintf(path, sizeof(path), "%sdev/block/%u:%u/%s", sysfs_dir,
+			MAJOR(devno), MINOR(devno), attribute) < 0) {
+		log_warn("WARNING: sysfs path for %s attribute is too long.", attribute);
+		return NULL;
+	}
+
+	if (!(sa = _sysfs_attr_read(path)))
+		return NULL;
+
+	if (!_cache.sysfs_attrs ||
+	    !radix_tree_insert_ptr(_cache.sysfs_attrs, key, sizeof(d) + attr_len, sa))
+		/* Without cache caller releases the value. */
+		*uncached = sa;
+
+	return sa;
+}
+
+/*
+ * Cached variant of get_sysfs_value() for /sys/dev/block/<devno>/<attribute>.
+ * On failure errno is set as it was when reading the attribute.
+ */
+int get_sysfs_dev_value(dev_t devno, const char *attribute, char *buf, size_t buf_size)
+{
+	const struct sysfs_attr *sa;
+	struct sysfs_attr *uncached;
+	const char *nl;
+	size_t len;
+	int err = ENOENT;
+	int r = 0;
+
+	buf[0] = '\0';
+
+	if (!(sa = _sysfs_attr_get(devno, attribute, &uncached)))
+		goto out;
+
+	if ((err = sa->err))
+		goto out;
+
+	/* Same as fgets() and strip of trailing newline. */
+	len = sa->len;
+	if ((nl = memchr(sa->value, '\n', len)))
+		len = nl - sa->value;
+	if (len >= buf_size)
+		len = buf_size - 1;
+
+	memcpy(buf, sa->value, len);
+	buf[len] = '\0';
+	r = (buf[0] != '\0');
+out:
+	free(uncached);
+	errno = err;
+
+	return r;
+}
+
+/*
+ * Cached variant of get_sysfs_binary() for /sys/dev/block/<devno>/<attribute>.
+ */
+int get_sysfs_dev_binary(dev_t devno, const char *attribute, char *buf, size_t buf_size, int *retlen)
+{
+	const struct sysfs_attr *sa;
+	struct sysfs_attr *uncached;
+	int err = ENOENT;
+	int r = 0;
+
+	if (!(sa = _sysfs_attr_get(devno, attribute, &uncached)))
+		goto out;
+
+	if ((err = sa->err) || !sa->len)
+		goto out;
+
+	*retlen = ((size_t) sa->len < buf_size) ? sa->len : (int) buf_size;
+	memcpy(buf, sa->value, *retlen);
+	r = 1;
+out:
+	free(uncached);
+	errno = err;
+
+	return r;
+}
+
+/*
+ * Drop cached sysfs attributes of devno, or of all devices when devno is 0.
+ */
+void dev_cache_invalidate_sysfs(dev_t devno)
+{
+	uint32_t d;
+
+	if (!_cache.sysfs_attrs)
+		return;
+
+	if (!devno) {
+		radix_tree_remove_prefix(_cache.sysfs_attrs, NULL, 0);
+		return;
+	}
+
+	d = _shuffle_devno(devno);
+	(void) radix_tree_remove_prefix(_cache.sysfs_attrs, &d, sizeof(d));
+}
+
 static struct dm_list *_get_or_add_list_by_index_key(struct dm_hash_table *idx, const char *key)
 {
 	struct dm_list *list;
@@ -841,7 +1027,11 @@ static size_t _collapse_slashes(char *str)
 	return (str - start);
 }
 
-static int _insert_dir(const char *dir)
+/*
+ * Check /dev subdirectories that can't contain any block device.
+ * Path must be terminated with '/'.
+ */
+static int _skip_dir(const char *path, size_t len)
 {
 	/* alphabetically! sorted list used by bsearch of
 	 * /dev subdirectories that should not contain
@@ -857,28 +1047,50 @@ static int _insert_dir(const char *dir)
 		"snd/",
 		"usb/",
 	};
-	int n, dirent_count, r = 1;
-	struct dirent **dirent = NULL;
-	char path[PATH_MAX];
+
+	if ((len < (5 + sizeof(_no_scan[0]))) && (strncmp("/dev/", path, 5) == 0) && (len > 5) &&
+	    bsearch(path + 5, _no_scan, DM_ARRAY_SIZE(_no_scan), sizeof(_no_scan[0]),
+		    (int (*)(const void*, const void*))strcmp))
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Copy dir to path with collapsed slashes and trailing '/'.
+ * Returns length of the path or 0 when too long.
+ */
+static size_t _dir_path(char *path, size_t size, const char *dir)
+{
 	size_t len;
 
-	if (!_dm_strncpy(path, dir, sizeof(path))) {
-		log_debug_devs("Dir path %s is too long", path);
+	if (!_dm_strncpy(path, dir, size - 1))
 		return 0;
-	}
 
 	len = _collapse_slashes(path);
 	if (len && path[len - 1] != '/')
 		path[len++] = '/';
+	path[len] = 0;
 
-	if ((len < (5 + sizeof(_no_scan[0]))) && (strncmp("/dev/", path, 5) == 0) && (len > 5)) {
-		path[len] = 0;
-		if (bsearch(path + 5, _no_scan, DM_ARRAY_SIZE(_no_scan), sizeof(_no_scan[0]),
-			    (int (*)(const void*, const void*))strcmp)) {
-			/* Skip insertion of directories that can't have block devices */
-			log_debug_devs("Skipping \"%s\" (no block devices).", path);
-			return 1;
-		}
+	return len;
+}
+
+static int _insert_dir(const char *dir)
+{
+	int n, dirent_count, r = 1;
+	struct dirent **dirent = NULL;
+	char path[PATH_MAX];
+	size_t len;
+
+	if (!(len = _dir_path(path, sizeof(path), dir))) {
+		log_debug_devs("Dir path %s is too long", dir);
+		return 0;
+	}
+
+	if (_skip_dir(path, len)) {
+		/* Skip insertion of directories that can't have block devices */
+		log_debug_devs("Skipping \"%s\" (no block devices).", path);
+		return 1;
 	}
 
 	dirent_count = scandir(dir, &dirent, NULL, alphasort);
@@ -887,6 +1099,9 @@ static int _insert_dir(const char *dir)
 			if (dirent[n]->d_name[0] == '.')
 				continue;
 
+			if (_cache.skip_aliases && (dirent[n]->d_type == DT_LNK))
+				continue;
+
 			if (!_dm_strncpy(path + len, dirent[n]->d_name, sizeof(path) - len)) {
 				log_debug_devs("Path %s/%s is too long.", dir, dirent[n]->d_name);
 				r = 0;
@@ -904,6 +1119,263 @@ static int _insert_dir(const char *dir)
 	return r;
 }
 
+/*
+ * Parallel device enumeration (devices/scan_threads).
+ *
+ * The scan is split into shards - one per entry of the scanned directory
+ * (whole subdirectories are walked by one worker), or one per name
+ * enumerated by udev.  Workers only stat() paths and collect block
+ * devices into per-shard lists, they never log or touch the cache.
+ * The lists are then merged by the calling thread in shard order, which
+ * is the order of a serial scan, so chosen aliases stay the same.
+ */
+struct scan_entry {
+	char *path;
+	dev_t devno;
+	int err;		/* errno of failed stat */
+};
+
+struct scan_shard {
+	char *path;
+	struct scan_entry *entries;
+	unsigned nr_entries;
+	unsigned size;
+	int failed;
+};
+
+struct scan_work {
+	struct scan_shard *shards;
+	unsigned nr_shards;
+	unsigned size;
+	unsigned next;		/* next shard to take, atomic */
+	int recursive;
+};
+
+static void _scan_collect_path(struct scan_shard *sh, char *path, int recursive);
+
+static void _scan_add_entry(struct scan_shard *sh, const char *path, dev_t devno, int err)
+{
+	struct scan_entry *entries;
+	unsigned size;
+
+	if (sh->nr_entries == sh->size) {
+		size = sh->size ? sh->size * 2 : 4;
+		if (!(entries = realloc(sh->entries, size * sizeof(*entries)))) {
+			sh->failed = 1;
+			return;
+		}
+		sh->entries = entries;
+		sh->size = size;
+	}
+
+	if (!(sh->entries[sh->nr_entries].path = strdup(path))) {
+		sh->failed = 1;
+		return;
+	}
+
+	sh->entries[sh->nr_entries].devno = devno;
+	sh->entries[sh->nr_entries].err = err;
+	sh->nr_entries++;
+}
+
+/* Worker side of _insert_dir(). */
+static void _scan_collect_dir(struct scan_shard *sh, const char *dir)
+{
+	struct dirent **dirent = NULL;
+	char path[PATH_MAX];
+	int n, dirent_count;
+	size_t len;
+
+	if (!(len = _dir_path(path, sizeof(path), dir))) {
+		sh->failed = 1;
+		return;
+	}
+
+	if (_skip_dir(path, len))
+		return;
+
+	if ((dirent_count = scandir(dir, &dirent, NULL, alphasort)) <= 0)
+		return;
+
+	for (n = 0; n < dirent_count; n++) {
+		if ((dirent[n]->d_name[0] != '.') &&
+		    (!_cache.skip_aliases || (dirent[n]->d_type != DT_LNK))) {
+			if (_dm_strncpy(path + len, dirent[n]->d_name, sizeof(path) - len))
+				_scan_collect_path(sh, path, 1);
+			else
+				sh->failed = 1;
+		}
+		free(dirent[n]);
+	}
+
+	free(dirent);
+}
+
+/* Worker side of _insert(). */
+static void _scan_collect_path(struct scan_shard *sh, char *path, int recursive)
+{
+	struct stat info, linfo;
+
+	if (stat(path, &info) < 0) {
+		_scan_add_entry(sh, path, 0, errno);
+		return;
+	}
+
+	if (S_ISBLK(info.st_mode)) {
+		_scan_add_entry(sh, path, info.st_rdev, 0);
+		return;
+	}
+
+	if (!recursive || !S_ISDIR(info.st_mode))
+		return;
+
+	if (lstat(path, &linfo) < 0) {
+		_scan_add_entry(sh, path, 0, errno);
+		return;
+	}
+
+	if (S_ISLNK(linfo.st_mode) || (info.st_dev != _cache.st_dev))
+		return;
+
+	_scan_collect_dir(sh, path);
+}
+
+static void *_scan_worker(void *arg)
+{
+	struct scan_work *w = arg;
+	unsigned i;
+
+	while ((i = __atomic_fetch_add(&w->next, 1, __ATOMIC_RELAXED)) < w->nr_shards)
+		_scan_collect_path(&w->shards[i], w->shards[i].path, w->recursive);
+
+	return NULL;
+}
+
+static int _scan_work_add(struct scan_work *w, const char *path)
+{
+	struct scan_shard *shards;
+	unsigned size;
+
+	if (w->nr_shards == w->size) {
+		size = w->size ? w->size * 2 : 64;
+		if (!(shards = realloc(w->shards, size * sizeof(*shards)))) {
+			log_error("Failed to allocate device scan shards.");
+			return 0;
+		}
+		w->shards = shards;
+		w->size = size;
+	}
+
+	memset(&w->shards[w->nr_shards], 0, sizeof(*w->shards));
+
+	if (!(w->shards[w->nr_shards].path = strdup(path))) {
+		log_error("Failed to allocate device scan path.");
+		return 0;
+	}
+
+	w->nr_shards++;
+
+	return 1;
+}
+
+/*
+ * Run workers over all shards and merge collected devices into the cache.
+ * Frees the work.
+ */
+static int _scan_work_run(struct scan_work *w)
+{
+	pthread_t threads[DEFAULT_SCAN_THREADS_MAX];
+	unsigned nr_threads = 0, i, j;
+	struct scan_shard *sh;
+	struct scan_entry *e;
+	int r = 1;
+
+	/* Calling thread is a worker too. */
+	while ((nr_threads + 1 < _cache.scan_threads) &&
+	       (nr_threads + 1 < w->nr_shards) &&
+	       (nr_threads < DM_ARRAY_SIZE(threads))) {
+		if (pthread_create(&threads[nr_threads], NULL, _scan_worker, w)) {
+			log_debug_devs("Failed to create device scan thread.");
+			break;
+		}
+		nr_threads++;
+	}
+
+	log_debug_devs("Scanning %u device paths with %u threads.",
+		       w->nr_shards, nr_threads + 1);
+
+	(void) _scan_worker(w);
+
+	for (i = 0; i < nr_threads; i++)
+		if (pthread_join(threads[i], NULL))
+			log_debug_devs("Failed to join device scan thread.");
+
+	for (i = 0; i < w->nr_shards; i++) {
+		sh = &w->shards[i];
+		if (sh->failed) {
+			log_debug_devs("%s: Failed to scan all devices.", sh->path);
+			r = 0;
+		}
+		for (j = 0; j < sh->nr_entries; j++) {
+			e = &sh->entries[j];
+			if (e->err) {
+				errno = e->err;
+				log_sys_very_verbose("stat", e->path);
+				r = 0;
+			} else if (!_insert_dev(e->path, e->devno))
+				r = 0;
+			free(e->path);
+		}
+		free(sh->entries);
+		free(sh->path);
+	}
+
+	free(w->shards);
+
+	return r;
+}
+
+/* Parallel variant of _insert_dir() sharded by directory entry. */
+static int _insert_dir_parallel(const char *dir)
+{
+	struct scan_work w = { .recursive = 1 };
+	struct dirent **dirent = NULL;
+	char path[PATH_MAX];
+	int n, dirent_count, failed = 0, r = 1;
+	size_t len;
+
+	if (!(len = _dir_path(path, sizeof(path), dir))) {
+		log_debug_devs("Dir path %s is too long", dir);
+		return 0;
+	}
+
+	if (_skip_dir(path, len)) {
+		log_debug_devs("Skipping \"%s\" (no block devices).", path);
+		return 1;
+	}
+
+	if ((dirent_count = scandir(dir, &dirent, NULL, alphasort)) <= 0)
+		return 1;
+
+	for (n = 0; n < dirent_count; n++) {
+		if (!failed && (dirent[n]->d_name[0] != '.') &&
+		    (!_cache.skip_aliases || (dirent[n]->d_type != DT_LNK))) {
+			if (!_dm_strncpy(path + len, dirent[n]->d_name, sizeof(path) - len)) {
+				log_debug_devs("Path %s/%s is too long.", dir, dirent[n]->d_name);
+				r = 0;
+			} else if (!_scan_work_add(&w, path))
+				failed = 1;
+		}
+		free(dirent[n]);
+	}
+	free(dirent);
+
+	if (!_scan_work_run(&w) || failed)
+		r = 0;
+
+	return r;
+}
+
 static int _dev_cache_iterate_devs_for_index(struct cmd_context *cmd)
 {
 	struct dev_iter *iter;
@@ -1024,12 +1496,23 @@ static int _device_in_udev_db(const dev_t d)
 	return 0;
 }
 
+/* Insert path now or add it to work of parallel scan. */
+static int _insert_udev_path(struct scan_work *w, const char *path)
+{
+	if (w)
+		return _scan_work_add(w, path);
+
+	return _insert(path, NULL, 0, 0);
+}
+
 static int _insert_udev_dir(struct udev *udev, const char *dir)
 {
 	struct udev_enumerate *udev_enum = NULL;
 	struct udev_list_entry *device_entry, *symlink_entry;
 	const char *entry_name, *node_name, *symlink_name;
 	struct udev_device *device;
+	struct scan_work work = { 0 };
+	struct scan_work *w = (_cache.scan_threads > 1) ? &work : NULL;
 	int r = 1;
 
 	if (!(udev_enum = udev_enumerate_new(udev))) {
@@ -1069,20 +1552,24 @@ static int _insert_udev_dir(struct udev *udev, const char *dir)
 			log_very_verbose("udev failed to return a device node for entry %s.",
 					 entry_name);
 		else
-			r &= _insert(node_name, NULL, 0, 0);
-
-		udev_list_entry_foreach(symlink_entry, udev_device_get_devlinks_list_entry(device)) {
-			if (!(symlink_name = udev_list_entry_get_name(symlink_entry)))
-				log_very_verbose("udev failed to return a symlink name for entry %s.",
-						 entry_name);
-			else
-				r &= _insert(symlink_name, NULL, 0, 0);
-		}
+			r &= _insert_udev_path(w, node_name);
+
+		if (!_cache.skip_aliases)
+			udev_list_entry_foreach(symlink_entry, udev_device_get_devlinks_list_entry(device)) {
+				if (!(symlink_name = udev_list_entry_get_name(symlink_entry)))
+					log_very_verbose("udev failed to return a symlink name for entry %s.",
+							 entry_name);
+				else
+					r &= _insert_udev_path(w, symlink_name);
+			}
 
 		udev_device_unref(device);
 	}
 
 out:
+	if (w)
+		r &= _scan_work_run(w);
+
 	udev_enumerate_unref(udev_enum);
 
 	return r;
@@ -1111,7 +1598,8 @@ static void _insert_dirs(struct dm_list *dirs)
 					       "udev-managed directory to device "
 					       "cache fully", dl->dir);
 		}
-		else if (!_insert_dir(dl->dir))
+		else if (!((_cache.scan_threads > 1) ? _insert_dir_parallel(dl->dir) :
+			   _insert_dir(dl->dir)))
 			log_debug_devs("%s: Failed to insert devices to "
 				       "device cache fully", dl->dir);
 	}
@@ -1136,7 +1624,10 @@ static void _insert_dirs(struct dm_list *dirs)
 			continue;
 		}
 		_cache.st_dev = tinfo.st_dev;
-		_insert_dir(dl->dir);
+		if (_cache.scan_threads > 1)
+			_insert_dir_parallel(dl->dir);
+		else
+			_insert_dir(dl->dir);
 	}
 }
 
@@ -1206,14 +1697,26 @@ void dev_cache_scan(struct cmd_context *cmd)
 {
 	log_debug_devs("Creating list of system devices.");
 
+	perf_phase_start(PERF_PHASE_DEV_CACHE_SCAN);
+
 	_cache.has_scanned = 1;
 
+	/* Devices may have come and gone since the last scan. */
+	dev_cache_invalidate_sysfs(0);
+
+	_cache.scan_threads = find_config_tree_int(cmd, devices_scan_threads_CFG, NULL);
+	if (_cache.scan_threads > DEFAULT_SCAN_THREADS_MAX)
+		_cache.scan_threads = DEFAULT_SCAN_THREADS_MAX;
+	_cache.skip_aliases = !find_config_tree_bool(cmd, devices_scan_aliases_CFG, NULL);
+
 	setlocale(LC_COLLATE, "C"); /* Avoid sorting by locales */
 	_insert_dirs(&_cache.dirs);
 	setlocale(LC_COLLATE, "");
 
 	if (cmd->check_devs_used)
 		(void) _dev_cache_index_devs(cmd);
+
+	perf_phase_end(PERF_PHASE_DEV_CACHE_SCAN);
 }
 
 int dev_cache_has_scanned(void)
@@ -1433,6 +1936,11 @@ int dev_cache_init(struct cmd_context *cmd)
 		goto bad;
 	}
 
+	if (!(_cache.sysfs_attrs = radix_tree_create(_sysfs_attr_dtr, NULL))) {
+		log_error("Couldn't create binary tree for sysfs attributes in dev cache.");
+		goto bad;
+	}
+
 	if (!(_cache.dev_dir = _strdup(cmd->dev_dir))) {
 		log_error("strdup dev_dir failed.");
 		goto bad;
@@ -1534,6 +2042,9 @@ int dev_cache_exit(void)
 	if (_cache.sysfs_only_devices)
 	       radix_tree_destroy(_cache.sysfs_only_devices);
 
+	if (_cache.sysfs_attrs)
+	       radix_tree_destroy(_cache.sysfs_attrs);
+
 	memset(&_cache, 0, sizeof(_cache));
 
 	return (!vt.num_open);
@@ -2418,12 +2929,7 @@ static char *_get_devname_from_devno(struct cmd_context *cmd, dev_t devno)
 	 * mpatha
 	 */
 	if (major == cmd->dev_types->device_mapper_major) {
-		if (dm_snprintf(path, sizeof(path), "%sdev/block/%u:%u/dm/name",
-				dm_sysfs_dir(), major, minor) < 0) {
-			return NULL;
-		}
-
-		if (!get_sysfs_value(path, namebuf, sizeof(namebuf), 0))
+		if (!get_sysfs_dev_value(devno, "dm/name", namebuf, sizeof(namebuf)))
 			return NULL;
 
 		if (!_sanitize_buffer(namebuf))
@@ -98,6 +98,9 @@ bool dev_cache_has_md_with_end_superblock(struct dev_types *dt);
 
 int get_sysfs_value(const char *path, char *buf, size_t buf_size, int error_if_no_value);
 int get_sysfs_binary(const char *path, char *buf, size_t buf_size, int *retlen);
+int get_sysfs_dev_value(dev_t devno, const char *attribute, char *buf, size_t buf_size);
+int get_sysfs_dev_binary(dev_t devno, const char *attribute, char *buf, size_t buf_size, int *retlen);
+void dev_cache_invalidate_sysfs(dev_t devno);
 
 int setup_devices_file(struct cmd_context *cmd);
 int setup_devices(struct cmd_context *cmd);
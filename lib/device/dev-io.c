@@ -17,6 +17,7 @@
 #include "lib/device/device.h"
 #include "lib/metadata/metadata.h"
 #include "lib/mm/memlock.h"
+#include "lib/misc/lvm-perf.h"
 
 #include <limits.h>
 #include <sys/stat.h>
@@ -429,6 +430,8 @@ int dev_open_flags(struct device *dev, int flags, int direct, int quiet)
 				dev->flags & DEV_O_DIRECT ? " O_DIRECT" : "");
 	}
 
+	perf_count(PERF_COUNTER_DEV_OPENS, 1);
+
 	dev->flags &= ~DEV_OPEN_FAILURE;
 	return 1;
 }
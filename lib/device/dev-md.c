@@ -15,6 +15,7 @@
 
 #include "lib/misc/lib.h"
 #include "lib/device/dev-type.h"
+#include "lib/device/dev-cache.h"
 #include "lib/mm/xlate.h"
 #include "lib/misc/crc.h"
 
@@ -301,86 +302,58 @@ found:
 	return 1;
 }
 
-static int _md_sysfs_attribute_snprintf(char *path, size_t size,
-					struct dev_types *dt,
-					struct device *blkdev,
-					const char *attribute)
+static int _md_sysfs_attribute_scanf(struct dev_types *dt,
+				     struct device *dev,
+				     const char *attribute_name,
+				     const char *attribute_fmt,
+				     void *attribute_value)
 {
 	const char *sysfs_dir = dm_sysfs_dir();
-	struct stat info;
-	dev_t dev = blkdev->dev;
-	int ret = -1;
+	char path[PATH_MAX];
+	char attribute[MD_MAX_SYSFS_SIZE];
+	char buffer[MD_MAX_SYSFS_SIZE] = { 0 };
+	dev_t devno = dev->dev;
+	int ret = 0;
 
 	if (!sysfs_dir || !*sysfs_dir)
 		return ret;
 
-	if (MAJOR(dev) == dt->blkext_major) {
+	if (MAJOR(devno) == dt->blkext_major) {
 		/* lookup parent MD device from blkext partition */
-		if (!dev_get_primary_dev(dt, blkdev, &dev))
+		if (!dev_get_primary_dev(dt, dev, &devno))
 			return ret;
 	}
 
-	if (MAJOR(dev) != dt->md_major)
+	if (MAJOR(devno) != dt->md_major)
 		return ret;
 
-	ret = dm_snprintf(path, size, "%s/dev/block/%u:%u/md/%s", sysfs_dir,
-			  MAJOR(dev), MINOR(dev), attribute);
-	if (ret < 0) {
-		log_error("dm_snprintf md %s failed", attribute);
+	if (dm_snprintf(attribute, sizeof(attribute), "md/%s", attribute_name) < 0) {
+		log_error("dm_snprintf md %s failed", attribute_name);
 		return ret;
 	}
 
-	if (stat(path, &info) == -1) {
+	if (!get_sysfs_dev_value(devno, attribute, buffer, sizeof(buffer))) {
 		if (errno != ENOENT) {
-			log_sys_error("stat", path);
+			log_debug("_md_sysfs_attribute_scanf read failed %s", attribute);
 			return ret;
 		}
+
 		/* old sysfs structure */
-		ret = dm_snprintf(path, size, "%s/block/md%u/md/%s",
-				  sysfs_dir, MINOR(dev), attribute);
-		if (ret < 0) {
-			log_error("dm_snprintf old md %s failed", attribute);
+		if (dm_snprintf(path, sizeof(path), "%s/block/md%u/md/%s",
+				sysfs_dir, MINOR(devno), attribute_name) < 0) {
+			log_error("dm_snprintf old md %s failed", attribute_name);
 			return ret;
 		}
-	}
 
-	return ret;
-}
-
-static int _md_sysfs_attribute_scanf(struct dev_types *dt,
-				     struct device *dev,
-				     const char *attribute_name,
-				     const char *attribute_fmt,
-				     void *attribute_value)
-{
-	char path[PATH_MAX] = { 0 };
-	char buffer[MD_MAX_SYSFS_SIZE] = { 0 };
-	FILE *fp;
-	int ret = 0;
-
-	if (_md_sysfs_attribute_snprintf(path, sizeof(path), dt,
-					 dev, attribute_name) < 0)
-		return ret;
-
-	if (!(fp = fopen(path, "r"))) {
-		log_debug("_md_sysfs_attribute_scanf fopen failed %s", path);
-		return ret;
-	}
-
-	if (!fgets(buffer, sizeof(buffer), fp)) {
-		log_debug("_md_sysfs_attribute_scanf fgets failed %s", path);
-		goto out;
+		if (!get_sysfs_value(path, buffer, sizeof(buffer), 0)) {
+			log_debug("_md_sysfs_attribute_scanf read failed %s", path);
+			return ret;
+		}
 	}
 
-	if ((ret = sscanf(buffer, attribute_fmt, attribute_value)) != 1) {
+	if ((ret = sscanf(buffer, attribute_fmt, attribute_value)) != 1)
 		log_error("%s sysfs attr %s not in expected format: %s",
 			  dev_name(dev), attribute_name, buffer);
-		goto out;
-	}
-
-out:
-	if (fclose(fp))
-		log_sys_debug("fclose", path);
 
 	return ret;
 }
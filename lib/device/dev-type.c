@@ -529,63 +529,35 @@ int major_is_scsi_device(struct dev_types *dt, unsigned major)
 
 static int _loop_is_with_partscan(struct device *dev)
 {
-	FILE *fp;
 	int partscan = 0;
-	char path[PATH_MAX];
 	char buffer[64];
 
-	if (dm_snprintf(path, sizeof(path), "%sdev/block/%u:%u/loop/partscan",
-			dm_sysfs_dir(), MAJOR(dev->dev), MINOR(dev->dev)) < 0) {
-		log_warn("Sysfs path for partscan is too long.");
-		return 0;
-	}
-
-	if (!(fp = fopen(path, "r")))
+	if (!get_sysfs_dev_value(dev->dev, "loop/partscan", buffer, sizeof(buffer)))
 		return 0; /* not there -> no partscan */
 
-	if (!fgets(buffer, sizeof(buffer), fp)) {
-		log_warn("Failed to read %s.", path);
-	} else if (sscanf(buffer, "%d", &partscan) != 1) {
-		log_warn("Failed to parse %s '%s'.", path, buffer);
+	if (sscanf(buffer, "%d", &partscan) != 1) {
+		log_warn("Failed to parse %s loop/partscan '%s'.", dev_name(dev), buffer);
 		partscan = 0;
 	}
 
-	if (fclose(fp))
-		log_sys_debug("fclose", path);
-
 	return partscan;
 }
 
 int dev_get_partition_number(struct device *dev, int *num)
 {
-	char path[PATH_MAX];
 	char buf[8] = { 0 };
-	dev_t devt = dev->dev;
-	struct stat sb;
 
 	if (dev->part != -1) {
 		*num = dev->part;
 		return 1;
 	}
 
-	if (dm_snprintf(path, sizeof(path), "%sdev/block/%u:%u/partition",
-			dm_sysfs_dir(), MAJOR(devt), MINOR(devt)) < 0) {
-		log_error("Failed to create sysfs path for %s", dev_name(dev));
-		return 0;
-	}
-
-	if (stat(path, &sb)) {
-		dev->part = 0;
-		*num = 0;
-		return 1;
-	}
-
-	if (!get_sysfs_value(path, buf, sizeof(buf), 0)) {
-		log_error("Failed to read sysfs path for %s", dev_name(dev));
-		return 0;
-	}
-
-	if (!buf[0]) {
+	if (!get_sysfs_dev_value(dev->dev, "partition", buf, sizeof(buf))) {
+		if (errno == ENOENT) {
+			dev->part = 0;
+			*num = 0;
+			return 1;
+		}
 		log_error("Failed to read sysfs partition value for %s", dev_name(dev));
 		return 0;
 	}
@@ -1389,80 +1361,46 @@ int wipe_known_signatures(struct cmd_context *cmd, struct device *dev,
 
 #ifdef __linux__
 
-static int _snprintf_attr(char *buf, size_t buf_size, const char *sysfs_dir,
-			 const char *attribute, dev_t dev)
-{
-	if (dm_snprintf(buf, buf_size, "%sdev/block/%u:%u/%s", sysfs_dir,
-			MAJOR(dev), MINOR(dev),	attribute) < 0) {
-		log_warn("WARNING: sysfs path for %s attribute is too long.", attribute);
-		return 0;
-	}
-
-	return 1;
-}
-
 static int _dev_sysfs_block_attribute(struct dev_types *dt,
 				      const char *attribute,
 				      struct device *dev,
 				      unsigned long *value)
 {
-	const char *sysfs_dir = dm_sysfs_dir();
-	char path[PATH_MAX], buffer[64];
-	FILE *fp;
+	char buffer[64];
 	dev_t primary = 0;
-	int ret = 0;
 
 	if (!attribute || !*attribute)
-		goto_out;
-
-	if (!sysfs_dir || !*sysfs_dir)
-		goto_out;
-
-	if (!_snprintf_attr(path, sizeof(path), sysfs_dir, attribute, dev->dev))
-		goto_out;
+		return_0;
 
 	/*
 	 * check if the desired sysfs attribute exists
 	 * - if not: either the kernel doesn't have topology support
 	 *   or the device could be a partition
 	 */
-	if (!(fp = fopen(path, "r"))) {
+	if (!get_sysfs_dev_value(dev->dev, attribute, buffer, sizeof(buffer))) {
 		if (errno != ENOENT) {
-			log_sys_debug("fopen", path);
-			goto out;
+			log_debug("%s: Failed to read sysfs attribute %s.", dev_name(dev), attribute);
+			return 0;
 		}
 		if (!dev_get_primary_dev(dt, dev, &primary))
-			goto out;
+			return 0;
 
 		/* get attribute from partition's primary device */
-		if (!_snprintf_attr(path, sizeof(path), sysfs_dir, attribute, primary))
-			goto_out;
-
-		if (!(fp = fopen(path, "r"))) {
+		if (!get_sysfs_dev_value(primary, attribute, buffer, sizeof(buffer))) {
 			if (errno != ENOENT)
-				log_sys_debug("fopen", path);
-			goto out;
+				log_debug("%s: Failed to read sysfs attribute %s of primary device.",
+					  dev_name(dev), attribute);
+			return 0;
 		}
 	}
 
-	if (!fgets(buffer, sizeof(buffer), fp)) {
-		log_sys_debug("fgets", path);
-		goto out_close;
-	}
-
 	if (sscanf(buffer, "%lu", value) != 1) {
-		log_warn("WARNING: sysfs file %s not in expected format: %s", path, buffer);
-		goto out_close;
+		log_warn("WARNING: sysfs attribute %s of %s not in expected format: %s",
+			 attribute, dev_name(dev), buffer);
+		return 0;
 	}
 
-	ret = 1;
-
-out_close:
-	if (fclose(fp))
-		log_sys_debug("fclose", path);
-
-out:
-	return ret;
+	return 1;
 }
 
 static unsigned long _dev_topology_attribute(struct dev_types *dt,
@@ -475,20 +475,24 @@ static int _read_sys_block(struct cmd_context *cmd, struct device *dev,
 	dev_t prim = 0;
 	int ret;
 
-	sysfs_dir = cmd->device_id_sysfs_dir ?: dm_sysfs_dir();
+	/* Without test override attributes are read through dev-cache. */
+	sysfs_dir = cmd->device_id_sysfs_dir;
  retry:
-	if (dm_snprintf(path, sizeof(path), "%sdev/block/%u:%u/%s",
+	if (sysfs_dir &&
+	    dm_snprintf(path, sizeof(path), "%sdev/block/%u:%u/%s",
 			sysfs_dir, MAJOR(devt), MINOR(devt), suffix) < 0) {
 		log_error("Failed to create sysfs path for %s", dev_name(dev));
 		return 0;
 	}
 
 	if (binary) {
-		ret = get_sysfs_binary(path, sysbuf, sysbufsize, retlen);
+		ret = sysfs_dir ? get_sysfs_binary(path, sysbuf, sysbufsize, retlen) :
+			get_sysfs_dev_binary(devt, suffix, sysbuf, sysbufsize, retlen);
 		if (ret && !*retlen)
 			ret = 0;
 	} else {
-		ret = get_sysfs_value(path, sysbuf, sysbufsize, 0);
+		ret = sysfs_dir ? get_sysfs_value(path, sysbuf, sysbufsize, 0) :
+			get_sysfs_dev_value(devt, suffix, sysbuf, sysbufsize);
 		if (ret && !sysbuf[0])
 			ret = 0;
 	}
@@ -16,8 +16,11 @@
 #include "lib/misc/lib.h"
 #include "lib/device/online.h"
 #include "lib/config/defaults.h"
+#include "lib/config/config.h"
 
 #include <dirent.h>
+#include <sys/file.h>
+#include <sys/mman.h>
 
 /*
  * file contains:
@@ -28,6 +31,306 @@
  * It's possible that vg and dev may not exist.
  */
 
+/*
+ * Alternatively (global/event_activation_table), the pvs_online state is
+ * kept in a single file of fixed size records that is mapped by each
+ * command.  A record is changed only while holding an exclusive flock
+ * on the file, and read while holding a shared one, so a reader never
+ * sees a partially written record.  Looking up or counting the online
+ * PVs of a VG is then a scan of the mapping rather than an open and
+ * read of a file per PV.
+ *
+ * The table is created by pvscan when the setting is enabled and
+ * removed when it is disabled; other commands use it when it exists.
+ */
+
+#define ONLINE_TABLE_MAGIC "LVMONLN1"
+#define ONLINE_TABLE_INITIAL_RECORDS 64
+
+struct online_table_header {
+	char magic[8];
+	uint32_t record_size;
+	uint32_t nr_records;
+};
+
+struct online_record {
+	char pvid[ID_LEN];
+	uint32_t in_use;
+	uint32_t major;
+	uint32_t minor;
+	char vgname[NAME_LEN];
+	char devname[NAME_LEN];
+};
+
+static int _table_fd = -1;
+static void *_table_map;
+static size_t _table_map_size;
+
+static int _online_table_exists(void)
+{
+	struct stat st;
+
+	if (_table_fd >= 0)
+		return 1;
+
+	return stat(PVS_ONLINE_TABLE, &st) ? 0 : 1;
+}
+
+static int _online_table_open(int create)
+{
+	if (_table_fd >= 0)
+		return 1;
+
+	if ((_table_fd = open(PVS_ONLINE_TABLE, O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0),
+			      S_IRUSR | S_IWUSR)) < 0) {
+		if (errno != ENOENT)
+			log_sys_debug("open", PVS_ONLINE_TABLE);
+		return 0;
+	}
+
+	return 1;
+}
+
+static void _online_table_unmap(void)
+{
+	if (_table_map && munmap(_table_map, _table_map_size))
+		log_sys_debug("munmap", PVS_ONLINE_TABLE);
+	_table_map = NULL;
+	_table_map_size = 0;
+}
+
+static int _online_table_map(size_t size)
+{
+	if (_table_map && (_table_map_size == size))
+		return 1;
+
+	_online_table_unmap();
+
+	if ((_table_map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, _table_fd, 0)) == MAP_FAILED) {
+		log_sys_debug("mmap", PVS_ONLINE_TABLE);
+		_table_map = NULL;
+		return 0;
+	}
+
+	_table_map_size = size;
+
+	return 1;
+}
+
+static int _online_table_resize(uint32_t nr_records)
+{
+	struct online_table_header *hdr;
+	size_t size = sizeof(*hdr) + (size_t) nr_records * sizeof(struct online_record);
+
+	/* New space is zeroed, i.e. records are not in use. */
+	if (ftruncate(_table_fd, size)) {
+		log_sys_debug("ftruncate", PVS_ONLINE_TABLE);
+		return 0;
+	}
+
+	if (!_online_table_map(size))
+		return_0;
+
+	hdr = _table_map;
+	memcpy(hdr->magic, ONLINE_TABLE_MAGIC, sizeof(hdr->magic));
+	hdr->record_size = sizeof(struct online_record);
+	hdr->nr_records = nr_records;
+
+	log_debug("Online table %s has %u records.", PVS_ONLINE_TABLE, nr_records);
+
+	return 1;
+}
+
+/*
+ * Lock the table and return its header, or NULL when the table does not
+ * exist or is empty.  An exclusive lock initializes an empty table.
+ */
+static struct online_table_header *_online_table_lock(int exclusive)
+{
+	struct online_table_header *hdr;
+	struct stat st;
+
+	if (!_online_table_open(exclusive))
+		return NULL;
+
+	if (flock(_table_fd, exclusive ? LOCK_EX : LOCK_SH)) {
+		log_sys_debug("flock", PVS_ONLINE_TABLE);
+		return NULL;
+	}
+
+	if (fstat(_table_fd, &st)) {
+		log_sys_debug("fstat", PVS_ONLINE_TABLE);
+		goto bad;
+	}
+
+	if ((size_t) st.st_size < sizeof(*hdr)) {
+		if (!exclusive || !_online_table_resize(ONLINE_TABLE_INITIAL_RECORDS))
+			goto bad;
+		return _table_map;
+	}
+
+	if (!_online_table_map(st.st_size))
+		goto_bad;
+
+	hdr = _table_map;
+	if (memcmp(hdr->magic, ONLINE_TABLE_MAGIC, sizeof(hdr->magic)) ||
+	    (hdr->record_size != sizeof(struct online_record)) ||
+	    (sizeof(*hdr) + (size_t) hdr->nr_records * hdr->record_size > (size_t) st.st_size)) {
+		log_warn("WARNING: Ignoring invalid online table %s.", PVS_ONLINE_TABLE);
+		goto bad;
+	}
+
+	return hdr;
+bad:
+	if (flock(_table_fd, LOCK_UN))
+		log_sys_debug("flock", PVS_ONLINE_TABLE);
+	return NULL;
+}
+
+static void _online_table_unlock(void)
+{
+	if (flock(_table_fd, LOCK_UN))
+		log_sys_debug("flock", PVS_ONLINE_TABLE);
+}
+
+static struct online_record *_online_table_records(struct online_table_header *hdr)
+{
+	return (struct online_record *)(hdr + 1);
+}
+
+static struct online_record *_online_table_find(struct online_table_header *hdr, const char *pvid)
+{
+	struct online_record *rec = _online_table_records(hdr);
+	uint32_t i;
+
+	for (i = 0; i < hdr->nr_records; i++)
+		if (rec[i].in_use && !memcmp(rec[i].pvid, pvid, ID_LEN))
+			return &rec[i];
+
+	return NULL;
+}
+
+/* Call with the exclusive lock held, may remap the table. */
+static struct online_record *_online_table_alloc(struct online_table_header *hdr)
+{
+	struct online_record *rec = _online_table_records(hdr);
+	uint32_t i, nr = hdr->nr_records;
+
+	for (i = 0; i < nr; i++)
+		if (!rec[i].in_use)
+			return &rec[i];
+
+	if (!_online_table_resize(nr * 2))
+		return_NULL;
+
+	hdr = _table_map;
+
+	return &_online_table_records(hdr)[nr];
+}
+
+static void _online_record_copy(const struct online_record *rec, unsigned *major, unsigned *minor,
+				char *vgname, char *devname)
+{
+	*major = rec->major;
+	*minor = rec->minor;
+	if (vgname)
+		dm_strncpy(vgname, rec->vgname, NAME_LEN);
+	if (devname)
+		dm_strncpy(devname, rec->devname, NAME_LEN);
+}
+
+static int _online_table_read(const char *pvid, unsigned *major, unsigned *minor,
+			      char *vgname, char *devname)
+{
+	struct online_table_header *hdr;
+	struct online_record *rec;
+	int r = 0;
+
+	if (!(hdr = _online_table_lock(0)))
+		return 0;
+
+	if ((rec = _online_table_find(hdr, pvid))) {
+		_online_record_copy(rec, major, minor, vgname, devname);
+		r = 1;
+	}
+
+	_online_table_unlock();
+
+	return r;
+}
+
+static int _online_table_get_pvs(struct dm_list *pvs_online, const char *vgname)
+{
+	struct online_table_header *hdr;
+	struct online_record *rec;
+	struct pv_online *po;
+	uint32_t i;
+
+	if (!(hdr = _online_table_lock(0)))
+		return 1;
+
+	rec = _online_table_records(hdr);
+
+	for (i = 0; i < hdr->nr_records; i++) {
+		if (!rec[i].in_use)
+			continue;
+
+		if (vgname && strncmp(rec[i].vgname, vgname, NAME_LEN))
+			continue;
+
+		if (!(po = zalloc(sizeof(*po))))
+			continue;
+
+		memcpy(po->pvid, rec[i].pvid, ID_LEN);
+		if (rec[i].major || rec[i].minor)
+			po->devno = MKDEV(rec[i].major, rec[i].minor);
+		dm_strncpy(po->vgname, rec[i].vgname, sizeof(po->vgname));
+		dm_strncpy(po->devname, rec[i].devname, sizeof(po->devname));
+
+		log_debug("Found PV online %s for VG %s %s", po->pvid, vgname ?: "", po->devname);
+		dm_list_add(pvs_online, &po->list);
+	}
+
+	_online_table_unlock();
+
+	log_debug("Found PVs online %u for %s", dm_list_size(pvs_online), vgname ?: "all");
+
+	return 1;
+}
+
+static void _online_table_remove(const char *pvid, unsigned major, unsigned minor)
+{
+	struct online_table_header *hdr;
+	struct online_record *rec;
+	uint32_t i;
+
+	if (!(hdr = _online_table_lock(1)))
+		return;
+
+	rec = _online_table_records(hdr);
+
+	for (i = 0; i < hdr->nr_records; i++) {
+		if (!rec[i].in_use)
+			continue;
+		if (pvid) {
+			if (memcmp(rec[i].pvid, pvid, ID_LEN))
+				continue;
+		} else if ((rec[i].major != major) || (rec[i].minor != minor))
+			continue;
+
+		log_debug("Remove pv online record %.*s %u:%u", ID_LEN, rec[i].pvid, rec[i].major, rec[i].minor);
+
+		if (!pvid && rec[i].vgname[0]) {
+			online_vg_file_remove(rec[i].vgname);
+			online_lookup_file_remove(rec[i].vgname);
+		}
+
+		memset(&rec[i], 0, sizeof(rec[i]));
+	}
+
+	_online_table_unlock();
+}
+
 static int _copy_pvid_file_field(const char *field, char *buf, int bufsize, char *out, int outsize)
 {
 	char *p;
@@ -130,6 +433,19 @@ int online_pvid_file_read(const char *path, unsigned *major, unsigned *minor, ch
 	return 1;
 }
 
+int online_pvid_read(const char *pvid, unsigned *major, unsigned *minor, char *vgname, char *devname)
+{
+	char path[PATH_MAX];
+
+	if (_online_table_exists())
+		return _online_table_read(pvid, major, minor, vgname, devname);
+
+	if (dm_snprintf(path, sizeof(path), "%s/%s", PVS_ONLINE_DIR, pvid) < 0)
+		return_0;
+
+	return online_pvid_file_read(path, major, minor, vgname, devname);
+}
+
 void free_po_list(struct dm_list *list)
 {
 	struct pv_online *po, *po2;
@@ -152,6 +468,9 @@ int get_pvs_online(struct dm_list *pvs_online, const char *vgname)
 	struct pv_online *po;
 	unsigned file_major, file_minor;
 
+	if (_online_table_exists())
+		return _online_table_get_pvs(pvs_online, vgname);
+
 	if (!(dir = opendir(PVS_ONLINE_DIR)))
 		return 0;
 
@@ -246,6 +565,137 @@ int online_vg_file_create(struct cmd_context *cmd, const char *vgname)
 	return 1;
 }
 
+/*
+ * vgs_arrival/<vgname> holds the pid of the pvscan for the most
+ * recently arrived PV of the VG.  Each pvscan overwrites it, waits
+ * for the coalescing window, and then checks if it still holds its
+ * own pid.  If not, a later PV arrived and that pvscan takes over
+ * the VG.  A partial or empty read (from a concurrent writer) is
+ * also a later arrival, so a simple truncate and write is enough.
+ */
+int online_vg_arrival_set(struct cmd_context *cmd, const char *vgname)
+{
+	char path[PATH_MAX];
+	char buf[32];
+	int fd, len;
+
+	if (dm_snprintf(path, sizeof(path), "%s/%s", VGS_ARRIVAL_DIR, vgname) < 0) {
+		log_error_pvscan(cmd, "Path %s/%s is too long.", VGS_ARRIVAL_DIR, vgname);
+		return 0;
+	}
+
+	if ((len = dm_snprintf(buf, sizeof(buf), "%d\n", getpid())) < 0)
+		return_0;
+
+	log_debug("Set vg arrival: %s %d", path, getpid());
+
+	fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		log_debug("Failed to create %s: %d", path, errno);
+		return 0;
+	}
+
+	if (write(fd, buf, len) != len) {
+		log_debug("Failed to write %s: %d", path, errno);
+		if (close(fd))
+			log_sys_debug("close", path);
+		return 0;
+	}
+
+	if (close(fd))
+		log_sys_debug("close", path);
+
+	return 1;
+}
+
+int online_vg_arrival_is_last(const char *vgname)
+{
+	char path[PATH_MAX];
+	char buf[32] = { 0 };
+	ssize_t rv;
+	int fd;
+
+	if (dm_snprintf(path, sizeof(path), "%s/%s", VGS_ARRIVAL_DIR, vgname) < 0)
+		return 1;
+
+	if ((fd = open(path, O_RDONLY)) < 0) {
+		/* Removed by vgremove, let this pvscan continue normally. */
+		log_debug("Failed to open %s: %d", path, errno);
+		return 1;
+	}
+
+	rv = read(fd, buf, sizeof(buf) - 1);
+
+	if (close(fd))
+		log_sys_debug("close", path);
+
+	if (rv <= 0)
+		return 0;
+
+	return (atoi(buf) == getpid()) ? 1 : 0;
+}
+
+void online_vg_arrival_remove(const char *vgname)
+{
+	char path[PATH_MAX] = { 0 };
+
+	if (dm_snprintf(path, sizeof(path), "%s/%s", VGS_ARRIVAL_DIR, vgname) < 0)
+		return;
+
+	if (unlink(path) && (errno != ENOENT))
+		log_sys_debug("unlink", path);
+}
+
+static int _online_table_create(struct cmd_context *cmd, struct device *dev, const char *vgname)
+{
+	struct online_table_header *hdr;
+	struct online_record *rec;
+	unsigned major = MAJOR(dev->dev), minor = MINOR(dev->dev);
+	int r = 1;
+
+	if (!(hdr = _online_table_lock(1))) {
+		log_error_pvscan(cmd, "Failed to lock online table for %s.", dev_name(dev));
+		return 0;
+	}
+
+	if ((rec = _online_table_find(hdr, dev->pvid))) {
+		if ((rec->major == major) && (rec->minor == minor)) {
+			log_debug("Existing online record for %u:%u", major, minor);
+			goto out;
+		}
+
+		log_error_pvscan(cmd, "PV %s %u:%u is duplicate for PVID %s on %u:%u %s.",
+				 dev_name(dev), major, minor, dev->pvid, rec->major, rec->minor, rec->devname);
+
+		if (rec->vgname[0] && vgname && strcmp(rec->vgname, vgname))
+			log_error_pvscan(cmd, "PV %s has unexpected VG %s vs %s.",
+					 dev_name(dev), vgname, rec->vgname);
+		r = 0;
+		goto out;
+	}
+
+	if (!(rec = _online_table_alloc(hdr))) {
+		log_error_pvscan(cmd, "Failed to add online record for %s.", dev_name(dev));
+		r = 0;
+		goto out;
+	}
+
+	log_debug("Create pv online record: %s %u:%u %s.", dev->pvid, major, minor, dev_name(dev));
+
+	rec->major = major;
+	rec->minor = minor;
+	if (vgname)
+		dm_strncpy(rec->vgname, vgname, sizeof(rec->vgname));
+	if (strlen(dev_name(dev)) < sizeof(rec->devname))
+		dm_strncpy(rec->devname, dev_name(dev), sizeof(rec->devname));
+	memcpy(rec->pvid, dev->pvid, ID_LEN);
+	rec->in_use = 1;
+out:
+	_online_table_unlock();
+
+	return r;
+}
+
 int online_pvid_file_create(struct cmd_context *cmd, struct device *dev, const char *vgname)
 {
 	char path[PATH_MAX];
@@ -264,6 +714,9 @@ int online_pvid_file_create(struct cmd_context *cmd, struct device *dev, const c
 	int len2 = 0;
 	int len3 = 0;
 
+	if (_online_table_exists())
+		return _online_table_create(cmd, dev, vgname);
+
 	major = MAJOR(dev->dev);
 	minor = MINOR(dev->dev);
 
@@ -366,8 +819,15 @@ int online_pvid_file_exists(const char *pvid)
 {
 	char path[PATH_MAX] = { 0 };
 	struct stat buf;
+	unsigned major, minor;
 	int rv;
 
+	if (_online_table_exists()) {
+		rv = _online_table_read(pvid, &major, &minor, NULL, NULL);
+		log_debug("Check pv online record %s: %s", pvid, rv ? "yes" : "no");
+		return rv;
+	}
+
 	if (dm_snprintf(path, sizeof(path), "%s/%s", PVS_ONLINE_DIR, pvid) < 0) {
 		log_debug(INTERNAL_ERROR "Path %s/%s is too long.", PVS_ONLINE_DIR, pvid);
 		return 0;
@@ -387,7 +847,6 @@ int online_pvid_file_exists(const char *pvid)
 int get_pvs_lookup(struct dm_list *pvs_online, const char *vgname)
 {
 	char lookup_path[PATH_MAX] = { 0 };
-	char path[PATH_MAX] = { 0 };
 	char line[64];
 	char pvid[ID_LEN + 1] __attribute__((aligned(8))) = { 0 };
 	char file_vgname[NAME_LEN];
@@ -407,14 +866,12 @@ int get_pvs_lookup(struct dm_list *pvs_online, const char *vgname)
 		if (strlen(pvid) != ID_LEN)
 			goto_bad;
 
-		snprintf(path, sizeof(path), "%s/%s", PVS_ONLINE_DIR, pvid);
-
 		file_major = 0;
 		file_minor = 0;
 		memset(file_vgname, 0, sizeof(file_vgname));
 		memset(file_devname, 0, sizeof(file_devname));
 
-		if (!online_pvid_file_read(path, &file_major, &file_minor, file_vgname, file_devname))
+		if (!online_pvid_read(pvid, &file_major, &file_minor, file_vgname, file_devname))
 			goto_bad;
 
 		/*
@@ -440,7 +897,7 @@ int get_pvs_lookup(struct dm_list *pvs_online, const char *vgname)
 		if (file_devname[0])
 			dm_strncpy(po->devname, file_devname, sizeof(po->devname));
 
-		log_debug("Found PV online lookup %s for VG %s on %s.", path, vgname, file_devname);
+		log_debug("Found PV online lookup %s for VG %s on %s.", pvid, vgname, file_devname);
 		dm_list_add(pvs_online, &po->list);
 	}
 
@@ -467,6 +924,20 @@ void online_dir_setup(struct cmd_context *cmd)
 		stack;
 	if (!dir_create_recursive(PVS_LOOKUP_DIR, 0755))
 		stack;
+	if (find_config_tree_int(cmd, global_event_activation_coalesce_ms_CFG, NULL) > 0 &&
+	    !dir_create_recursive(VGS_ARRIVAL_DIR, 0755))
+		stack;
+
+	if (find_config_tree_bool(cmd, global_event_activation_table_CFG, NULL)) {
+		if (_online_table_lock(1))
+			_online_table_unlock();
+		else
+			log_warn("WARNING: Failed to set up online table %s.", PVS_ONLINE_TABLE);
+	} else if (_online_table_exists()) {
+		log_debug("Unlink online table: %s", PVS_ONLINE_TABLE);
+		if (unlink(PVS_ONLINE_TABLE) && (errno != ENOENT))
+			log_sys_debug("unlink", PVS_ONLINE_TABLE);
+	}
 }
 
 void online_lookup_file_remove(const char *vgname)
@@ -488,6 +959,11 @@ static int _online_pvid_file_remove(char *pvid)
 {
 	char path[PATH_MAX] = { 0 };
 
+	if (_online_table_exists()) {
+		_online_table_remove(pvid, 0, 0);
+		return 1;
+	}
+
 	if (dm_snprintf(path, sizeof(path), "%s/%s", PVS_ONLINE_DIR, pvid) < 0)
 		return_0;
 	if (!unlink(path))
@@ -495,6 +971,74 @@ static int _online_pvid_file_remove(char *pvid)
 	return 0;
 }
 
+/*
+ * When a device goes offline we only know its major:minor, not its PVID.
+ * Since the dev isn't around, we can't read it to get its PVID, so we have to
+ * read the PVID files to find the one containing this major:minor and remove
+ * that one. This means that the PVID files need to contain the devno's they
+ * were created from.
+ */
+
+void online_pvid_remove_devno(unsigned major, unsigned minor)
+{
+	char path[PATH_MAX];
+	char file_vgname[NAME_LEN];
+	DIR *dir;
+	struct dirent *de;
+	unsigned file_major, file_minor;
+
+	log_debug("Remove pv online devno %u:%u", major, minor);
+
+	if (_online_table_exists()) {
+		_online_table_remove(NULL, major, minor);
+		return;
+	}
+
+	if (!(dir = opendir(PVS_ONLINE_DIR)))
+		return;
+
+	while ((de = readdir(dir))) {
+		if (de->d_name[0] == '.')
+			continue;
+
+		memset(path, 0, sizeof(path));
+		snprintf(path, sizeof(path), "%s/%s", PVS_ONLINE_DIR, de->d_name);
+
+		file_major = 0;
+		file_minor = 0;
+		memset(file_vgname, 0, sizeof(file_vgname));
+
+		online_pvid_file_read(path, &file_major, &file_minor, file_vgname, NULL);
+
+		if ((file_major == major) && (file_minor == minor)) {
+			log_debug("Unlink pv online %s", path);
+			if (unlink(path) && (errno != ENOENT))
+				log_sys_debug("unlink", path);
+
+			if (file_vgname[0]) {
+				online_vg_file_remove(file_vgname);
+				online_lookup_file_remove(file_vgname);
+			}
+		}
+	}
+	if (closedir(dir))
+		log_sys_debug("closedir", PVS_ONLINE_DIR);
+}
+
+void online_pvid_table_clear(void)
+{
+	struct online_table_header *hdr;
+
+	if (!_online_table_exists() || !(hdr = _online_table_lock(1)))
+		return;
+
+	log_debug("Clear online table %s", PVS_ONLINE_TABLE);
+
+	memset(_online_table_records(hdr), 0, (size_t) hdr->nr_records * sizeof(struct online_record));
+
+	_online_table_unlock();
+}
+
 /*
  * Reboot automatically clearing tmpfs on /run is the main method of removing
  * online files.  It's important to note that removing the online files for a
@@ -516,6 +1060,7 @@ void online_vgremove(struct volume_group *vg)
 
 	online_vg_file_remove(vg->name);
 	online_lookup_file_remove(vg->name);
+	online_vg_arrival_remove(vg->name);
 
 	dm_list_iterate_items(pvl, &vg->pvs) {
 		memcpy(pvid, &pvl->pv->id.uuid, ID_LEN);
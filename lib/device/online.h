@@ -51,8 +51,14 @@ do { \
 int online_pvid_file_read(const char *path, unsigned *major, unsigned *minor, char *vgname, char *devname);
 int online_vg_file_create(struct cmd_context *cmd, const char *vgname);
 void online_vg_file_remove(const char *vgname);
+int online_vg_arrival_set(struct cmd_context *cmd, const char *vgname);
+int online_vg_arrival_is_last(const char *vgname);
+void online_vg_arrival_remove(const char *vgname);
 int online_pvid_file_create(struct cmd_context *cmd, struct device *dev, const char *vgname);
 int online_pvid_file_exists(const char *pvid);
+int online_pvid_read(const char *pvid, unsigned *major, unsigned *minor, char *vgname, char *devname);
+void online_pvid_remove_devno(unsigned major, unsigned minor);
+void online_pvid_table_clear(void);
 void online_dir_setup(struct cmd_context *cmd);
 int get_pvs_online(struct dm_list *pvs_online, const char *vgname);
 int get_pvs_lookup(struct dm_list *pvs_online, const char *vgname);
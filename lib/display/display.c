@@ -896,10 +896,15 @@ void display_formats(const struct cmd_context *cmd)
 	}
 }
 
-void display_segtypes(const struct cmd_context *cmd)
+void display_segtypes(struct cmd_context *cmd)
 {
 	const struct segment_type *segtype;
 
+	if (!init_segtypes(cmd)) {
+		stack;
+		return;
+	}
+
 	dm_list_iterate_items(segtype, &cmd->segtypes) {
 		log_print("%s", segtype->name);
 	}
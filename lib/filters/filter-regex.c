@@ -93,7 +93,8 @@ static int _extract_pattern(struct dm_pool *mem, const char *pat,
 	return 1;
 }
 
-static int _build_matcher(struct rfilter *rf, const struct dm_config_value *val)
+static int _build_matcher(struct rfilter *rf, const struct dm_config_value *val,
+			  const char *cache_file)
 {
 	struct dm_pool *scratch;
 	const struct dm_config_value *v;
@@ -147,8 +148,8 @@ static int _build_matcher(struct rfilter *rf, const struct dm_config_value *val)
 	/*
 	 * build the matcher.
 	 */
-	if (!(rf->engine = dm_regex_create(rf->mem, (const char * const*) regex,
-					   count)))
+	if (!(rf->engine = dm_regex_create_cached(rf->mem, (const char * const*) regex,
+						  count, cache_file)))
 		goto_out;
 	r = 1;
 
@@ -220,13 +221,15 @@ static void _regex_destroy(struct dev_filter *f)
 	if (f->use_count)
 		log_error(INTERNAL_ERROR "Destroying regex filter while in use %u times.", f->use_count);
 
+	dm_regex_destroy(rf->engine);
 	dm_pool_destroy(rf->mem);
 }
 
-struct dev_filter *regex_filter_create(const struct dm_config_value *patterns, int config_filter, int config_global_filter)
+struct dev_filter *regex_filter_create(const struct dm_config_value *patterns, int config_filter, int config_global_filter,
+				      const char *cache_file)
 {
 	struct dm_pool *mem = dm_pool_create("filter regex", 10 * 1024);
-	struct rfilter *rf;
+	struct rfilter *rf = NULL;
 	struct dev_filter *f;
 
 	if (!mem)
@@ -240,7 +243,7 @@ struct dev_filter *regex_filter_create(const struct dm_config_value *patterns, i
 	rf->config_filter = config_filter;
 	rf->config_global_filter = config_global_filter;
 
-	if (!_build_matcher(rf, patterns))
+	if (!_build_matcher(rf, patterns, cache_file))
 		goto_bad;
 
 	if (!(f = dm_pool_zalloc(mem, sizeof(*f))))
@@ -257,6 +260,8 @@ struct dev_filter *regex_filter_create(const struct dm_config_value *patterns, i
 	return f;
 
       bad:
+	if (rf && rf->engine)
+		dm_regex_destroy(rf->engine);
 	dm_pool_destroy(mem);
 	return NULL;
 }
@@ -40,7 +40,8 @@ struct dev_filter *deviceid_filter_create(struct cmd_context *cmd);
  * r|.*|             - reject everything else
  */
 
-struct dev_filter *regex_filter_create(const struct dm_config_value *patterns, int config_filter, int config_global_filter);
+struct dev_filter *regex_filter_create(const struct dm_config_value *patterns, int config_filter, int config_global_filter,
+				      const char *cache_file);
 
 struct dev_filter *usable_filter_create(struct cmd_context *cmd, struct dev_types *dt);
 
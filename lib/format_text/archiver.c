@@ -241,7 +241,7 @@ static int _backup(struct volume_group *vg)
 	return r;
 }
 
-int backup_locally(struct volume_group *vg)
+static int _backup_skipped(struct volume_group *vg)
 {
 	if (!vg->cmd->backup_params->enabled || !vg->cmd->backup_params->dir) {
 		log_warn_suppress(vg->cmd->backup_params->suppress++,
@@ -254,6 +254,14 @@ int backup_locally(struct volume_group *vg)
 		return 1;
 	}
 
+	return 0;
+}
+
+int backup_locally(struct volume_group *vg)
+{
+	if (_backup_skipped(vg))
+		return 1;
+
 	if (!dm_create_dir(vg->cmd->backup_params->dir))
 		return 0;
 
@@ -287,6 +295,29 @@ int backup(struct volume_group *vg)
 	return backup_locally(vg);
 }
 
+/*
+ * Backup of the metadata committed for the VG.  The committed copy
+ * may still have to be imported from the written metadata, which
+ * is only done when the backup is really taken.
+ */
+int backup_committed(struct volume_group *vg)
+{
+	struct volume_group *vg_committed = vg;
+
+	/* Unlock memory if possible */
+	memlock_unlock(vg->cmd);
+
+	if (is_orphan_vg(vg->name) || _backup_skipped(vg))
+		return 1;
+
+	/* Without a committed copy this VG is the committed version */
+	if ((vg->vg_committed || vg->committed_buf) &&
+	    !(vg_committed = vg_get_committed(vg)))
+		return_0;
+
+	return backup_locally(vg_committed);
+}
+
 int backup_remove(struct cmd_context *cmd, const char *vg_name)
 {
 	char path[PATH_MAX];
@@ -200,10 +200,17 @@ static int _out_with_comment_raw(struct formatter *f,
 	va_list apc;
 
 	va_copy(apc, ap);
-	n = vsnprintf(f->data.buf.start + f->data.buf.used,
-		      f->data.buf.size - f->data.buf.used, fmt, apc);
+	n = vsnprintf_simple(f->data.buf.start + f->data.buf.used,
+			     f->data.buf.size - f->data.buf.used, fmt, apc);
 	va_end(apc);
 
+	if (n == -2) {
+		va_copy(apc, ap);
+		n = vsnprintf(f->data.buf.start + f->data.buf.used,
+			      f->data.buf.size - f->data.buf.used, fmt, apc);
+		va_end(apc);
+	}
+
 	/* If metadata doesn't fit, extend buffer */
 	if (n < 0 || (n + f->data.buf.used + 2 > f->data.buf.size)) {
 		if (!_extend_buffer(f))
@@ -1043,6 +1050,31 @@ int text_vg_export_file(struct volume_group *vg, const char *desc, FILE *fp)
 	return r;
 }
 
+/*
+ * Estimate the size of the raw metadata text from the VG content,
+ * so the output buffer does not need to be doubled while exporting
+ * VGs that were created or grew within this command.
+ */
+static uint32_t _export_size_hint(const struct volume_group *vg)
+{
+	const struct lv_list *lvl;
+	const struct lv_segment *seg;
+	uint64_t size = 1024 + 512 * (uint64_t) vg->pv_count +
+		256 * (uint64_t) dm_list_size(&vg->historical_lvs);
+
+	dm_list_iterate_items(lvl, &vg->lvs) {
+		size += 192;
+		dm_list_iterate_items(seg, &lvl->lv->segments)
+			size += 128 + 32 * (uint64_t) seg->area_count;
+	}
+
+	if (size < vg->buffer_size_hint)
+		size = vg->buffer_size_hint;
+
+	/* Metadata area sizes are 32bit, larger text could not be written anyway */
+	return (size < UINT32_MAX / 2) ? (uint32_t) size : UINT32_MAX / 2;
+}
+
 /* Returns amount of buffer used incl. terminating NUL */
 size_t text_vg_export_raw(struct volume_group *vg, const char *desc, char **buf, uint32_t *buf_size)
 {
@@ -1052,7 +1084,7 @@ size_t text_vg_export_raw(struct volume_group *vg, const char *desc, char **buf,
 		.header = 0,
 		.out_with_comment = &_out_with_comment_raw,
 		.nl = &_nl_raw,
-		.data.buf.size = vg->buffer_size_hint + 16384,	/* Initial metadata limit */
+		.data.buf.size = _export_size_hint(vg) + 16384,	/* Initial metadata limit */
 	};
 
 	_init();
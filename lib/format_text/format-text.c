@@ -671,20 +671,31 @@ static int _vg_write_raw(struct format_instance *fid, struct volume_group *vg,
 		fidtc->write_buf_size = write_buf_size;
 		fidtc->new_metadata_size = new_size;
 
-		/* Immediately reuse existing buffer for parsing metadata back.
-		 * Such VG is then used for as precommitted VG and later committed VG.
-		 *
-		 * 'Lazy' creation of such VG might improve performance, but we
-		 * lose important validation that written metadata can be parsed. */
-		if (!(cft = config_tree_from_string_without_dup_node_check(write_buf))) {
-			log_error("Error parsing metadata for VG %s.", vg->name);
-			goto out;
-		}
 		release_vg(vg->vg_precommitted);
-		vg->vg_precommitted = import_vg_from_config_tree(vg->cmd, vg->fid, cft);
-		dm_config_destroy(cft);
-		if (!vg->vg_precommitted)
-			goto_out;
+		vg->vg_precommitted = NULL;
+		free(vg->precommitted_buf);
+		vg->precommitted_buf = NULL;
+
+		/* The precommitted VG becomes the committed VG, which is needed
+		 * only when LVs are activated from it.  Keep a copy of the text
+		 * and import it on demand, unless metadata/check_written_metadata
+		 * asks to parse the metadata back before it is written to disk. */
+		if (find_config_tree_bool(vg->cmd, metadata_check_written_metadata_CFG, NULL)) {
+			if (!(cft = config_tree_from_string_without_dup_node_check(write_buf))) {
+				log_error("Error parsing metadata for VG %s.", vg->name);
+				goto out;
+			}
+			vg->vg_precommitted = import_vg_from_config_tree(vg->cmd, vg->fid, cft);
+			dm_config_destroy(cft);
+			if (!vg->vg_precommitted)
+				goto_out;
+		} else {
+			if (!(vg->precommitted_buf = malloc(new_size))) {
+				log_error("Failed to allocate copy of metadata for VG %s.", vg->name);
+				goto out;
+			}
+			memcpy(vg->precommitted_buf, write_buf, new_size);
+		}
 
 		fidtc->checksum = checksum = calc_crc(INITIAL_CRC, (uint8_t *)write_buf, new_size);
 	}
@@ -85,6 +85,9 @@ struct volume_group *text_read_metadata(struct format_instance *fid,
 				       uint32_t checksum,
 				       time_t *when, char **desc);
 
+int text_metadata_prefetch(const struct format_type *fmt, struct dm_list *mdas, unsigned threads);
+void text_metadata_prefetch_drop(void);
+
 int text_read_metadata_summary(const struct format_type *fmt,
 		       struct device *dev, dev_io_reason_t reason,
 		       off_t offset, uint32_t size,
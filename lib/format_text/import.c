@@ -16,7 +16,13 @@
 #include "lib/misc/lib.h"
 #include "lib/metadata/metadata.h"
 #include "lib/commands/toolcontext.h"
+#include "lib/misc/crc.h"
+#include "lib/config/defaults.h"
 #include "import-export.h"
+#include "layout.h"
+
+#include <ctype.h>
+#include <pthread.h>
 
 /* FIXME Use tidier inclusion method */
 static const struct text_vg_version_ops *(_text_vsn_list[2]);
@@ -99,6 +105,223 @@ int text_read_metadata_summary(const struct format_type *fmt,
 	return r;
 }
 
+/*
+ * Metadata prefetch for commands that read many VGs without changing them.
+ *
+ * The metadata text of the next VGs to be processed is copied out of
+ * bcache and checked against the mda_header checksum in the calling
+ * thread, and then parsed into config trees by worker threads.  When
+ * text_read_metadata() is later asked for metadata with the same
+ * device, offset, checksum and size, it takes the parsed tree instead
+ * of reading and parsing the text again.  A tree is only given back
+ * to the mda its text was read from, so every mda is still read and
+ * checked on its own.  Anything that changed in the meantime has a
+ * different location or checksum and is simply read the normal way.
+ *
+ * Only libdm config parsing runs in the workers, each on its own tree
+ * and pool; bcache, lvmcache and VG import stay single threaded.
+ */
+struct prefetched_mda {
+	struct dm_list list;
+	struct dm_config_tree *cft;
+	struct device *dev;
+	uint64_t offset;
+	char *buf;
+	uint32_t size;
+	uint32_t checksum;
+	int parsed;
+};
+
+struct prefetch_work {
+	struct prefetched_mda **pms;
+	unsigned count;
+	unsigned next;
+};
+
+static DM_LIST_INIT(_prefetched_mdas);
+
+static void _prefetched_mda_free(struct prefetched_mda *pm)
+{
+	dm_list_del(&pm->list);
+	if (pm->cft)
+		config_destroy(pm->cft);
+	free(pm->buf);
+	free(pm);
+}
+
+static struct prefetched_mda *_prefetched_mda_find(struct device *dev, uint64_t offset,
+						   uint32_t checksum, uint32_t size)
+{
+	struct prefetched_mda *pm;
+
+	dm_list_iterate_items(pm, &_prefetched_mdas)
+		if ((pm->dev == dev) && (pm->offset == offset) &&
+		    (pm->checksum == checksum) && (pm->size == size))
+			return pm;
+
+	return NULL;
+}
+
+/* Copy the committed metadata text of an mda, verified by its checksum. */
+static struct prefetched_mda *_prefetch_mda_read(const struct format_type *fmt, struct metadata_area *mda)
+{
+	struct mda_context *mdac = (struct mda_context *) mda->metadata_locn;
+	struct device_area *area = &mdac->area;
+	struct prefetched_mda *pm = NULL;
+	struct mda_header *mdah;
+	struct raw_locn *rlocn;
+	char namebuf[NAME_LEN];
+	uint32_t bad_fields = 0;
+	uint32_t wrap = 0, size;
+	char *buf = NULL;
+	int namelen = 0;
+
+	if (!(mdah = raw_read_mda_header(fmt, area, mda_is_primary(mda), 0, &bad_fields)))
+		return_NULL;
+
+	rlocn = mdah->raw_locns;
+
+	if (bad_fields || !rlocn->offset || !rlocn->size ||
+	    (rlocn->offset >= mdah->size) ||
+	    (rlocn->size > mdah->size - MDA_HEADER_SIZE))
+		goto out;
+
+	if (_prefetched_mda_find(area->dev, area->start + rlocn->offset,
+				 rlocn->checksum, (uint32_t) rlocn->size))
+		goto out;
+
+	if (rlocn->offset + rlocn->size > mdah->size)
+		wrap = (uint32_t) ((rlocn->offset + rlocn->size) - mdah->size);
+	size = (uint32_t) rlocn->size - wrap;
+
+	if (!(buf = zalloc(rlocn->size + 1)))
+		goto_out;
+
+	if (!dev_read_bytes(area->dev, area->start + rlocn->offset, size, buf) ||
+	    (wrap && !dev_read_bytes(area->dev, area->start + MDA_HEADER_SIZE, wrap, buf + size)))
+		goto_out;
+
+	if (calc_crc(INITIAL_CRC, (const uint8_t *) buf, (uint32_t) rlocn->size) != rlocn->checksum)
+		goto_out;
+
+	while (buf[namelen] && !isspace(buf[namelen]) && (buf[namelen] != '{') && (namelen < (NAME_LEN - 1)))
+		namelen++;
+	memcpy(namebuf, buf, namelen);
+	namebuf[namelen] = '\0';
+	if (!validate_name(namebuf))
+		goto_out;
+
+	if (!(pm = zalloc(sizeof(*pm))))
+		goto_out;
+
+	if (!(pm->cft = config_open(CONFIG_FILE_SPECIAL, NULL, 0))) {
+		free(pm);
+		pm = NULL;
+		goto_out;
+	}
+
+	pm->dev = area->dev;
+	pm->offset = area->start + rlocn->offset;
+	pm->buf = buf;
+	pm->size = (uint32_t) rlocn->size;
+	pm->checksum = rlocn->checksum;
+	buf = NULL;
+out:
+	free(buf);
+	dm_pool_free(fmt->cmd->mem, mdah);
+
+	return pm;
+}
+
+static void *_prefetch_worker(void *arg)
+{
+	struct prefetch_work *w = arg;
+	struct prefetched_mda *pm;
+	unsigned i;
+
+	while ((i = __atomic_fetch_add(&w->next, 1, __ATOMIC_RELAXED)) < w->count) {
+		pm = w->pms[i];
+		/* Checksum is verified, so the text is what lvm wrote. */
+		pm->parsed = dm_config_parse_without_dup_node_check(pm->cft, pm->buf, pm->buf + pm->size);
+	}
+
+	return NULL;
+}
+
+int text_metadata_prefetch(const struct format_type *fmt, struct dm_list *mdas, unsigned threads)
+{
+	pthread_t tids[DEFAULT_REP_VG_READ_THREADS_MAX];
+	struct prefetch_work w = { 0 };
+	struct prefetched_mda *pm;
+	struct mda_list *mdal;
+	unsigned nr_threads = 0, i;
+
+	_init_text_import();
+
+	if (!(w.pms = zalloc((dm_list_size(mdas) + 1) * sizeof(*w.pms))))
+		return_0;
+
+	dm_list_iterate_items(mdal, mdas) {
+		if (!(pm = _prefetch_mda_read(fmt, mdal->mda)))
+			continue;
+		dm_list_add(&_prefetched_mdas, &pm->list);
+		w.pms[w.count++] = pm;
+	}
+
+	/* Calling thread is a worker too. */
+	while ((nr_threads + 1 < threads) &&
+	       (nr_threads + 1 < w.count) &&
+	       (nr_threads < DM_ARRAY_SIZE(tids))) {
+		if (pthread_create(&tids[nr_threads], NULL, _prefetch_worker, &w)) {
+			log_debug_metadata("Failed to create metadata prefetch thread.");
+			break;
+		}
+		nr_threads++;
+	}
+
+	log_debug_metadata("Prefetching metadata of %u VGs with %u threads.", w.count, nr_threads + 1);
+
+	(void) _prefetch_worker(&w);
+
+	for (i = 0; i < nr_threads; i++)
+		if (pthread_join(tids[i], NULL))
+			log_debug_metadata("Failed to join metadata prefetch thread.");
+
+	for (i = 0; i < w.count; i++)
+		if (!w.pms[i]->parsed)
+			_prefetched_mda_free(w.pms[i]);
+
+	free(w.pms);
+
+	return 1;
+}
+
+void text_metadata_prefetch_drop(void)
+{
+	struct prefetched_mda *pm, *tmp;
+
+	dm_list_iterate_items_safe(pm, tmp, &_prefetched_mdas)
+		_prefetched_mda_free(pm);
+}
+
+/* Hand over a parsed tree matching the metadata about to be read. */
+static struct dm_config_tree *_prefetched_cft_take(struct device *dev, uint64_t offset,
+						   uint32_t checksum, uint32_t size)
+{
+	struct prefetched_mda *pm;
+	struct dm_config_tree *cft;
+
+	if (dm_list_empty(&_prefetched_mdas) ||
+	    !(pm = _prefetched_mda_find(dev, offset, checksum, size)))
+		return NULL;
+
+	cft = pm->cft;
+	pm->cft = NULL;
+	_prefetched_mda_free(pm);
+
+	return cft;
+}
+
 struct cached_vg_fmtdata {
         uint32_t cached_mda_checksum;
         size_t cached_mda_size;
@@ -116,7 +339,7 @@ struct volume_group *text_read_metadata(struct format_instance *fid,
 				       time_t *when, char **desc)
 {
 	struct volume_group *vg = NULL;
-	struct dm_config_tree *cft;
+	struct dm_config_tree *cft, *prefetched_cft;
 	const struct text_vg_version_ops **vsn;
 	int skip_parse;
 
@@ -149,7 +372,14 @@ struct volume_group *text_read_metadata(struct format_instance *fid,
 		     ((*vg_fmtdata)->cached_mda_size == (size + size2));
 
 
-	if (dev) {
+	if (dev && !skip_parse &&
+	    (prefetched_cft = _prefetched_cft_take(dev, (uint64_t) offset, checksum, size + size2))) {
+		log_debug_metadata("Using prefetched metadata from %s at %llu size %u (+%u).",
+				   dev_name(dev), (unsigned long long)offset,
+				   size, size2);
+		config_destroy(cft);
+		cft = prefetched_cft;
+	} else if (dev) {
 		log_debug_metadata("Reading metadata from %s at %llu size %u (+%u).",
 				   dev_name(dev), (unsigned long long)offset,
 				   size, size2);
@@ -153,7 +153,22 @@ static int _read_flag_config(const struct dm_config_node *n, uint64_t *status, e
 	return 1;
 }
 
-static int _read_str_list(struct dm_pool *mem, struct dm_list *list, const struct dm_config_value *cv)
+/*
+ * Names, tags and type strings repeat across the PVs, LVs and VGs a
+ * command reads, share a single copy per command.
+ */
+static const char *_intern_str(struct cmd_context *cmd, struct dm_pool *mem, const char *str)
+{
+	const char *s;
+
+	if ((s = cmd_intern_str(cmd, str)))
+		return s;
+
+	return dm_pool_strdup(mem, str);
+}
+
+static int _read_str_list(struct cmd_context *cmd, struct dm_pool *mem,
+			  struct dm_list *list, const struct dm_config_value *cv)
 {
 	if (cv->type == DM_CFG_EMPTY_ARRAY)
 		return 1;
@@ -164,7 +179,7 @@ static int _read_str_list(struct dm_pool *mem, struct dm_list *list, const struc
 			return 0;
 		}
 
-		if (!str_list_add(mem, list, dm_pool_strdup(mem, cv->v.str)))
+		if (!str_list_add(mem, list, _intern_str(cmd, mem, cv->v.str)))
 			return_0;
 
 	} while ((cv = cv->next));
@@ -212,7 +227,7 @@ static int _read_pv(struct cmd_context *cmd,
 
         pv->is_labelled = 1; /* All format_text PVs are labelled. */
 
-	if (!(pv->vg_name = dm_pool_strdup(mem, vg->name)))
+	if (!(pv->vg_name = _intern_str(cmd, mem, vg->name)))
 		return_0;
 
 	/* both are struct id */
@@ -245,7 +260,7 @@ static int _read_pv(struct cmd_context *cmd,
 	}
 
 	if (dm_config_get_str(pvn, "device_id_type", &str)) {
-		if (!(pv->device_id_type = dm_pool_strdup(mem, str))) {
+		if (!(pv->device_id_type = _intern_str(cmd, mem, str))) {
 			log_error("Failed to allocate memory for device_id_type in read_pv.");
 			return 0;
 		}
@@ -284,7 +299,7 @@ static int _read_pv(struct cmd_context *cmd,
 
 	/* Optional tags */
 	if (dm_config_get_list(pvn, "tags", &cv) &&
-	    !(_read_str_list(mem, &pv->tags, cv))) {
+	    !(_read_str_list(cmd, mem, &pv->tags, cv))) {
 		log_error("Couldn't read tags for physical volume %s in %s.",
 			  pv_dev_name(pv), vg->name);
 		return 0;
@@ -352,7 +367,7 @@ static int _read_pvsummary(struct cmd_context *cmd,
 	}
 
 	if (dm_config_get_str(pvn, "device_id_type", &str)) {
-		if (!(pv->device_id_type = dm_pool_strdup(mem, str))) {
+		if (!(pv->device_id_type = _intern_str(cmd, mem, str))) {
 			log_error("Failed to allocate memory for device_id_type in read_pv_sum.");
 			return 0;
 		}
@@ -473,7 +488,7 @@ static int _read_segment(struct cmd_context *cmd,
 
 	/* Optional tags */
 	if (dm_config_get_list(sn_child, "tags", &cv) &&
-	    !(_read_str_list(mem, &seg->tags, cv))) {
+	    !(_read_str_list(cmd, mem, &seg->tags, cv))) {
 		log_error("Couldn't read tags for a segment of %s/%s.",
 			  lv->vg->name, lv->name);
 		return 0;
@@ -575,6 +590,58 @@ int text_import_areas(struct lv_segment *seg, const struct dm_config_node *sn,
 	return 1;
 }
 
+/*
+ * Reserve one block for the segments and areas of an LV with several
+ * segments, so alloc_lv_segment() lays them out next to each other
+ * instead of between the other allocations made while importing them.
+ * Whole-VG walks over lv->segments then stay within few cache lines.
+ * Malformed segments are reported by _read_segment() later.
+ */
+static void _reserve_segments(struct cmd_context *cmd, struct dm_pool *mem,
+			      struct logical_volume *lv, const struct dm_config_node *lvn)
+{
+	const struct dm_config_node *sn;
+	const struct segment_type *segtype;
+	const char *segtype_str;
+	uint64_t status = 0;
+	uint32_t area_count;
+	unsigned count = 0;
+	size_t size = 0;
+	int old_suppress;
+
+	for (sn = lvn; sn; sn = sn->sib)
+		if (!sn->v)
+			count++;
+
+	if (count < 2)
+		return;
+
+	old_suppress = log_suppress(1);
+
+	for (sn = lvn; sn; sn = sn->sib) {
+		if (sn->v)
+			continue;
+
+		area_count = 0;
+		if (!sn->child ||
+		    !dm_config_get_str(sn->child, "type", &segtype_str) ||
+		    !(segtype = _read_segtype_and_lvflags(cmd, &status, segtype_str)) ||
+		    (segtype->ops->text_import_area_count &&
+		     !segtype->ops->text_import_area_count(sn->child, &area_count)) ||
+		    (area_count > MAX_STRIPES)) {
+			size = 0;
+			break;
+		}
+
+		size += lv_segment_size(segtype, area_count);
+	}
+
+	log_suppress(old_suppress);
+
+	if (size && (lv->vg->seg_arena = dm_pool_alloc(mem, size)))
+		lv->vg->seg_arena_end = lv->vg->seg_arena + size;
+}
+
 static int _read_segments(struct cmd_context *cmd,
 			  struct format_type *fmt,
 			  struct format_instance *fid,
@@ -583,6 +650,9 @@ static int _read_segments(struct cmd_context *cmd,
 {
 	const struct dm_config_node *sn;
 	int count = 0, seg_count;
+	int r = 0;
+
+	_reserve_segments(cmd, mem, lv, lvn);
 
 	for (sn = lvn; sn; sn = sn->sib) {
 
@@ -591,17 +661,24 @@ static int _read_segments(struct cmd_context *cmd,
 		 */
 		if (!sn->v) {
 			if (!_read_segment(cmd, fmt, fid, mem, lv, sn))
-				return_0;
+				goto_out;
 
 			count++;
 		}
 		/* FIXME Remove this restriction */
 		if (lv_is_snapshot(lv) && count > 1) {
 			log_error("Only one segment permitted for snapshot");
-			return 0;
+			goto out;
 		}
 	}
 
+	r = 1;
+out:
+	lv->vg->seg_arena = lv->vg->seg_arena_end = NULL;
+
+	if (!r)
+		return 0;
+
 	if (!_read_int32(lvn, "segment_count", &seg_count)) {
 		log_error("Couldn't read segment count for logical volume %s.",
 			  lv->name);
@@ -650,7 +727,7 @@ static int _read_lvnames(struct cmd_context *cmd,
 	if (!link_lv_to_vg(vg, lv))
 		return_0;
 
-	if (!(str = dm_pool_strdup(mem, lvn->key)) ||
+	if (!(str = _intern_str(cmd, mem, lvn->key)) ||
 	    !lv_set_name(lv, str))
 		return_0;
 
@@ -753,7 +830,7 @@ static int _read_lvnames(struct cmd_context *cmd,
 
 	/* Optional tags */
 	if (dm_config_get_list(lvn, "tags", &cv) &&
-	    !(_read_str_list(mem, &lv->tags, cv))) {
+	    !(_read_str_list(cmd, mem, &lv->tags, cv))) {
 		log_error("Couldn't read tags for logical volume %s.",
 			  display_lvname(lv));
 		return 0;
@@ -1080,11 +1157,14 @@ static struct volume_group *_read_vg(struct cmd_context *cmd,
 		return NULL;
 	}
 
-	if (!(vg = alloc_vg("read_vg", cmd, vgn->key)))
+	if (!(vg = alloc_vg("read_vg", cmd, NULL)))
 		return_NULL;
 
 	mem = vg->vgmem;
 
+	if (!(vg->name = _intern_str(cmd, mem, vgn->key)))
+		goto_bad;
+
 	/*
 	 * The pv_names memorizes the pv section names -> pv
 	 * structures.
@@ -1113,7 +1193,7 @@ static struct volume_group *_read_vg(struct cmd_context *cmd,
 	}
 
 	if (dm_config_get_str(vgn, "lock_type", &str)) {
-		if (!(vg->lock_type = dm_pool_strdup(mem, str)))
+		if (!(vg->lock_type = _intern_str(cmd, mem, str)))
 			goto bad;
 	}
 
@@ -1150,7 +1230,7 @@ static struct volume_group *_read_vg(struct cmd_context *cmd,
 	if (dm_config_get_list(vgn, "pr", &cv)) {
 		struct dm_list pr_list;
 		dm_list_init(&pr_list);
-		if (!_read_str_list(mem, &pr_list, cv)) {
+		if (!_read_str_list(cmd, mem, &pr_list, cv)) {
 			log_error("Couldn't read pr for volume group %s.", vg->name);
 			goto bad;
 		}
@@ -1180,7 +1260,7 @@ static struct volume_group *_read_vg(struct cmd_context *cmd,
 	}
 
 	if (dm_config_get_str(vgn, "system_id", &system_id)) {
-		if (!(vg->system_id = dm_pool_strdup(mem, system_id))) {
+		if (!(vg->system_id = _intern_str(cmd, mem, system_id))) {
 			log_error("Failed to allocate memory for system_id in _read_vg.");
 			goto bad;
 		}
@@ -1245,7 +1325,7 @@ static struct volume_group *_read_vg(struct cmd_context *cmd,
 
 	/* Optional tags */
 	if (dm_config_get_list(vgn, "tags", &cv) &&
-	    !(_read_str_list(mem, &vg->tags, cv))) {
+	    !(_read_str_list(cmd, mem, &vg->tags, cv))) {
 		log_error("Couldn't read tags for volume group %s.", vg->name);
 		goto bad;
 	}
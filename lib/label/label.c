@@ -27,6 +27,7 @@
 #include "lib/format_text/layout.h"
 #include "lib/device/device_id.h"
 #include "lib/device/online.h"
+#include "lib/misc/lvm-perf.h"
 
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -643,6 +644,8 @@ static int _scan_list(struct cmd_context *cmd, struct dev_filter *f,
 
 	log_debug_devs("Scanning %u devices for VG info.", dm_list_size(devs));
 
+	perf_phase_start(PERF_PHASE_LABEL_SCAN);
+
  scan_more:
 	rem_prefetches = bcache_max_prefetches(scan_bcache);
 	submit_count = 0;
@@ -756,6 +759,8 @@ static int _scan_list(struct cmd_context *cmd, struct dev_filter *f,
 
 	dm_list_splice(devs, &done_devs);
 
+	perf_phase_end(PERF_PHASE_LABEL_SCAN);
+
 	return 1;
 }
 
@@ -57,6 +57,7 @@ struct daemon_parms {
 	unsigned background;
 	unsigned outstanding_count;
 	unsigned progress_display;
+	unsigned rescan_vg_only;	/* rescan only PVs of the polled VG */
 	const char *progress_title;
 	uint64_t lv_type;
 	const struct poll_functions *poll_fns;
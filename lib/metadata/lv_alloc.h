@@ -18,6 +18,7 @@
 
 #include "lib/metadata/metadata-exported.h"
 
+size_t lv_segment_size(const struct segment_type *segtype, uint32_t area_count);
 struct lv_segment *alloc_lv_segment(const struct segment_type *segtype,
 				    struct logical_volume *lv,
 				    uint32_t le, uint32_t len,
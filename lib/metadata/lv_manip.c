@@ -1034,6 +1034,17 @@ static int _validate_area_count(uint32_t area_count)
 	return 1;
 }
 
+/*
+ * Size of the block alloc_lv_segment() uses for a segment and its areas.
+ */
+size_t lv_segment_size(const struct segment_type *segtype, uint32_t area_count)
+{
+	size_t areas_sz = area_count * sizeof(struct lv_segment_area);
+
+	return sizeof(struct lv_segment) +
+		(segtype_is_raid_with_meta(segtype) ? 2 * areas_sz : areas_sz);
+}
+
 /*
  * All lv_segments get created here.
  */
@@ -1053,8 +1064,8 @@ struct lv_segment *alloc_lv_segment(const struct segment_type *segtype,
 				    struct lv_segment *pvmove_source_seg)
 {
 	struct lv_segment *seg;
-	struct dm_pool *mem = lv->vg->vgmem;
-	uint32_t areas_sz;
+	struct volume_group *vg = lv->vg;
+	size_t seg_sz;
 
 	if (!segtype) {
 		log_error(INTERNAL_ERROR "alloc_lv_segment: Missing segtype.");
@@ -1064,21 +1075,23 @@ struct lv_segment *alloc_lv_segment(const struct segment_type *segtype,
 	if (!_validate_area_count(area_count))
 		return_NULL;
 
-	areas_sz = area_count * sizeof(*seg->areas);
+	seg_sz = lv_segment_size(segtype, area_count);
 
-	if (!(seg = dm_pool_zalloc(mem, sizeof(*seg))))
+	/*
+	 * Segment and its areas share one allocation, taken from the block
+	 * metadata import reserved for all segments of the LV if possible.
+	 */
+	if (vg->seg_arena && ((size_t) (vg->seg_arena_end - vg->seg_arena) >= seg_sz)) {
+		seg = (struct lv_segment *) vg->seg_arena;
+		vg->seg_arena += seg_sz;
+		memset(seg, 0, seg_sz);
+	} else if (!(seg = dm_pool_zalloc(vg->vgmem, seg_sz)))
 		return_NULL;
 
-	if (!(seg->areas = dm_pool_zalloc(mem, areas_sz))) {
-		dm_pool_free(mem, seg);
-		return_NULL;
-	}
+	seg->areas = (struct lv_segment_area *) (seg + 1);
 
-	if (segtype_is_raid_with_meta(segtype) &&
-	    !(seg->meta_areas = dm_pool_zalloc(mem, areas_sz))) {
-		dm_pool_free(mem, seg); /* frees everything allocated since seg */
-		return_NULL;
-	}
+	if (segtype_is_raid_with_meta(segtype))
+		seg->meta_areas = seg->areas + area_count;
 
 	seg->segtype = segtype;
 	seg->lv = lv;
@@ -5136,12 +5149,44 @@ static uint32_t _adjust_amount(dm_percent_t percent, int policy_threshold, int p
 	return (policy_amount < percent) ? (uint32_t) percent : (uint32_t) policy_amount;
 }
 
+/*
+ * Extend a thin pool that dmeventd predicts to become full within
+ * dmeventd/thin_forecast seconds, even when the autoextend threshold
+ * has not been reached yet.
+ */
+static void _adjust_amount_by_forecast(const struct logical_volume *lv,
+				       dm_percent_t data_percent, dm_percent_t metadata_percent,
+				       int policy_amount, uint32_t *amount, uint32_t *meta_amount)
+{
+	int forecast = find_config_tree_int(lv->vg->cmd, dmeventd_thin_forecast_CFG, NULL);
+	int64_t data_seconds, metadata_seconds;
+
+	if ((forecast <= 0) || !thin_pool_time_to_full(lv, &data_seconds, &metadata_seconds))
+		return;
+
+	if (!*amount && (data_seconds >= 0) && (data_seconds <= forecast) &&
+	    (data_percent > (50 * DM_PERCENT_1)) && (data_percent <= DM_PERCENT_100)) {
+		log_verbose("Thin pool %s data is predicted to be full in " FMTd64 " seconds.",
+			    display_lvname(lv), data_seconds);
+		*amount = policy_amount;
+	}
+
+	if (!*meta_amount && (metadata_seconds >= 0) && (metadata_seconds <= forecast) &&
+	    (metadata_percent > (50 * DM_PERCENT_1)) && (metadata_percent <= DM_PERCENT_100)) {
+		log_verbose("Thin pool %s metadata is predicted to be full in " FMTd64 " seconds.",
+			    display_lvname(lv), metadata_seconds);
+		/* Compensate possible extra space consumption by kernel on resize */
+		*meta_amount = policy_amount + 1;
+	}
+}
+
 /* "amount" here is percent */
 int lv_extend_policy_calculate_percent(struct logical_volume *lv,
 				       uint32_t *amount, uint32_t *meta_amount)
 {
 	struct cmd_context *cmd = lv->vg->cmd;
 	dm_percent_t percent;
+	dm_percent_t metadata_percent = DM_PERCENT_INVALID;
 	dm_percent_t min_threshold;
 	int policy_threshold, policy_amount;
 	struct lv_status_thin_pool *thin_pool_status;
@@ -5208,6 +5253,7 @@ int lv_extend_policy_calculate_percent(struct logical_volume *lv,
 			/* Compensate possible extra space consumption by kernel on resize */
 			(*meta_amount)++;
 		percent = thin_pool_status->data_usage;
+		metadata_percent = thin_pool_status->metadata_usage;
 		dm_pool_destroy(thin_pool_status->mem);
 	} else if (lv_is_vdo_pool(lv)) {
 		if (!lv_vdo_pool_percent(lv, &percent))
@@ -5223,6 +5269,10 @@ int lv_extend_policy_calculate_percent(struct logical_volume *lv,
 
 	*amount = _adjust_amount(percent, policy_threshold, policy_amount);
 
+	if (lv_is_thin_pool(lv))
+		_adjust_amount_by_forecast(lv, percent, metadata_percent, policy_amount,
+					   amount, meta_amount);
+
 	log_debug("lvextend policy calculated percentages main %u meta %u from threshold %d percent %d",
 		  *amount, *meta_amount, policy_threshold, policy_amount);
 	return 1;
@@ -9451,6 +9501,36 @@ static int _vg_check_features(struct volume_group *vg,
 	return 1;
 }
 
+/*
+ * Existing thin pool has to be active and below its threshold
+ * before a new thin volume is created in it.
+ */
+static int _check_thin_pool_for_new_lv(struct cmd_context *cmd,
+				       struct logical_volume *pool_lv)
+{
+	if (lv_is_new_thin_pool(pool_lv)) {
+		if (!check_new_thin_pool(pool_lv))
+			return_0;
+		/* New pool is now inactive */
+		return 1;
+	}
+
+	if (!activate_lv(cmd, pool_lv)) {
+		log_error("Aborting. Failed to locally activate thin pool %s.",
+			  display_lvname(pool_lv));
+		return 0;
+	}
+
+	if (!thin_pool_below_threshold(first_seg(pool_lv))) {
+		log_error("Cannot create new thin volume, free space in "
+			  "thin pool %s reached threshold.",
+			  display_lvname(pool_lv));
+		return 0;
+	}
+
+	return 1;
+}
+
 /* Thin notes:
  * If lp->thin OR lp->activate is AY*, activate the pool if not already active.
  * If lp->thin, create thin LV within the pool - as a snapshot if lp->snapshot.
@@ -9624,23 +9704,8 @@ static struct logical_volume *_lv_create_an_lv(struct volume_group *vg,
 				 * When command is finished we will make sure thin-pool will
 				 * be actually left active */
 				;
-			} else if (lv_is_new_thin_pool(pool_lv)) {
-				if (!check_new_thin_pool(pool_lv))
-					return_NULL;
-				/* New pool is now inactive */
-			} else {
-				if (!activate_lv(cmd, pool_lv)) {
-					log_error("Aborting. Failed to locally activate thin pool %s.",
-						  display_lvname(pool_lv));
-					return NULL;
-				}
-				if (!thin_pool_below_threshold(first_seg(pool_lv))) {
-					log_error("Cannot create new thin volume, free space in "
-						  "thin pool %s reached threshold.",
-						  display_lvname(pool_lv));
-					return NULL;
-				}
-			}
+			} else if (!_check_thin_pool_for_new_lv(cmd, pool_lv))
+				return_NULL;
 		}
 
 		if (seg_is_cache(lp) &&
@@ -10345,3 +10410,257 @@ struct logical_volume *lv_create_single(struct volume_group *vg,
 
 	return lv;
 }
+
+static struct logical_volume *_lv_create_thin_snapshot(struct volume_group *vg,
+						       struct logical_volume *origin_lv,
+						       const char *name,
+						       const struct lvcreate_params *lp)
+{
+	struct logical_volume *lv, *pool_lv = first_seg(origin_lv)->pool_lv;
+	struct lv_segment *seg, *pool_seg = first_seg(pool_lv);
+	const struct segment_type *segtype;
+	const struct dm_str_list *sl;
+
+	if (!(segtype = get_segtype_from_string(vg->cmd, SEG_TYPE_NAME_THIN)))
+		return_NULL;
+
+	if (!(lv = lv_create_empty(name ? : "lvol%d", NULL,
+				   lp->permission | VISIBLE_LV, ALLOC_INHERIT, vg)))
+		return_NULL;
+
+	lv->read_ahead = lp->read_ahead;
+
+	dm_list_iterate_items(sl, &lp->tags)
+		if (!str_list_add(vg->vgmem, &lv->tags, sl->str))
+			return_NULL;
+
+	if (!lv_extend(lv, segtype, 1, 0, 1, 0, origin_lv->le_count,
+		       &vg->pvs, ALLOC_INHERIT, 0)) {
+		unlink_lv_from_vg(lv); /* Keep VG consistent and remove LV without any segment */
+		return_NULL;
+	}
+
+	seg = first_seg(lv);
+	if (!(seg->device_id = get_free_thin_pool_device_id(pool_seg)))
+		return_NULL;
+	seg->transaction_id = pool_seg->transaction_id;
+
+	if (!attach_pool_lv(seg, pool_lv, origin_lv, NULL, NULL) ||
+	    !attach_thin_external_origin(seg, first_seg(origin_lv)->external_lv) ||
+	    !attach_thin_pool_message(pool_seg, DM_THIN_MESSAGE_CREATE_THIN, lv, 0, 0))
+		return_NULL;
+
+	if (!thin_pool_check_overprovisioning(lv))
+		return_NULL;
+
+	lv_set_activation_skip(lv, lp->activation_skip & ACTIVATION_SKIP_SET,
+			       lp->activation_skip & ACTIVATION_SKIP_SET_ENABLED);
+
+	if (lp->noautoactivate)
+		lv->status |= LV_NOAUTOACTIVATE;
+
+	return lv;
+}
+
+/*
+ * Remove snapshots of a thin snapshot set that could not be completed,
+ * so the set is either created whole or not at all.
+ */
+static void _remove_thin_snapshot_set(struct cmd_context *cmd, struct dm_list *snapshots)
+{
+	struct lv_list *lvl;
+
+	log_error("Removing incomplete thin snapshot set.");
+
+	dm_list_iterate_items(lvl, snapshots)
+		if (!lv_remove_with_dependencies(cmd, lvl->lv, DONT_PROMPT, 0))
+			log_error("Failed to remove thin snapshot %s. "
+				  "Manual intervention may be required.",
+				  display_lvname(lvl->lv));
+}
+
+/*
+ * Create thin snapshots of all thin LVs from 'origins' (struct lv_list).
+ * All create messages are queued and committed with a single metadata
+ * update and all active origins are suspended together before messages
+ * are delivered, so the set of snapshots represents one point in time.
+ * With 'suffix' each snapshot is named <origin>_<suffix>.
+ */
+int lv_create_thin_snapshot_set(struct volume_group *vg, struct dm_list *origins,
+				const char *suffix, struct lvcreate_params *lp)
+{
+	struct cmd_context *cmd = vg->cmd;
+	struct dm_list snapshots, inactive_pools;
+	struct lv_list *lvl, *olvl;
+	struct logical_volume *pool_lv;
+	activation_change_t activate;
+	char name[NAME_LEN];
+	unsigned suspended = 0, resumed = 0;
+	int delivered, need_commit = 0;
+	int r = 1;
+
+	dm_list_init(&snapshots);
+	dm_list_init(&inactive_pools);
+
+	if (vg_is_shared(vg)) {
+		log_error("Thin snapshot set is not supported in shared VG %s.", vg->name);
+		return 0;
+	}
+
+	if (lp->minor >= 0) {
+		log_error("Persistent minor number is not supported with multiple thin snapshot origins.");
+		return 0;
+	}
+
+	dm_list_iterate_items(lvl, origins) {
+		if (!lv_is_thin_volume(lvl->lv)) {
+			log_error("Logical volume %s is not a thin volume.",
+				  display_lvname(lvl->lv));
+			return 0;
+		}
+
+		if (lv_is_locked(lvl->lv)) {
+			log_error("Snapshots of locked devices are not supported.");
+			return 0;
+		}
+
+		pool_lv = first_seg(lvl->lv)->pool_lv;
+		/* Pool of an earlier origin is already active here */
+		if (!lv_is_new_thin_pool(pool_lv) && !lv_is_active(pool_lv)) {
+			/* Restore inactive state when done */
+			if (!(olvl = dm_pool_alloc(cmd->mem, sizeof(*olvl))))
+				return_0;
+			olvl->lv = pool_lv;
+			dm_list_add(&inactive_pools, &olvl->list);
+		}
+
+		/* Same checks as for a single thin volume */
+		if (!_check_thin_pool_for_new_lv(cmd, pool_lv))
+			return_0;
+
+		/* Ensure all stacked messages are submitted */
+		if (thin_pool_is_active(pool_lv) && !update_thin_pool_lv(pool_lv, 1))
+			return_0;
+	}
+
+	dm_list_iterate_items(olvl, origins) {
+		if (suffix) {
+			if ((dm_snprintf(name, sizeof(name), "%s_%s", olvl->lv->name, suffix) < 0) ||
+			    !validate_name(name) || !apply_lvname_restrictions(name)) {
+				log_error("Cannot use snapshot name %s_%s for %s.",
+					  olvl->lv->name, suffix, display_lvname(olvl->lv));
+				return 0;
+			}
+		}
+
+		if (!(lvl = dm_pool_alloc(cmd->mem, sizeof(*lvl))))
+			return_0;
+
+		/* Nothing is committed yet, VG is dropped on failure */
+		if (!(lvl->lv = _lv_create_thin_snapshot(vg, olvl->lv, suffix ? name : NULL, lp)))
+			return_0;
+
+		dm_list_add(&snapshots, &lvl->list);
+	}
+
+	/* Single commit for the whole set */
+	if (!vg_write(vg) || !vg_commit(vg))
+		return_0;
+
+	if (test_mode()) {
+		log_verbose("Test mode: Skipping activation.");
+		goto out;
+	}
+
+	/* Suspend all active origins, so nothing is written between the snapshots */
+	dm_list_iterate_items(olvl, origins) {
+		if (!lv_is_active(olvl->lv))
+			continue;
+		suspended++;
+		if (!suspend_lv_origin(cmd, olvl->lv)) {
+			log_error("Failed to suspend thin snapshot origin %s.",
+				  display_lvname(olvl->lv));
+			r = 0;
+			break;
+		}
+	}
+
+	/* The first resume of each pool delivers all its queued messages */
+	dm_list_iterate_items(olvl, origins) {
+		if (resumed == suspended)
+			break;
+		if (!lv_is_active(olvl->lv))
+			continue;
+		resumed++;
+		/* Note: always proceed with resume_lv() to leave critical_section */
+		if (!resume_lv_origin(cmd, olvl->lv)) { /* deptree updates thin-pool */
+			log_error("Failed to resume thin snapshot origin %s.",
+				  display_lvname(olvl->lv));
+			r = 0;
+		}
+	}
+
+	if (!r) {
+		stack;
+		goto revert;
+	}
+
+	dm_list_iterate_items(lvl, &snapshots) {
+		pool_lv = first_seg(lvl->lv)->pool_lv;
+		if (dm_list_empty(&first_seg(pool_lv)->thin_messages))
+			continue; /* Pool already handled */
+
+		delivered = 0;
+		dm_list_iterate_items(olvl, origins)
+			if ((first_seg(olvl->lv)->pool_lv == pool_lv) &&
+			    lv_is_active(olvl->lv))
+				delivered = 1;
+
+		if (delivered) {
+			/* Messages are in the kernel, drop them with a single commit below */
+			dm_list_init(&first_seg(pool_lv)->thin_messages);
+			need_commit = 1;
+		} else if (!update_thin_pool_lv(pool_lv, 1)) {
+			stack;
+			goto revert;
+		}
+	}
+
+	if (need_commit && (!vg_write(vg) || !vg_commit(vg))) {
+		stack;
+		goto revert;
+	}
+
+	dm_list_iterate_items(lvl, &snapshots) {
+		activate = lp->activate;
+		if (activate == CHANGE_AAY)
+			activate = lv_passes_auto_activation_filter(cmd, lvl->lv)
+				? CHANGE_ALY : CHANGE_ALN;
+
+		if (lv_activation_skip(lvl->lv, activate, lp->activation_skip & ACTIVATION_SKIP_IGNORE))
+			activate = CHANGE_AN;
+
+		if (!lv_active_change(cmd, lvl->lv, activate)) {
+			log_error("Failed to activate thin %s.", display_lvname(lvl->lv));
+			goto revert;
+		}
+	}
+
+	/* Restore inactive state of pools activated for the checks */
+	dm_list_iterate_items(lvl, &inactive_pools)
+		if (!deactivate_lv(cmd, lvl->lv)) {
+			log_error("Failed to deactivate thin pool %s.",
+				  display_lvname(lvl->lv));
+			r = 0;
+		}
+out:
+	dm_list_iterate_items(lvl, &snapshots)
+		log_print_unless_silent("Logical volume \"%s\" created.", lvl->lv->name);
+
+	return r;
+
+revert:
+	_remove_thin_snapshot_set(cmd, &snapshots);
+
+	return 0;
+}
@@ -528,6 +528,8 @@ struct lv_segment {
 	thin_discards_t discards;		/* For thin_pool */
 	thin_crop_metadata_t crop_metadata;	/* For thin_pool */
 	struct dm_list thin_messages;		/* For thin_pool */
+	dm_bitset_t thin_device_ids;		/* For thin_pool, used device_ids, built on demand */
+	uint32_t thin_device_id_hint;		/* For thin_pool, no free device_id below */
 	struct logical_volume *external_lv;	/* For thin */
 	struct logical_volume *pool_lv;		/* For thin, cache */
 	uint32_t device_id;			/* For thin, 24bit */
@@ -723,6 +725,8 @@ void pvcreate_params_set_defaults(struct pvcreate_params *pp);
 int vg_write(struct volume_group *vg);
 int vg_commit(struct volume_group *vg);
 void vg_revert(struct volume_group *vg);
+int vg_import_written(struct volume_group *vg);
+struct volume_group *vg_get_committed(struct volume_group *vg);
 
 /*
  * Add/remove LV to/from volume group
@@ -758,6 +762,9 @@ struct volume_group *vg_read(struct cmd_context *cmd, const char *vg_name, const
 struct volume_group *vg_read_for_update(struct cmd_context *cmd, const char *vg_name,
 			 const char *vgid, uint32_t vg_read_flags);
 struct volume_group *vg_read_orphans(struct cmd_context *cmd, const char *orphan_vgname);
+void vg_read_prefetch(struct cmd_context *cmd, struct dm_list *vgnameids,
+		      struct vgnameid_list *from, unsigned count, unsigned threads);
+void vg_read_prefetch_drop(void);
 
 /* pe_start and pe_end relate to any existing data so that new metadata
 * areas can avoid overlap */
@@ -1083,6 +1090,8 @@ struct lvcreate_params {
 
 struct logical_volume *lv_create_single(struct volume_group *vg,
 					struct lvcreate_params *lp);
+int lv_create_thin_snapshot_set(struct volume_group *vg, struct dm_list *origins,
+				const char *suffix, struct lvcreate_params *lp);
 
 /*
  * The activation can be skipped for selected LVs. Some LVs are skipped
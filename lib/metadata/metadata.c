@@ -36,6 +36,8 @@
 #include "lib/device/persist.h"
 #include "lib/notify/lvmnotify.h"
 #include "lib/datastruct/radix-tree.h"
+#include "lib/misc/lvm-perf.h"
+#include "libdaemon/client/config-util.h"
 
 #include <time.h>
 #include <math.h>
@@ -1007,6 +1009,8 @@ static void _vg_wipe_cached_precommitted(struct volume_group *vg)
 {
 	release_vg(vg->vg_precommitted);
 	vg->vg_precommitted = NULL;
+	free(vg->precommitted_buf);
+	vg->precommitted_buf = NULL;
 }
 
 static void _vg_move_cached_precommitted_to_committed(struct volume_group *vg)
@@ -1014,9 +1018,73 @@ static void _vg_move_cached_precommitted_to_committed(struct volume_group *vg)
 	release_vg(vg->vg_committed);
 	vg->vg_committed = vg->vg_precommitted;
 	vg->vg_precommitted = NULL;
+	free(vg->committed_buf);
+	vg->committed_buf = vg->precommitted_buf;
+	vg->precommitted_buf = NULL;
 	vg->needs_backup = 1;
 }
 
+/*
+ * Imports the metadata text kept by vg_write()/vg_commit() as a VG copy.
+ */
+static struct volume_group *_vg_import_copy(struct volume_group *vg, char **buf,
+					    struct volume_group **copy)
+{
+	struct dm_config_tree *cft;
+
+	if (!*buf)
+		return *copy;
+
+	log_debug_metadata("Importing copy of VG %s from written metadata.", vg->name);
+
+	if (!(cft = config_tree_from_string_without_dup_node_check(*buf))) {
+		log_error("Error parsing metadata for VG %s.", vg->name);
+		return NULL;
+	}
+
+	release_vg(*copy);
+	*copy = import_vg_from_config_tree(vg->cmd, vg->fid, cft);
+	dm_config_destroy(cft);
+
+	/* Text is kept on failure, so every later use fails the same way */
+	if (!*copy) {
+		log_error("Failed to import written metadata for VG %s.", vg->name);
+		return NULL;
+	}
+
+	free(*buf);
+	*buf = NULL;
+
+	return *copy;
+}
+
+/*
+ * Returns the committed copy of the VG, NULL when this VG
+ * is the committed version or the import failed.
+ */
+struct volume_group *vg_get_committed(struct volume_group *vg)
+{
+	return _vg_import_copy(vg, &vg->committed_buf, &vg->vg_committed);
+}
+
+/*
+ * Import the metadata written by vg_write() and vg_commit() now, so
+ * neither the VG used by suspend nor the committed VG used by a later
+ * resume is parsed while devices are suspended and memory is locked.
+ */
+int vg_import_written(struct volume_group *vg)
+{
+	if (vg->precommitted_buf &&
+	    !_vg_import_copy(vg, &vg->precommitted_buf, &vg->vg_precommitted))
+		return_0;
+
+	if (vg->committed_buf &&
+	    !_vg_import_copy(vg, &vg->committed_buf, &vg->vg_committed))
+		return_0;
+
+	return 1;
+}
+
 int lv_has_unknown_segments(const struct logical_volume *lv)
 {
 	struct lv_segment *seg;
@@ -2977,7 +3045,7 @@ int vg_write(struct volume_group *vg)
 	if (vg->cmd->wipe_outdated_pvs)
 		_wipe_outdated_pvs(vg->cmd, vg);
 
-	if (!vg_is_archived(vg) && vg->vg_committed && !archive(vg->vg_committed))
+	if (!vg_is_archived(vg) && vg_get_committed(vg) && !archive(vg->vg_committed))
 		return_0;
 
 	if (critical_section())
@@ -4302,10 +4370,14 @@ const struct logical_volume *lv_committed(const struct logical_volume *lv)
 	if (!lv)
 		return NULL;
 
-	if (!lv->vg->vg_committed)
-		return lv;
-
-	vg = lv->vg->vg_committed;
+	if (!(vg = vg_get_committed(lv->vg))) {
+		if (lv->vg->committed_buf) {
+			log_error("Cannot use committed metadata of %s.",
+				  display_lvname(lv));
+			return NULL;
+		}
+		return lv; /* This VG is the committed one */
+	}
 
 	if (!vg->lv_uuids &&
 	    (vg->lv_uuids = radix_tree_create(NULL, NULL)))
@@ -4894,6 +4966,56 @@ out:
 	return vg_ret;
 }
 
+/*
+ * Parse the metadata of up to count VGs from the list, starting with
+ * 'from', on worker threads ahead of reading them with vg_read().
+ * Only the first mda1 of each VG found by label scan is used.
+ */
+void vg_read_prefetch(struct cmd_context *cmd, struct dm_list *vgnameids,
+		      struct vgnameid_list *from, unsigned count, unsigned threads)
+{
+	DM_LIST_INIT(vg_mdas);
+	DM_LIST_INIT(mdas);
+	struct vgnameid_list *vgnl;
+	struct mda_list *mdal, *safe;
+	struct dm_list *l;
+	int found;
+
+	for (l = &from->list; count && (l != vgnameids); count--, l = l->n) {
+		vgnl = dm_list_item(l, struct vgnameid_list);
+
+		if (is_orphan_vg(vgnl->vg_name) ||
+		    !lvmcache_vginfo_from_vgname(vgnl->vg_name, vgnl->vgid))
+			continue;
+
+		lvmcache_get_mdas(cmd, vgnl->vg_name, vgnl->vgid, &vg_mdas);
+
+		found = 0;
+		dm_list_iterate_items_safe(mdal, safe, &vg_mdas) {
+			dm_list_del(&mdal->list);
+			if (!found && (mdal->mda->mda_num == 1) && mdal->mda->scan_text_offset &&
+			    !mda_is_ignored(mdal->mda)) {
+				dm_list_add(&mdas, &mdal->list);
+				found = 1;
+			} else
+				free(mdal);
+		}
+	}
+
+	if (!dm_list_empty(&mdas) && !text_metadata_prefetch(cmd->fmt, &mdas, threads))
+		stack;
+
+	dm_list_iterate_items_safe(mdal, safe, &mdas) {
+		dm_list_del(&mdal->list);
+		free(mdal);
+	}
+}
+
+void vg_read_prefetch_drop(void)
+{
+	text_metadata_prefetch_drop();
+}
+
 struct volume_group *vg_read(struct cmd_context *cmd, const char *vg_name, const char *vgid,
 			     uint32_t vg_read_flags, struct lockd_state *lks,
 			     uint32_t *error_flags, struct volume_group **error_vg)
@@ -4995,7 +5117,11 @@ struct volume_group *vg_read(struct cmd_context *cmd, const char *vg_name, const
 	if (activating && original_vgid_set && is_duplicate_vgname)
 		log_warn("WARNING: Activating multiple VGs with the same name is dangerous and may fail.");
 
-	if (!(vg = _vg_read(cmd, vg_name, vgid, 0, writing, &incorrect_pv_claim))) {
+	perf_phase_start(PERF_PHASE_VG_READ);
+	vg = _vg_read(cmd, vg_name, vgid, 0, writing, &incorrect_pv_claim);
+	perf_phase_end(PERF_PHASE_VG_READ);
+
+	if (!vg) {
 		unlock_vg(cmd, NULL, vg_name);
 		/* Some callers don't care if the VG doesn't exist and don't want an error message. */
 		if (!(vg_read_flags & READ_OK_NOTFOUND))
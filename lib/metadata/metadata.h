@@ -412,6 +412,7 @@ struct lv_segment *find_pool_seg(const struct lv_segment *seg);
 
 /* Find some unused device_id for thin pool LV segment. */
 uint32_t get_free_thin_pool_device_id(struct lv_segment *thin_pool_seg);
+int thin_pool_device_id_add(struct lv_segment *pool_seg, uint32_t device_id);
 
 /* Check if the new thin-pool could be used for lvm2 thin volumes */
 int check_new_thin_pool(struct logical_volume *pool_lv);
@@ -520,6 +521,10 @@ int thin_pool_has_message(const struct lv_segment *seg,
 			  const struct logical_volume *lv, uint32_t device_id);
 int thin_pool_metadata_min_threshold(const struct lv_segment *pool_seg);
 int thin_pool_below_threshold(const struct lv_segment *pool_seg);
+int thin_pool_read_forecast(const char *path, int64_t *data_seconds,
+			    int64_t *metadata_seconds);
+int thin_pool_time_to_full(const struct logical_volume *lv, int64_t *data_seconds,
+			   int64_t *metadata_seconds);
 int thin_pool_check_overprovisioning(const struct logical_volume *lv);
 uint64_t get_thin_pool_max_metadata_size(struct cmd_context *cmd, struct profile *profile,
 					 thin_crop_metadata_t *crop);
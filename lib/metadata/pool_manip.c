@@ -109,6 +109,10 @@ int attach_pool_lv(struct lv_segment *seg,
 	seg->origin = origin;
 	seg->lv->status |= seg_is_cache(seg) ? CACHE : THIN_VOLUME;
 
+	if (seg_is_thin_volume(seg) &&
+	    !thin_pool_device_id_add(first_seg(pool_lv), seg->device_id))
+		return_0;
+
 	if (seg_is_cache(seg)) {
 		lv_set_hidden(pool_lv); /* Used cache-pool/cachevol is hidden */
 
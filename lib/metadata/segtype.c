@@ -22,6 +22,9 @@ struct segment_type *get_segtype_from_string(struct cmd_context *cmd,
 {
 	struct segment_type *segtype;
 
+	if (!init_segtypes(cmd))
+		return_NULL;
+
 	dm_list_iterate_items(segtype, &cmd->segtypes)
 		if (!strcmp(segtype->name, str))
 			return segtype;
@@ -39,6 +42,9 @@ struct segment_type *get_segtype_from_flag(struct cmd_context *cmd, uint64_t fla
 {
 	struct segment_type *segtype;
 
+	if (!init_segtypes(cmd))
+		return_NULL;
+
 	/* Iterate backwards to provide aliases; e.g. raid5 instead of raid5_ls */
 	dm_list_iterate_back_items(segtype, &cmd->segtypes)
 		if (flag & segtype->flags)
@@ -253,6 +253,71 @@ int thin_pool_metadata_min_threshold(const struct lv_segment *pool_seg)
 	return DM_PERCENT_100 - meta_free;
 }
 
+/*
+ * The dmeventd thin plugin writes its prediction for a monitored pool to
+ * THIN_FORECAST_DIR/<dm uuid> as "<time> <data seconds> <metadata seconds>"
+ * where -1 means the usage is not growing.  Ignore old predictions, e.g.
+ * from a pool that is no longer monitored.
+ */
+#define THIN_FORECAST_MAX_AGE 120
+
+int thin_pool_read_forecast(const char *path, int64_t *data_seconds,
+			    int64_t *metadata_seconds)
+{
+	long long stamp, data, metadata;
+	FILE *fp;
+	int64_t age;
+	int r = 0;
+
+	*data_seconds = *metadata_seconds = -1;
+
+	if (!(fp = fopen(path, "r")))
+		return 0;
+
+	if (fscanf(fp, "%lld %lld %lld", &stamp, &data, &metadata) == 3) {
+		age = (int64_t) time(NULL) - stamp;
+		if ((age >= 0) && (age <= THIN_FORECAST_MAX_AGE)) {
+			if (data >= 0)
+				*data_seconds = (data > age) ? data - age : 0;
+			if (metadata >= 0)
+				*metadata_seconds = (metadata > age) ? metadata - age : 0;
+			r = 1;
+		} else
+			log_debug("Ignoring old thin pool forecast %s.", path);
+	}
+
+	if (fclose(fp))
+		log_sys_debug("fclose", path);
+
+	return r;
+}
+
+int thin_pool_time_to_full(const struct logical_volume *lv, int64_t *data_seconds,
+			   int64_t *metadata_seconds)
+{
+	struct dm_pool *mem = lv->vg->cmd->mem;
+	char path[PATH_MAX];
+	char *dlid;
+	int r = 0;
+
+	*data_seconds = *metadata_seconds = -1;
+
+	if (!lv_is_thin_pool(lv))
+		return 0;
+
+	if (!(dlid = build_dm_uuid(mem, lv, lv_layer(lv))))
+		return_0;
+
+	if (dm_snprintf(path, sizeof(path), "%s/%s", THIN_FORECAST_DIR, dlid) < 0)
+		goto_out;
+
+	r = thin_pool_read_forecast(path, data_seconds, metadata_seconds);
+out:
+	dm_pool_free(mem, dlid);
+
+	return r;
+}
+
 int thin_pool_below_threshold(const struct lv_segment *pool_seg)
 {
 	struct cmd_context *cmd = pool_seg->lv->vg->cmd;
@@ -558,19 +623,91 @@ struct logical_volume *find_pool_lv(const struct logical_volume *lv)
 	return seg->lv;
 }
 
+/*
+ * Mark device_id as used in the pool bitset, growing the bitset
+ * (twice the needed size) when device_id is beyond its end.
+ */
+static int _thin_pool_device_id_set(struct lv_segment *pool_seg, uint32_t device_id)
+{
+	dm_bitset_t bs = pool_seg->thin_device_ids;
+	unsigned size;
+
+	if (!bs || (device_id >= *bs)) {
+		size = (device_id + 1) * 2;
+		if (size < 1024)
+			size = 1024;
+		if (size > DM_THIN_MAX_DEVICE_ID + 1)
+			size = DM_THIN_MAX_DEVICE_ID + 1;
+
+		if (!(bs = dm_bitset_create(pool_seg->lv->vg->vgmem, size))) {
+			log_error("Failed to allocate thin device_id bitset.");
+			return 0;
+		}
+
+		if (pool_seg->thin_device_ids)
+			memcpy(bs + 1, pool_seg->thin_device_ids + 1,
+			       ((*pool_seg->thin_device_ids / DM_BITS_PER_INT) + 1) * sizeof(int));
+
+		/* Old bitset stays in vgmem until VG is released */
+		pool_seg->thin_device_ids = bs;
+	}
+
+	dm_bit_set(bs, device_id);
+
+	return 1;
+}
+
+/* Build the bitset of used device_ids with a single walk over pool users */
+static int _thin_pool_device_ids_build(struct lv_segment *pool_seg)
+{
+	const struct lv_thin_message *tmsg;
+	const struct seg_list *sl;
+
+	/* Device_id 0 is never used */
+	if (!_thin_pool_device_id_set(pool_seg, 0))
+		return_0;
+
+	dm_list_iterate_items(sl, &pool_seg->lv->segs_using_this_lv)
+		if (!_thin_pool_device_id_set(pool_seg, sl->seg->device_id))
+			return_0;
+
+	/* Do not reuse device_id before its delete message was sent */
+	dm_list_iterate_items(tmsg, &pool_seg->thin_messages)
+		if ((tmsg->type == DM_THIN_MESSAGE_DELETE) &&
+		    !_thin_pool_device_id_set(pool_seg, tmsg->u.delete_id))
+			return_0;
+
+	pool_seg->thin_device_id_hint = 1;
+
+	return 1;
+}
+
+/*
+ * Remember device_id of a thin LV attached to the pool after
+ * the bitset has been built.
+ */
+int thin_pool_device_id_add(struct lv_segment *pool_seg, uint32_t device_id)
+{
+	if (!pool_seg || !pool_seg->thin_device_ids || !device_id)
+		return 1;
+
+	return _thin_pool_device_id_set(pool_seg, device_id);
+}
+
 /*
  * Find a free device_id for given thin_pool segment.
  *
+ * The lowest unused device_id is returned and marked as used.
+ * Holes left by removed thin LVs are reused and fully used words
+ * of the bitset are skipped, so allocation is O(1) amortised.
+ *
  * \return
  * Free device id, or 0 if free device_id is not found.
- *
- * FIXME: Improve naive search and keep the value cached
- * and updated during VG lifetime (so no const for lv_segment)
  */
 uint32_t get_free_thin_pool_device_id(struct lv_segment *thin_pool_seg)
 {
-	uint32_t max_id = 0;
-	struct seg_list *sl;
+	dm_bitset_t bs;
+	uint32_t id;
 
 	if (!seg_is_thin_pool(thin_pool_seg)) {
 		log_error(INTERNAL_ERROR
@@ -579,19 +716,34 @@ uint32_t get_free_thin_pool_device_id(struct lv_segment *thin_pool_seg)
 		return 0;
 	}
 
-	dm_list_iterate_items(sl, &thin_pool_seg->lv->segs_using_this_lv)
-		if (sl->seg->device_id > max_id)
-			max_id = sl->seg->device_id;
+	if (!thin_pool_seg->thin_device_ids &&
+	    !_thin_pool_device_ids_build(thin_pool_seg))
+		return_0;
 
-	if (++max_id > DM_THIN_MAX_DEVICE_ID) {
-		/* FIXME Find empty holes instead of aborting! */
+	bs = thin_pool_seg->thin_device_ids;
+	for (id = thin_pool_seg->thin_device_id_hint; id < *bs; ++id) {
+		if (!(id & (DM_BITS_PER_INT - 1)) &&
+		    (bs[(id / DM_BITS_PER_INT) + 1] == ~0U)) {
+			id += DM_BITS_PER_INT - 1; /* Skip fully used word */
+			continue;
+		}
+		if (!dm_bit(bs, id))
+			break;
+	}
+
+	if (id > DM_THIN_MAX_DEVICE_ID) {
 		log_error("Cannot find free device_id.");
 		return 0;
 	}
 
-	log_debug_metadata("Found free pool device_id %u.", max_id);
+	if (!_thin_pool_device_id_set(thin_pool_seg, id))
+		return_0;
+
+	thin_pool_seg->thin_device_id_hint = id + 1;
+
+	log_debug_metadata("Found free pool device_id %u.", id);
 
-	return max_id;
+	return id;
 }
 
 static int _check_pool_create(const struct logical_volume *lv)
@@ -80,6 +80,9 @@ static void _free_vg(struct volume_group *vg)
 	if (vg->committed_cft)
 		config_destroy(vg->committed_cft);
 
+	free(vg->precommitted_buf);
+	free(vg->committed_buf);
+
 	if (vg->lv_names)
 		radix_tree_destroy(vg->lv_names);
 
@@ -797,5 +800,5 @@ void vg_backup_if_needed(struct volume_group *vg)
 		return;
 
 	vg->needs_backup = 0;
-	backup(vg->vg_committed);
+	backup_committed(vg);
 }
@@ -64,6 +64,15 @@ struct volume_group {
 	struct volume_group *vg_committed;
 	struct volume_group *vg_precommitted;
 
+	/*
+	 * Metadata text written by vg_write() and not yet imported as
+	 * vg_precommitted, or committed by vg_commit() and not yet imported
+	 * as vg_committed.  The copies are imported when first needed, so
+	 * vg_committed must be read through vg_get_committed().
+	 */
+	char *precommitted_buf;
+	char *committed_buf;
+
 	alloc_policy_t alloc;
 	struct profile *profile;
 	uint64_t status;
@@ -71,6 +80,8 @@ struct volume_group {
 	struct radix_tree *lv_names;    /* maintained tree for LV names within VG */
 	struct radix_tree *lv_uuids;    /* LV uuid (when searching committed metadata) */
 	struct radix_tree *pv_names;    /* PV names used for metadata import */
+	char *seg_arena;		/* Block reserved by metadata import for */
+	char *seg_arena_end;		/* the segments of one LV */
 
 	struct id id;
 	const char *name;
@@ -22,6 +22,7 @@
 #include "lib/format_text/text_import.h"
 #include "lib/config/config.h"
 #include "lib/misc/lvm-string.h"
+#include "lib/metadata/metadata.h"
 #include "lib/activate/targets.h"
 #include "lib/activate/activate.h"
 #include "lib/datastruct/str_list.h"
@@ -36,6 +37,11 @@ enum {
 
 struct mirror_state {
 	uint32_t default_region_size;
+	uint32_t pvmove_parallel_segments;
+	/* pvmove segments chosen to be mirrored at once */
+	const struct logical_volume *pvmove_lv;
+	const struct lv_segment *pvmove_running[DEFAULT_PVMOVE_PARALLEL_SEGMENTS_MAX];
+	uint32_t pvmove_running_count;
 };
 
 static void _mirrored_display(const struct lv_segment *seg)
@@ -156,10 +162,96 @@ static struct mirror_state *_mirrored_init_target(struct dm_pool *mem,
 	}
 
 	mirr_state->default_region_size = get_default_region_size(cmd);
+	mirr_state->pvmove_parallel_segments =
+		find_config_tree_int(cmd, allocation_pvmove_parallel_segments_CFG, NULL);
+	if (mirr_state->pvmove_parallel_segments > DEFAULT_PVMOVE_PARALLEL_SEGMENTS_MAX)
+		mirr_state->pvmove_parallel_segments = DEFAULT_PVMOVE_PARALLEL_SEGMENTS_MAX;
+	mirr_state->pvmove_lv = NULL;
+	mirr_state->pvmove_running_count = 0;
 
 	return mirr_state;
 }
 
+/* PV written by the destination leg of a pvmove segment, if known */
+static const struct physical_volume *_pvmove_seg_dest_pv(const struct lv_segment *seg)
+{
+	const struct lv_segment *dseg;
+
+	if (seg->area_count < 2)
+		return NULL;
+
+	if (seg_type(seg, 1) == AREA_PV)
+		return seg_pv(seg, 1);
+
+	if ((seg_type(seg, 1) == AREA_LV) &&
+	    (dseg = find_seg_by_le(seg_lv(seg, 1), seg_le(seg, 1))) &&
+	    (seg_type(dseg, 0) == AREA_PV))
+		return seg_pv(dseg, 0);
+
+	return NULL;
+}
+
+static int _pvmove_seg_is_chosen(const struct mirror_state *mirr_state,
+				 const struct lv_segment *seg)
+{
+	uint32_t i;
+
+	for (i = 0; i < mirr_state->pvmove_running_count; i++)
+		if (mirr_state->pvmove_running[i] == seg)
+			return 1;
+
+	return 0;
+}
+
+/*
+ * Choose up to pvmove_parallel_segments unfinished segments of a pvmove
+ * LV to be mirrored at once.  Segments writing to a destination PV not
+ * used by an already chosen segment are preferred, so the copy streams
+ * are spread over the destination PVs.  Remaining slots are filled in
+ * LV order.
+ */
+static void _pvmove_schedule_segments(struct mirror_state *mirr_state,
+				      const struct logical_volume *lv)
+{
+	const struct physical_volume *dest[DEFAULT_PVMOVE_PARALLEL_SEGMENTS_MAX];
+	const struct physical_volume *pv;
+	const struct lv_segment *seg;
+	uint32_t max = mirr_state->pvmove_parallel_segments;
+	uint32_t count = 0, i;
+
+	mirr_state->pvmove_lv = lv;
+	mirr_state->pvmove_running_count = 0;
+
+	dm_list_iterate_items(seg, &lv->segments) {
+		if (count == max)
+			break;
+		if (!(seg->status & PVMOVE) || (seg->extents_copied == seg->area_len))
+			continue;
+		if ((pv = _pvmove_seg_dest_pv(seg)))
+			for (i = 0; i < count; i++)
+				if (dest[i] == pv)
+					break;
+		if (pv && (i < count))
+			continue;
+		dest[count] = pv;
+		mirr_state->pvmove_running[count++] = seg;
+		mirr_state->pvmove_running_count = count;
+	}
+
+	dm_list_iterate_items(seg, &lv->segments) {
+		if (count == max)
+			break;
+		if (!(seg->status & PVMOVE) || (seg->extents_copied == seg->area_len) ||
+		    _pvmove_seg_is_chosen(mirr_state, seg))
+			continue;
+		mirr_state->pvmove_running[count++] = seg;
+		mirr_state->pvmove_running_count = count;
+	}
+
+	log_debug_activation("Mirroring %u segments of %s at once.",
+			     count, display_lvname(lv));
+}
+
 static int _mirrored_target_percent(void **target_state,
 				    dm_percent_t *percent,
 				    struct dm_pool *mem,
@@ -339,14 +431,22 @@ static int _mirrored_add_target_line(struct dev_manager *dm, struct dm_pool *mem
 		mirror_status = MIRR_DISABLED;
 
 	/*
-	 * For pvmove, only have one mirror segment RUNNING at once.
-	 * Segments before this are COMPLETED and use 2nd area.
-	 * Segments after this are DISABLED and use 1st area.
+	 * For pvmove, only have one mirror segment RUNNING at once,
+	 * or up to pvmove_parallel_segments chosen by the scheduler.
+	 * Completed segments are COMPLETED and use 2nd area.
+	 * Other segments are DISABLED and use 1st area.
 	 */
 	if (seg->status & PVMOVE) {
 		if (seg->extents_copied == seg->area_len) {
 			mirror_status = MIRR_COMPLETED;
 			start_area = 1;
+		} else if (mirr_state->pvmove_parallel_segments > 1) {
+			if (mirr_state->pvmove_lv != seg->lv)
+				_pvmove_schedule_segments(mirr_state, seg->lv);
+			if (!_pvmove_seg_is_chosen(mirr_state, seg)) {
+				mirror_status = MIRR_DISABLED;
+				area_count = 1;
+			}
 		} else if ((*pvmove_mirror_count)++) {
 			mirror_status = MIRR_DISABLED;
 			area_count = 1;
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "lib/misc/lib.h"
+#include "lib/misc/lvm-perf.h"
+
+#include <time.h>
+
+struct perf_phase {
+	const char *name;
+	uint64_t start_ns;
+	uint64_t total_ns;
+	unsigned calls;
+	unsigned depth;
+};
+
+static struct perf_phase _phases[PERF_PHASE_COUNT] = {
+	[PERF_PHASE_CONFIG] = { .name = "config" },
+	[PERF_PHASE_DEV_TYPES] = { .name = "device_types" },
+	[PERF_PHASE_DEV_CACHE_INIT] = { .name = "device_cache_init" },
+	[PERF_PHASE_FORMATS] = { .name = "formats" },
+	[PERF_PHASE_CONNECTIONS] = { .name = "connections" },
+	[PERF_PHASE_FILTERS] = { .name = "filters" },
+	[PERF_PHASE_SEGTYPES] = { .name = "segtypes" },
+	[PERF_PHASE_DEV_CACHE_SCAN] = { .name = "dev_cache_scan" },
+	[PERF_PHASE_LABEL_SCAN] = { .name = "label_scan" },
+	[PERF_PHASE_VG_READ] = { .name = "vg_read" },
+	[PERF_PHASE_ACTIVATION] = { .name = "activation" },
+	[PERF_PHASE_UDEV_WAIT] = { .name = "udev_wait" },
+};
+
+static const struct {
+	const char *name;
+	const char *unit;
+} _counter_names[PERF_COUNTER_COUNT] = {
+	[PERF_COUNTER_IOCTLS] = { "ioctls", "count" },
+	[PERF_COUNTER_BCACHE_READ_BYTES] = { "bcache_read", "bytes" },
+	[PERF_COUNTER_DEV_OPENS] = { "device_opens", "count" },
+};
+
+static uint64_t _counters[PERF_COUNTER_COUNT];
+
+/* Ioctls are counted by libdm, remember its value at the last reset. */
+static uint64_t _ioctl_count_base;
+
+uint64_t perf_clock_ns(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts))
+		return 0;
+
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void perf_phase_start(perf_phase_t phase)
+{
+	struct perf_phase *p = &_phases[phase];
+
+	if (!p->depth++)
+		p->start_ns = perf_clock_ns();
+}
+
+void perf_phase_end(perf_phase_t phase)
+{
+	struct perf_phase *p = &_phases[phase];
+
+	if (!p->depth) {
+		log_debug(INTERNAL_ERROR "Unbalanced end of %s perf phase.", p->name);
+		return;
+	}
+
+	if (--p->depth)
+		return;
+
+	p->total_ns += perf_clock_ns() - p->start_ns;
+	p->calls++;
+}
+
+void perf_count(perf_counter_t counter, uint64_t value)
+{
+	_counters[counter] += value;
+}
+
+const char *perf_phase_name(perf_phase_t phase)
+{
+	return _phases[phase].name;
+}
+
+unsigned perf_phase_calls(perf_phase_t phase)
+{
+	return _phases[phase].calls;
+}
+
+uint64_t perf_phase_usec(perf_phase_t phase)
+{
+	return _phases[phase].total_ns / 1000;
+}
+
+const char *perf_counter_name(perf_counter_t counter)
+{
+	return _counter_names[counter].name;
+}
+
+const char *perf_counter_unit(perf_counter_t counter)
+{
+	return _counter_names[counter].unit;
+}
+
+uint64_t perf_counter_value(perf_counter_t counter)
+{
+	if (counter == PERF_COUNTER_IOCTLS)
+		return dm_lib_ioctl_count() - _ioctl_count_base;
+
+	return _counters[counter];
+}
+
+void perf_reset(void)
+{
+	unsigned i;
+
+	for (i = 0; i < PERF_PHASE_COUNT; i++) {
+		_phases[i].total_ns = 0;
+		_phases[i].calls = 0;
+		_phases[i].depth = 0;
+	}
+
+	memset(_counters, 0, sizeof(_counters));
+	_ioctl_count_base = dm_lib_ioctl_count();
+}
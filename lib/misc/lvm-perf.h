@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _LVM_PERF_H
+#define _LVM_PERF_H
+
+/*
+ * Per-command performance accounting.
+ *
+ * Phases accumulate monotonic time spent between perf_phase_start()
+ * and perf_phase_end().  Nested or recursive entries into the same
+ * phase are only timed once.  Counters are plain accumulators.
+ * Values are reported by the command perf report
+ * (log/report_command_perf) and reset with perf_reset().
+ */
+
+typedef enum {
+	PERF_PHASE_CONFIG,
+	PERF_PHASE_DEV_TYPES,
+	PERF_PHASE_DEV_CACHE_INIT,
+	PERF_PHASE_FORMATS,
+	PERF_PHASE_CONNECTIONS,
+	PERF_PHASE_FILTERS,
+	PERF_PHASE_SEGTYPES,
+	PERF_PHASE_DEV_CACHE_SCAN,
+	PERF_PHASE_LABEL_SCAN,
+	PERF_PHASE_VG_READ,
+	PERF_PHASE_ACTIVATION,
+	PERF_PHASE_UDEV_WAIT,
+	PERF_PHASE_COUNT
+} perf_phase_t;
+
+typedef enum {
+	PERF_COUNTER_IOCTLS,
+	PERF_COUNTER_BCACHE_READ_BYTES,
+	PERF_COUNTER_DEV_OPENS,
+	PERF_COUNTER_COUNT
+} perf_counter_t;
+
+uint64_t perf_clock_ns(void);
+
+void perf_phase_start(perf_phase_t phase);
+void perf_phase_end(perf_phase_t phase);
+
+void perf_count(perf_counter_t counter, uint64_t value);
+
+const char *perf_phase_name(perf_phase_t phase);
+unsigned perf_phase_calls(perf_phase_t phase);
+uint64_t perf_phase_usec(perf_phase_t phase);
+
+const char *perf_counter_name(perf_counter_t counter);
+const char *perf_counter_unit(perf_counter_t counter);
+uint64_t perf_counter_value(perf_counter_t counter);
+
+void perf_reset(void);
+
+#endif
@@ -46,6 +46,89 @@ int emit_to_buffer(char **buffer, size_t *size, const char *fmt, ...)
 	return 1;
 }
 
+/*
+ * Hand-rolled vsnprintf() for hot paths such as the metadata export.
+ * Only plain "%s", "%d", "%i", "%u" (optionally with 'l' or 'll')
+ * and "%%" are handled.
+ */
+int vsnprintf_simple(char *buf, size_t size, const char *fmt, va_list ap)
+{
+	char num[24], *const num_end = num + sizeof(num), *d;
+	const char *s, *lit;
+	size_t len, used = 0;
+	unsigned long long u;
+	long long i;
+	unsigned lng;
+	int neg;
+
+	while (*fmt) {
+		if (*fmt != '%') {
+			for (lit = fmt; *fmt && *fmt != '%'; fmt++)
+				;
+			s = lit;
+			len = fmt - lit;
+		} else {
+			for (lng = 0; *++fmt == 'l'; lng++)
+				;
+			if (lng > 2)
+				return -2;
+
+			switch (*fmt) {
+			case '%':
+				if (lng)
+					return -2;
+				s = "%";
+				len = 1;
+				break;
+			case 's':
+				if (lng || !(s = va_arg(ap, const char *)))
+					return -2;
+				len = strlen(s);
+				break;
+			case 'd':
+			case 'i':
+				i = (lng == 2) ? va_arg(ap, long long) :
+				    (lng == 1) ? va_arg(ap, long) : va_arg(ap, int);
+				if ((neg = (i < 0)))
+					u = -(unsigned long long) i;
+				else
+					u = (unsigned long long) i;
+				goto number;
+			case 'u':
+				u = (lng == 2) ? va_arg(ap, unsigned long long) :
+				    (lng == 1) ? va_arg(ap, unsigned long) : va_arg(ap, unsigned);
+				neg = 0;
+			number:
+				d = num_end;
+				do
+					*--d = '0' + (char) (u % 10);
+				while (u /= 10);
+				if (neg)
+					*--d = '-';
+				s = d;
+				len = num_end - d;
+				break;
+			default:
+				return -2;
+			}
+			fmt++;
+		}
+
+		if (used + len >= size)
+			return -1;
+
+		memcpy(buf + used, s, len);
+		used += len;
+	}
+
+	if (used >= size)
+		return -1;
+
+	buf[used] = '\0';
+
+	return (int) used;
+}
+
 /*
  * A-Za-z0-9._-+/=!:&#
  */
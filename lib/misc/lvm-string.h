@@ -20,6 +20,7 @@
 #define UUID_PREFIX "LVM-"
 
 #include <sys/types.h>
+#include <stdarg.h>
 
 struct dm_pool;
 struct logical_volume;
@@ -36,6 +37,13 @@ typedef enum name_error {
 int emit_to_buffer(char **buffer, size_t *size, const char *fmt, ...)
   __attribute__ ((format(printf, 3, 4)));
 
+/*
+ * Returns the number of characters written, -1 if they do not fit
+ * or -2 if fmt needs other conversions and vsnprintf() must be used.
+ */
+int vsnprintf_simple(char *buf, size_t size, const char *fmt, va_list ap)
+  __attribute__ ((format(printf, 3, 0)));
+
 char *build_dm_uuid(struct dm_pool *mem, const struct logical_volume *lv,
 		    const char *layer);
 
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This file defines the fields (columns) for the command performance reporting.
+ *
+ * The preferred order of the field descriptions in the help text
+ * determines the order the entries appear in this file.
+ *
+ * When adding new entries take care to use the existing style.
+ * Displayed fields names normally have a type prefix and use underscores.
+ * Field-specific internal functions names normally match the displayed
+ * field names but without underscores.
+ * Help text ends with a full stop.
+ */
+
+/* *INDENT-OFF* */
+FIELD(CMDPERF, cmd_perf_item, STR, "Type", type, 5, string, perf_type, "Item type, phase or counter.", 0)
+FIELD(CMDPERF, cmd_perf_item, STR, "Name", name, 14, string, perf_name, "Phase or counter name.", 0)
+FIELD(CMDPERF, cmd_perf_item, NUM, "Value", value, 8, uint64, perf_value, "Time spent in phase or counter value.", 0)
+FIELD(CMDPERF, cmd_perf_item, STR, "Unit", unit, 5, string, perf_unit, "Unit of the value.", 0)
+FIELD(CMDPERF, cmd_perf_item, NUM, "Calls", calls, 5, uint32, perf_calls, "Number of times the phase was entered.", 0)
+/* *INDENT-ON* */
@@ -338,6 +338,11 @@ GET_PV_STR_PROPERTY_FN(pv_device_id_type, pv->device_id_type)
 #define _lv_historical_set prop_not_implemented_set
 #define _lv_historical_get prop_not_implemented_get
 
+#define _data_time_to_full_set prop_not_implemented_set
+#define _data_time_to_full_get prop_not_implemented_get
+#define _metadata_time_to_full_set prop_not_implemented_set
+#define _metadata_time_to_full_get prop_not_implemented_get
+
 #define _cache_total_blocks_set prop_not_implemented_set
 #define _cache_total_blocks_get prop_not_implemented_get
 #define _cache_used_blocks_set prop_not_implemented_set
@@ -27,6 +27,7 @@
 #include "lib/device/persist.h"
 #include "lib/datastruct/str_list.h"
 #include "lib/locking/lvmlockd.h"
+#include "lib/misc/lvm-perf.h"
 
 #include <stddef.h> /* offsetof() */
 #include <float.h> /* DBL_MAX */
@@ -2412,6 +2413,13 @@ static int _uint32_disp(struct dm_report *rh, struct dm_pool *mem __attribute__(
 	return dm_report_field_uint32(rh, field, data);
 }
 
+static int _uint64_disp(struct dm_report *rh, struct dm_pool *mem __attribute__((unused)),
+			struct dm_report_field *field,
+			const void *data, void *private __attribute__((unused)))
+{
+	return dm_report_field_uint64(rh, field, data);
+}
+
 static int _uint8_disp(struct dm_report *rh, struct dm_pool *mem __attribute__((unused)),
 		       struct dm_report_field *field,
 		       const void *data, void *private __attribute__((unused)))
@@ -3520,6 +3528,38 @@ static int _metadatapercent_disp(struct dm_report *rh,
 	return dm_report_field_percent(rh, field, &percent);
 }
 
+static int _time_to_full_disp(struct dm_report *rh, struct dm_report_field *field,
+			      const struct lv_with_info_and_seg_status *lvdm, int metadata)
+{
+	int64_t data_seconds, metadata_seconds;
+	uint64_t seconds;
+
+	if ((lvdm->seg_status.type != SEG_STATUS_THIN_POOL) ||
+	    !thin_pool_time_to_full(lvdm->lv, &data_seconds, &metadata_seconds) ||
+	    ((metadata ? metadata_seconds : data_seconds) < 0))
+		return _field_set_value(field, "", &GET_TYPE_RESERVED_VALUE(num_undef_64));
+
+	seconds = (uint64_t) (metadata ? metadata_seconds : data_seconds);
+
+	return dm_report_field_uint64(rh, field, &seconds);
+}
+
+static int _datatimetofull_disp(struct dm_report *rh,
+				struct dm_pool *mem __attribute__((unused)),
+				struct dm_report_field *field,
+				const void *data, void *private __attribute__((unused)))
+{
+	return _time_to_full_disp(rh, field, (const struct lv_with_info_and_seg_status *) data, 0);
+}
+
+static int _metadatatimetofull_disp(struct dm_report *rh,
+				    struct dm_pool *mem __attribute__((unused)),
+				    struct dm_report_field *field,
+				    const void *data, void *private __attribute__((unused)))
+{
+	return _time_to_full_disp(rh, field, (const struct lv_with_info_and_seg_status *) data, 1);
+}
+
 static int _lvmetadatasize_disp(struct dm_report *rh, struct dm_pool *mem,
 				struct dm_report_field *field,
 				const void *data, void *private)
@@ -4454,11 +4494,21 @@ static void *_obj_get_cmdlog(void *obj)
 	return obj;
 }
 
+static void *_obj_get_cmdperf(void *obj)
+{
+	return obj;
+}
+
 static const struct dm_report_object_type _log_report_types[] = {
 	{ CMDLOG, "Command Log", "log_", _obj_get_cmdlog },
 	{ 0, "", "", NULL },
 };
 
+static const struct dm_report_object_type _perf_report_types[] = {
+	{ CMDPERF, "Command Performance", "perf_", _obj_get_cmdperf },
+	{ 0, "", "", NULL },
+};
+
 static const struct dm_report_object_type _report_types[] = {
 	{ VGS, "Volume Group", "vg_", _obj_get_vg },
 	{ LVS, "Logical Volume", "lv_", _obj_get_lv },
@@ -4494,6 +4544,7 @@ static const struct dm_report_object_type _devtypes_report_types[] = {
 	 #id, head, &_ ## func ## _disp, desc},
 
 typedef struct cmd_log_item type_cmd_log_item;
+typedef struct cmd_perf_item type_cmd_perf_item;
 
 typedef struct physical_volume type_pv;
 typedef struct logical_volume type_lv;
@@ -4521,6 +4572,12 @@ static const struct dm_report_field_type _log_fields[] = {
 {0, 0, 0, 0, "", "", NULL, NULL},
 };
 
+static const struct dm_report_field_type _perf_fields[] = {
+/* coverity[unnecessary_header] */
+#include "columns-cmdperf.h"
+{0, 0, 0, 0, "", "", NULL, NULL},
+};
+
 #undef STR
 #undef NUM
 #undef BIN
@@ -4587,6 +4644,10 @@ void *report_init(struct cmd_context *cmd, const char *format, const char *keys,
 		types = _log_report_types;
 		fields = _log_fields;
 		reserved_values = NULL;
+	} else if (*report_type & CMDPERF) {
+		types = _perf_report_types;
+		fields = _perf_fields;
+		reserved_values = NULL;
 	} else if (*report_type & DEVTYPES) {
 		types = _devtypes_report_types;
 		fields = _devtypes_fields;
@@ -4627,6 +4688,8 @@ int report_get_prefix_and_desc(unsigned report_type_id,
 
 	if (report_type_id & CMDLOG)
 		report_types = _log_report_types;
+	else if (report_type_id & CMDPERF)
+		report_types = _perf_report_types;
 	else if (report_type_id & DEVTYPES)
 		report_types = _devtypes_report_types;
 	else
@@ -4744,6 +4807,43 @@ void report_reset_cmdlog_seqnum(void)
 	_log_seqnum = 1;
 }
 
+int report_cmdperf(void *handle)
+{
+	struct cmd_perf_item perf_item;
+	perf_phase_t phase;
+	perf_counter_t counter;
+
+	for (phase = 0; phase < PERF_PHASE_COUNT; phase++) {
+		if (!perf_phase_calls(phase))
+			continue;
+
+		perf_item = (struct cmd_perf_item) {
+			.type = "phase",
+			.name = perf_phase_name(phase),
+			.value = perf_phase_usec(phase),
+			.unit = "us",
+			.calls = perf_phase_calls(phase)
+		};
+
+		if (!dm_report_object(handle, &perf_item))
+			return_0;
+	}
+
+	for (counter = 0; counter < PERF_COUNTER_COUNT; counter++) {
+		perf_item = (struct cmd_perf_item) {
+			.type = "counter",
+			.name = perf_counter_name(counter),
+			.value = perf_counter_value(counter),
+			.unit = perf_counter_unit(counter)
+		};
+
+		if (!dm_report_object(handle, &perf_item))
+			return_0;
+	}
+
+	return 1;
+}
+
 int report_current_object_cmdlog(const char *type, const char *msg, int ret_code)
 {
 	log_report_t log_state = log_get_report_state();
@@ -32,7 +32,8 @@ enum {
 	SEGS		= 256,
 	PVSEGS		= 512,
 	LABEL		= 1024,
-	DEVTYPES	= 2048
+	DEVTYPES	= 2048,
+	CMDPERF		= 4096
 };
 
 typedef enum {
@@ -81,6 +82,14 @@ struct cmd_log_item {
 	int ret_code;
 };
 
+struct cmd_perf_item {
+	const char *type;
+	const char *name;
+	uint64_t value;
+	const char *unit;
+	uint32_t calls;
+};
+
 struct field;
 struct report_handle;
 struct processing_handle;
@@ -92,6 +101,7 @@ report_headings_t report_headings_str_to_type(const char *str);
 
 int report_format_init(struct cmd_context *cmd);
 void report_format_destroy(struct cmd_context *cmd);
+int report_format_add_perf(struct cmd_context *cmd);
 
 void *report_init(struct cmd_context *cmd, const char *format, const char *keys,
 		  unsigned *report_type, const char *separator,
@@ -122,6 +132,7 @@ int report_cmdlog(void *handle, const char *type, const char *context,
 		  const struct id *object_group_id, const char *msg,
 		  int current_errno, int ret_code);
 void report_reset_cmdlog_seqnum(void);
+int report_cmdperf(void *handle);
 #define REPORT_OBJECT_CMDLOG_NAME "status"
 #define REPORT_OBJECT_CMDLOG_SUCCESS "success"
 #define REPORT_OBJECT_CMDLOG_FAILURE "failure"
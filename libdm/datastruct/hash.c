@@ -36,15 +36,14 @@ struct dm_hash_table {
 	struct dm_hash_node **slots;
 };
 
-#undef get16bits
-#if (defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)))
-#define get16bits(d) (*((const uint16_t *) (d)))
-#endif
+/* Grow slots when there are more nodes than slots */
+#define HASH_MAX_LOAD		1
+#define HASH_MAX_SLOTS		(1u << 30)
 
-#if !defined (get16bits)
-#define get16bits(d) ((((uint32_t)(((const uint8_t *)(d))[1])) << 8)\
-                       +(uint32_t)(((const uint8_t *)(d))[0]) )
-#endif
+/* Secret-less constants from wyhash */
+#define HASH_P0			UINT64_C(0xa0761d6478bd642f)
+#define HASH_P1			UINT64_C(0xe7037ed1a0b428db)
+#define HASH_P2			UINT64_C(0x8ebc6af09c88c6e3)
 
 static struct dm_hash_node *_create_node(const void *key, unsigned len)
 {
@@ -58,35 +57,117 @@ static struct dm_hash_node *_create_node(const void *key, unsigned len)
 	return n;
 }
 
+static inline uint64_t _read64(const uint8_t *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+static inline uint64_t _read32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+
+	return v;
+}
+
+/* Multiply and fold 64x64->128 bit product */
+static inline uint64_t _mix(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+	__uint128_t r = (__uint128_t) a * b;
+
+	return (uint64_t) (r >> 64) ^ (uint64_t) r;
+#else
+	uint64_t ha = a >> 32, la = (uint32_t) a, hb = b >> 32, lb = (uint32_t) b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32), c = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+
+	c += lo < t;
+
+	return (rh + (rm0 >> 32) + (rm1 >> 32) + c) ^ lo;
+#endif
+}
+
 /*
- * Adapted Bob Jenkins hash to read by 2 bytes if possible.
- * https://secure.wikimedia.org/wikipedia/en/wiki/Jenkins_hash_function
- *
- * Reduces amount of hash collisions
+ * Hash in the style of wyhash: 16 bytes per multiply, short keys
+ * (pvids, vgids, device names) need just two multiplies.
+ * Byte order of the host is used, value is not stored anywhere.
  */
 static unsigned _hash(const void *key, unsigned len)
 {
-	const uint8_t *str = (uint8_t*) key;
-	unsigned hash = 0, i;
-	unsigned sz = len / 2;
-
-	for(i = 0; i < sz; ++i) {
-		hash += get16bits(str + 2 * i);
-		hash += (hash << 10);
-		hash ^= (hash >> 6);
+	const uint8_t *p = (const uint8_t *) key;
+	uint64_t seed = HASH_P0 ^ len;
+	uint64_t a, b;
+	unsigned i = len;
+
+	if (i <= 16) {
+		if (i >= 4) {
+			a = (_read32(p) << 32) | _read32(p + ((i >> 3) << 2));
+			b = (_read32(p + i - 4) << 32) | _read32(p + i - 4 - ((i >> 3) << 2));
+		} else if (i) {
+			a = ((uint64_t) p[0] << 16) | ((uint64_t) p[i >> 1] << 8) | p[i - 1];
+			b = 0;
+		} else
+			a = b = 0;
+	} else {
+		while (i > 16) {
+			seed = _mix(_read64(p) ^ HASH_P1, _read64(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = _read64(p + i - 16);
+		b = _read64(p + i - 8);
 	}
 
-	if (len & 1) {
-		hash += str[len - 1];
-		hash += (hash << 10);
-		hash ^= (hash >> 6);
-	}
+	seed = _mix(HASH_P1 ^ len, _mix(a ^ HASH_P1, b ^ seed) ^ HASH_P2);
 
-	hash += (hash << 3);
-	hash ^= (hash >> 11);
-	hash += (hash << 15);
+	return (unsigned) (seed ^ (seed >> 32));
+}
+
+static struct dm_hash_node **_slot_tail(struct dm_hash_node **c)
+{
+	while (*c)
+		c = &((*c)->next);
 
-	return hash;
+	return c;
+}
+
+/*
+ * Double the number of slots when the table is overloaded.
+ * Nodes keep their full hash, so they are only relinked.
+ * Failure to grow is not fatal, the table just stays slower.
+ */
+static void _grow_slots(struct dm_hash_table *t)
+{
+	struct dm_hash_node **slots, *c, *n;
+	unsigned i, new_mask, h;
+
+	if ((t->num_nodes <= (t->mask_slots + 1) * HASH_MAX_LOAD) ||
+	    (t->mask_slots + 1 >= HASH_MAX_SLOTS))
+		return;
+
+	new_mask = (t->mask_slots << 1) | 1;
+	if (!(slots = dm_zalloc(sizeof(*slots) * (new_mask + 1))))
+		return;
+
+	for (i = 0; i <= t->mask_slots; i++)
+		for (c = t->slots[i]; c; c = n) {
+			n = c->next;
+			/* Preserve order of nodes with the same key (insert_allow_multiple) */
+			h = c->hash & new_mask;
+			c->next = NULL;
+			*_slot_tail(slots + h) = c;
+		}
+
+	dm_free(t->slots);
+	t->slots = slots;
+	t->mask_slots = new_mask;
 }
 
 struct dm_hash_table *dm_hash_create(unsigned size_hint)
@@ -198,6 +279,7 @@ int dm_hash_insert_binary(struct dm_hash_table *t, const void *key,
 		n->next = 0;
 		*c = n;
 		t->num_nodes++;
+		_grow_slots(t);
 	}
 
 	return 1;
@@ -281,6 +363,8 @@ int dm_hash_insert_allow_multiple(struct dm_hash_table *t, const char *key,
 	t->slots[h] = n;
 
 	t->num_nodes++;
+	_grow_slots(t);
+
 	return 1;
 }
 
@@ -219,6 +219,7 @@ enum {
 	REGION_ARG,
 	REGION_ID_ARG,
 	RELATIVE_ARG,
+	RETAIN_ARG,
 	RETRY_ARG,
 	ROWS_ARG,
 	SEGMENTS_ARG,
@@ -454,23 +455,29 @@ struct dmsetup_report_obj {
 	struct dm_stats *stats;
 };
 
-static int _task_run(struct dm_task *dmt)
+static void _log_task_timestamp(struct dm_task *dmt)
 {
-	int r;
 	uint64_t delta;
 	struct dm_timestamp *ts;
 
-	if (_initial_timestamp)
-		dm_task_set_record_timestamp(dmt);
-
-	r = dm_task_run(dmt);
-
 	if (_initial_timestamp &&
 	    (ts = dm_task_get_ioctl_timestamp(dmt))) {
 		delta = dm_timestamp_delta(ts, _initial_timestamp);
 		log_debug("Timestamp: %7" PRIu64 ".%09" PRIu64 " seconds",
 			  delta / NSEC_PER_SEC, delta % NSEC_PER_SEC);
 	}
+}
+
+static int _task_run(struct dm_task *dmt)
+{
+	int r;
+
+	if (_initial_timestamp)
+		dm_task_set_record_timestamp(dmt);
+
+	r = dm_task_run(dmt);
+
+	_log_task_timestamp(dmt);
 
 	return r;
 }
@@ -2427,72 +2434,60 @@ static void hide_key(char *params, const char *name)
 		*c++ = '0';
 }
 
-static int _status(CMD_ARGS)
+static int _status_cmdno(const struct command *cmd)
 {
-	int r = 0;
-	struct dm_task *dmt;
-	void *next = NULL;
-	uint64_t start, length;
-	char *target_type = NULL;
-	char *params, *c;
-	int cmdno;
-	const char *name = NULL;
-	int matched = 0;
-	int ls_only = 0;
-	int use_concise = 0;
-	struct dm_info info;
-
-	if (names)
-		name = names->name;
-	else {
-		if (!argc && !_switches[UUID_ARG] && !_switches[MAJOR_ARG])
-			/* FIXME Respect deps in concise mode, so they are correctly ordered for recreation */
-			return _process_all(cmd, NULL, argc, argv, 0, _status);
-		name = argv[0];
-	}
-
-	if (!strcmp(cmd->name, "table")) {
-		cmdno = DM_DEVICE_TABLE;
-		/* --concise only applies to 'table' */
-		if (_switches[CONCISE_ARG])
-			use_concise = 1;
-	} else
-		cmdno = DM_DEVICE_STATUS;
-
-	if (!strcmp(cmd->name, "ls"))
-		ls_only = 1;
+	return strcmp(cmd->name, "table") ? DM_DEVICE_STATUS : DM_DEVICE_TABLE;
+}
 
-	if (!(dmt = dm_task_create(cmdno)))
-		return_0;
+/* Task options for status, table, ls and measure, also used for batches */
+static int _status_prepare_task(struct dm_task *dmt, void *context)
+{
+	const struct command *cmd = context;
 
-	if (!_set_task_device(dmt, name, 0))
-		goto_out;
+	/* Batched tasks do not go through _task_run() */
+	if (_initial_timestamp)
+		dm_task_set_record_timestamp(dmt);
 
 	if (_switches[NOOPENCOUNT_ARG] && !dm_task_no_open_count(dmt))
-		goto_out;
+		return_0;
 
 	if (_switches[INACTIVE_ARG] && !dm_task_query_inactive_table(dmt))
-		goto_out;
+		return_0;
 
 	if (_switches[CHECKS_ARG] && !dm_task_enable_checks(dmt))
-		goto_out;
+		return_0;
 
 	if (_switches[NOFLUSH_ARG] && !dm_task_no_flush(dmt))
-		goto_out;
+		return_0;
 
 	if (!strcmp(cmd->name, "measure") &&
 	    !dm_task_ima_measurement(dmt))
-		goto_out;
+		return_0;
 
-	if (!_task_run(dmt))
-		goto_out;
+	return 1;
+}
+
+/* Print the targets of a completed status or table task */
+static int _display_status(const struct command *cmd, struct dm_task *dmt,
+			   const char *name, int multiple_devices)
+{
+	void *next = NULL;
+	uint64_t start, length;
+	char *target_type = NULL;
+	char *params, *c;
+	int cmdno = _status_cmdno(cmd);
+	int matched = 0;
+	int ls_only = !strcmp(cmd->name, "ls");
+	/* --concise only applies to 'table' */
+	int use_concise = (cmdno == DM_DEVICE_TABLE) && _switches[CONCISE_ARG];
+	struct dm_info info;
 
 	if (!dm_task_get_info(dmt, &info))
-		goto_out;
+		return_0;
 
 	if (!info.exists) {
 		log_error("Device does not exist.");
-		goto out;
+		return 0;
 	}
 
 	if (!name)
@@ -2584,9 +2579,101 @@ static int _status(CMD_ARGS)
 		putchar('\n');
 
 	if (matched && _switches[EXEC_ARG] && _command_to_exec && !_exec_command(name))
+		return_0;
+
+	return 1;
+}
+
+/*
+ * Status of all devices: list them once, then query them as a task
+ * batch and print the results in list order.  The batch runs serially
+ * like the per-device path.
+ */
+static int _status_all(const struct command *cmd)
+{
+	struct dm_task_batch *batch = NULL;
+	struct dm_names *names, *first;
+	struct dm_task *dmt, *task;
+	unsigned next = 0, i = 0;
+	int r = 0;
+
+	if (!(dmt = dm_task_create(DM_DEVICE_LIST)))
+		return_0;
+
+	if (_switches[CHECKS_ARG] && !dm_task_enable_checks(dmt))
 		goto_out;
 
-	r = 1;
+	if (!_task_run(dmt))
+		goto_out;
+
+	if (!(first = names = dm_task_get_names(dmt)))
+		goto_out;
+
+	if (!names->dev) {
+		printf("No devices found\n");
+		r = 1;
+		goto out;
+	}
+
+	if (!(batch = dm_task_batch_create(_status_cmdno(cmd))))
+		goto_out;
+
+	dm_task_batch_set_prepare_fn(batch, _status_prepare_task, (void *) cmd);
+
+	do {
+		names = (struct dm_names *)((char *) names + next);
+		if (!dm_task_batch_add_name(batch, names->name))
+			goto_out;
+		next = names->next;
+	} while (next);
+
+	r = dm_task_batch_run(batch);
+
+	names = first;
+	next = 0;
+	do {
+		names = (struct dm_names *)((char *) names + next);
+		if ((task = dm_task_batch_get_task(batch, i++)))
+			_log_task_timestamp(task);
+		if (!task || !_display_status(cmd, task, names->name, 1))
+			r = 0;
+		next = names->next;
+	} while (next);
+
+out:
+	dm_task_batch_destroy(batch);
+	dm_task_destroy(dmt);
+	return r;
+}
+
+static int _status(CMD_ARGS)
+{
+	int r = 0;
+	struct dm_task *dmt;
+	const char *name = NULL;
+
+	if (names)
+		name = names->name;
+	else {
+		if (!argc && !_switches[UUID_ARG] && !_switches[MAJOR_ARG])
+			/* FIXME Respect deps in concise mode, so they are correctly ordered for recreation */
+			return _status_all(cmd);
+		name = argv[0];
+	}
+
+	if (!(dmt = dm_task_create(_status_cmdno(cmd))))
+		return_0;
+
+	if (!_set_task_device(dmt, name, 0))
+		goto_out;
+
+	if (!_status_prepare_task(dmt, (void *) cmd))
+		goto_out;
+
+	if (!_task_run(dmt))
+		goto_out;
+
+	r = _display_status(cmd, dmt, name, multiple_devices);
 
 out:
 	dm_task_destroy(dmt);
@@ -5586,6 +5673,213 @@ out:
 	return r;
 }
 
+/*
+ * Default history kept by 'dmstats record' without --retain: one day.
+ */
+#define STATS_RECORD_RETAIN_SECS (24 * 3600)
+
+/*
+ * Select the regions and groups of dms to record: --regionid or
+ * --groupid select one, otherwise every group and every region that
+ * is not a member of a group.
+ */
+static int _stats_record_select(struct dm_stats *dms, uint64_t **ids,
+				unsigned *nr_ids)
+{
+	uint64_t id, group_id;
+
+	*nr_ids = 0;
+	if (!(*ids = dm_malloc((dm_stats_get_nr_regions(dms) + 1) * sizeof(**ids)))) {
+		log_error("Could not allocate stats record selection.");
+		return 0;
+	}
+
+	if (_switches[REGION_ID_ARG]) {
+		id = (uint64_t) _int_args[REGION_ID_ARG];
+		if (!dm_stats_region_present(dms, id)) {
+			log_error("No such region: "FMTu64".", id);
+			return 0;
+		}
+		(*ids)[(*nr_ids)++] = id;
+		return 1;
+	}
+
+	if (_switches[GROUP_ID_ARG]) {
+		id = (uint64_t) _int_args[GROUP_ID_ARG];
+		if (!dm_stats_group_present(dms, id)) {
+			log_error("No such group: "FMTu64".", id);
+			return 0;
+		}
+		(*ids)[(*nr_ids)++] = id | DM_STATS_WALK_GROUP;
+		return 1;
+	}
+
+	dm_stats_foreach_region(dms) {
+		id = dm_stats_get_current_region(dms);
+		group_id = dm_stats_get_group_id(dms, id);
+		if (group_id == DM_STATS_GROUP_NONE)
+			(*ids)[(*nr_ids)++] = id;
+		/* A group_id is the region_id of its first member. */
+		else if (group_id == id)
+			(*ids)[(*nr_ids)++] = id | DM_STATS_WALK_GROUP;
+	}
+
+	return 1;
+}
+
+static uint64_t _stats_record_now(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_REALTIME, &ts))
+		return 0;
+
+	return (uint64_t) ts.tv_sec * NSEC_PER_SEC + (uint64_t) ts.tv_nsec;
+}
+
+static int _stats_record(CMD_ARGS)
+{
+	const char *program_id = NULL;
+	struct dm_stats_record *rec = NULL;
+	struct dm_histogram *bounds;
+	struct dm_stats **dms = NULL;
+	uint64_t **ids = NULL, id, now, last;
+	uint64_t retain = STATS_RECORD_RETAIN_SECS, nr_samples;
+	unsigned *nr_ids = NULL, nr_series = 0, nr_bins = 0, series;
+	int bins, i, nr_devs = argc - 1, r = 0;
+	const char *path;
+	unsigned j;
+
+	/* record does not use a report */
+	if (_report) {
+		dm_report_free(_report);
+		_report = NULL;
+	}
+
+	if (argc < 2) {
+		log_error("record requires a file path and at least one device.");
+		return 0;
+	}
+
+	if (_switches[REGION_ID_ARG] && _switches[GROUP_ID_ARG]) {
+		log_error("Please supply at most one of --regionid and --groupid.");
+		return 0;
+	}
+
+	if (_switches[ALL_PROGRAMS_ARG])
+		program_id = DM_STATS_ALL_PROGRAMS;
+	else if (_switches[PROGRAM_ID_ARG])
+		program_id = _string_args[PROGRAM_ID_ARG];
+
+	if (_switches[RETAIN_ARG])
+		retain = (uint64_t) _int_args[RETAIN_ARG];
+
+	/* At least one sample, even if --retain is below the interval. */
+	if (!(nr_samples = retain / (_interval / NSEC_PER_SEC)))
+		nr_samples = 1;
+
+	path = argv[0];
+
+	if (!(dms = dm_zalloc(nr_devs * sizeof(*dms))) ||
+	    !(ids = dm_zalloc(nr_devs * sizeof(*ids))) ||
+	    !(nr_ids = dm_zalloc(nr_devs * sizeof(*nr_ids)))) {
+		log_error("Could not allocate stats record devices.");
+		goto out;
+	}
+
+	/* Populating clears the counters: this starts the first interval. */
+	for (i = 0; i < nr_devs; i++) {
+		if (!(dms[i] = dm_stats_create(DM_STATS_PROGRAM_ID)))
+			goto_out;
+
+		if (!_bind_stats_device(dms[i], argv[i + 1]))
+			goto_out;
+
+		if (!dm_stats_populate(dms[i], program_id, DM_STATS_REGIONS_ALL)) {
+			log_error("No statistics regions to record on %s.",
+				  argv[i + 1]);
+			goto out;
+		}
+
+		if (!_stats_record_select(dms[i], &ids[i], &nr_ids[i]))
+			goto_out;
+
+		for (j = 0; j < nr_ids[i]; j++) {
+			bins = dm_stats_get_region_nr_histogram_bins(dms[i],
+					ids[i][j] & ~DM_STATS_WALK_GROUP);
+			if ((unsigned) bins > nr_bins)
+				nr_bins = (unsigned) bins;
+		}
+		nr_series += nr_ids[i];
+	}
+
+	if (!(rec = dm_stats_record_create(path, nr_series, nr_bins, nr_samples)))
+		goto_out;
+
+	for (i = 0, series = 0; i < nr_devs; i++)
+		for (j = 0; j < nr_ids[i]; j++, series++) {
+			id = ids[i][j];
+			bounds = NULL;
+			if (dm_stats_get_region_nr_histogram_bins(dms[i], id & ~DM_STATS_WALK_GROUP) &&
+			    !(bounds = dm_stats_get_histogram(dms[i], id,
+							      (id & DM_STATS_WALK_GROUP) ?
+							      DM_STATS_WALK_GROUP :
+							      DM_STATS_WALK_REGION)))
+				goto_out;
+			if (!dm_stats_record_set_series(rec, series, argv[i + 1],
+							id, bounds))
+				goto_out;
+		}
+
+	/*
+	 * record runs the interval loop itself: without --count it runs
+	 * until interrupted. The extra _count accounts for the wait before
+	 * the first sample and leaves _count at 1 for the main loop.
+	 */
+	if (_count == 1) {
+		if (!_start_timer())
+			goto_out;
+		if (!_switches[COUNT_ARG])
+			_count = INT64_MAX;
+	}
+	if (_count != INT64_MAX)
+		_count++;
+
+	last = _stats_record_now();
+	do {
+		if (!_do_timer_wait())
+			goto_out;
+
+		for (i = 0, series = 0; i < nr_devs; i++) {
+			if (!dm_stats_populate(dms[i], program_id,
+					       DM_STATS_REGIONS_ALL))
+				goto_out;
+			for (j = 0; j < nr_ids[i]; j++, series++)
+				if (!dm_stats_record_sample(rec, series, dms[i],
+							    ids[i][j]))
+					goto_out;
+		}
+
+		now = _stats_record_now();
+		if (!dm_stats_record_commit(rec, now, now - last))
+			goto_out;
+		last = now;
+	} while (--_count > 1);
+
+	r = 1;
+out:
+	dm_stats_record_close(rec);
+	for (i = 0; dms && ids && (i < nr_devs); i++) {
+		dm_stats_destroy(dms[i]);
+		dm_free(ids[i]);
+	}
+	dm_free(nr_ids);
+	dm_free(ids);
+	dm_free(dms);
+
+	return r;
+}
+
 static int _stats_report(CMD_ARGS)
 {
 	int r = 0, objtype_args;
@@ -5913,6 +6207,9 @@ static int _stats_help(CMD_ARGS);
  *   print [--clear] [--allprograms|--programid id]
  *       [--allregions|--regionid id]
  *       [--alldevices|<device>...]
+ *   record [--interval <seconds>] [--count <cnt>]
+ *       [--regionid <id>|--groupid <id>]
+ *       [--allprograms|--programid id] <record_file> <device>...
  *   report [--interval <seconds>] [--count <cnt>]
  *       [--units <u>] [--programid <id>] [--regionid <id>]
  *       [-o <fields>] [-O|--sort <sort_fields>]
@@ -5950,6 +6247,8 @@ static int _stats_help(CMD_ARGS);
 #define PRINT_OPTS "[--clear] " ALL_PROGS_REGIONS_DEVICES
 #define REPORT_OPTS "[--interval <seconds>] [--count <cnt>]" INDENT \
 "[--units <u>] " SELECT_OPTS INDENT DM_REPORT_OPTS INDENT ALL_PROGS_OPT
+#define RECORD_OPTS "[--interval <seconds>] [--count <cnt>] [--retain <seconds>]" INDENT \
+"[--regionid <id>|--groupid <id>] " ALL_PROGS_OPT INDENT "<record_file> <device>..."
 #define GROUP_OPTS "[--alias NAME] --regions <regions>" INDENT ALL_PROGS_OPT ALL_DEVICES_OPT
 #define UNGROUP_OPTS GROUP_ID_OPT ALL_PROGS_OPT INDENT ALL_DEVICES_OPT
 #define UPDATE_OPTS GROUP_ID_OPT INDENT FILE_MONITOR_OPTS " <file_path>"
@@ -5968,6 +6267,7 @@ static const struct command _stats_subcommands[] = {
 	{"group", GROUP_OPTS, 1, -1, 1, 0, _stats_group},
 	{"list", ALL_PROGS_OPT ALL_REGIONS_OPT, 0, -1, 1, 0, _stats_report},
 	{"print", PRINT_OPTS, 0, -1, 1, 0, _stats_print},
+	{"record", RECORD_OPTS, 2, -1, 0, 0, _stats_record},
 	{"report", REPORT_OPTS "[<device>...]", 0, -1, 1, 0, _stats_report},
 	{"ungroup", UNGROUP_OPTS, 1, -1, 1, 0, _stats_ungroup},
 	{"update_filemap", UPDATE_OPTS, 1, 1, 0, 0, _stats_update_file},
@@ -5990,6 +6290,7 @@ static const struct command _stats_subcommands[] = {
 #undef CREATE_OPTS
 #undef FILEMAP_OPTS
 #undef PRINT_OPTS
+#undef RECORD_OPTS
 #undef REPORT_OPTS
 #undef GROUP_OPTS
 #undef UNGROUP_OPTS
@@ -6775,6 +7076,7 @@ static int _process_switches(int *argcp, char ***argvp, const char *dev_dir)
 		{"regionid",	  required_argument, 0, REGION_ID_ARG},
 		{"regions",	  required_argument, 0, REGIONS_ARG},
 		{"relative",		no_argument, 0, RELATIVE_ARG},
+		{"retain",	  required_argument, 0, RETAIN_ARG},
 		{"retry",		no_argument, 0, RETRY_ARG},
 		{"rows",		no_argument, 0, ROWS_ARG},
 		{"segments",		no_argument, 0, SEGMENTS_ARG},
@@ -6961,6 +7263,13 @@ static int _process_switches(int *argcp, char ***argvp, const char *dev_dir)
 				return 0;
 			}
 			break;
+		case RETAIN_ARG:
+			_int_args[RETAIN_ARG] = atoi(optarg);
+			if (_int_args[RETAIN_ARG] <= 0) {
+				log_error("Retention time must be a positive integer.");
+				return 0;
+			}
+			break;
 		case MANGLENAME_ARG:
 			if (!strcasecmp(optarg, "none"))
 				_int_args[MANGLENAME_ARG] = DM_STRING_MANGLING_NONE;
@@ -7065,12 +7374,20 @@ static int _process_switches(int *argcp, char ***argvp, const char *dev_dir)
 
 static int _perform_command_for_all_repeatable_args(CMD_ARGS)
 {
+	const struct command *stats_cmd;
+	int repeatable = cmd->repeatable_cmd;
+
+	/* Stats sub-commands such as 'record' take the whole argument list. */
+	if (cmd->has_subcommands && !strcmp(cmd->name, "stats") &&
+	    (stats_cmd = _find_stats_subcommand(subcommand)))
+		repeatable = stats_cmd->repeatable_cmd;
+
 	do {
 		if (!cmd->fn(cmd, subcommand, argc, argv++, NULL, multiple_devices)) {
 			log_error("Command failed.");
 			return 0;
 		}
-	} while (cmd->repeatable_cmd && argc-- > 1);
+	} while (repeatable && argc-- > 1);
 
 	return 1;
 }
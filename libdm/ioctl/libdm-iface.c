@@ -15,6 +15,7 @@
 
 #include "libdm/misc/dmlib.h"
 #include "libdm-targets.h"
+#include "libdm-ioctl-cache.h"
 #include "libdm/libdm-common.h"
 
 #include <stddef.h>
@@ -86,9 +87,6 @@ static int _hold_control_fd_open = 0;
 static pthread_mutex_t _control_fd_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int _version_ok = 1;
 static pthread_once_t _version_once = PTHREAD_ONCE_INIT;
-static unsigned _ioctl_buffer_double_factor = 0;
-/* Max ioctl buffer: 16KB << 16 = 1GB */
-#define DM_IOCTL_BUFFER_MAX_DOUBLINGS 16
 
 /* *INDENT-OFF* */
 static const struct cmd_data _cmd_data_v4[] = {
@@ -126,6 +124,13 @@ static const struct cmd_data _cmd_data_v4[] = {
 };
 /* *INDENT-ON* */
 
+static void _dm_task_release_dmi(struct dm_task *dmt)
+{
+	dm_ioctl_buffer_free(dmt->dmi.v4, dmt->dmi_size, dmt->secure_data);
+	dmt->dmi.v4 = NULL;
+	dmt->dmi_size = 0;
+}
+
 /* Validate task type against the command table. */
 static int _validate_task_type(struct dm_task *dmt)
 {
@@ -536,15 +541,6 @@ static void _dm_zfree_string(char *string)
 	}
 }
 
-static void _dm_zfree_dmi(struct dm_ioctl *dmi)
-{
-	if (dmi) {
-		memset(dmi, 0, dmi->data_size);
-		__asm__ volatile ("" ::: "memory"); /* Compiler barrier. */
-		dm_free(dmi);
-	}
-}
-
 static void _dm_task_free_targets(struct dm_task *dmt)
 {
 	struct target *t, *n;
@@ -565,10 +561,7 @@ static void _dm_task_free_targets(struct dm_task *dmt)
 void dm_task_destroy(struct dm_task *dmt)
 {
 	_dm_task_free_targets(dmt);
-	if (dmt->secure_data)
-		_dm_zfree_dmi(dmt->dmi.v4);
-	else
-		dm_free(dmt->dmi.v4);
+	_dm_task_release_dmi(dmt);
 	dm_free(dmt->dev_name);
 	dm_free(dmt->mangled_dev_name);
 	dm_free(dmt->newname);
@@ -1324,7 +1317,8 @@ static int _add_params(int type)
 	}
 }
 
-static struct dm_ioctl *_flatten(struct dm_task *dmt, unsigned repeat_count)
+static struct dm_ioctl *_flatten(struct dm_task *dmt, unsigned repeat_count,
+				 size_t *size)
 {
 	size_t min_size;
 	const int (*version)[3];
@@ -1420,7 +1414,7 @@ static struct dm_ioctl *_flatten(struct dm_task *dmt, unsigned repeat_count)
 	while (repeat_count--)
 		len *= 2;
 
-	if (!(dmi = dm_zalloc(len)))
+	if (!(dmi = dm_ioctl_buffer_alloc(len, size)))
 		return NULL;
 
 	version = &_cmd_data_v4[dmt->type].version;
@@ -1548,7 +1542,7 @@ static struct dm_ioctl *_flatten(struct dm_task *dmt, unsigned repeat_count)
 	return dmi;
 
       bad:
-	_dm_zfree_dmi(dmi);
+	dm_ioctl_buffer_free(dmi, *size, dmt->secure_data);
 	return NULL;
 }
 
@@ -2158,6 +2152,7 @@ static int _reload_with_suppression_v4(struct dm_task *dmt)
 
 	if (!t1 && !t2) {
 		dmt->dmi.v4 = task->dmi.v4;
+		dmt->dmi_size = task->dmi_size;
 		task->dmi.v4 = NULL;
 		dm_task_destroy(task);
 		return 1;
@@ -2376,11 +2371,12 @@ static inline int _dmt_has_uevent(const struct dm_task *dmt)
  * NULL on failure.
  */
 static struct dm_ioctl *_dm_task_build_dmi(struct dm_task *dmt,
-					   unsigned buffer_repeat_count)
+					   unsigned buffer_repeat_count,
+					   size_t *size)
 {
 	struct dm_ioctl *dmi;
 
-	dmi = _flatten(dmt, buffer_repeat_count);
+	dmi = _flatten(dmt, buffer_repeat_count, size);
 	if (!dmi) {
 		log_error("Couldn't create ioctl argument.");
 		return NULL;
@@ -2464,6 +2460,22 @@ static struct dm_ioctl *_dm_task_build_dmi(struct dm_task *dmt,
 	return dmi;
 }
 
+/* Number of DM ioctls issued by this process, see dm_lib_ioctl_count(). */
+static uint64_t _ioctl_count = 0;
+
+uint64_t dm_lib_ioctl_count(void)
+{
+	return __atomic_load_n(&_ioctl_count, __ATOMIC_RELAXED);
+}
+
+/* Mutex released by this thread while it waits in the ioctl syscall. */
+static __thread pthread_mutex_t *_ioctl_unlock_mutex = NULL;
+
+void dm_ioctl_set_unlock_mutex(pthread_mutex_t *mutex)
+{
+	_ioctl_unlock_mutex = mutex;
+}
+
 /* Execute a single DM ioctl.  Sets dmt->ioctl_errno on failure.
  * Caller must validate dmt->type via _validate_task_type(). */
 int dm_ioctl_exec(int fd, struct dm_task *dmt, struct dm_ioctl *dmi)
@@ -2473,9 +2485,14 @@ int dm_ioctl_exec(int fd, struct dm_task *dmt, struct dm_ioctl *dmi)
 	dmt->ioctl_errno = 0;
 
 #ifdef DM_IOCTLS
+	__atomic_add_fetch(&_ioctl_count, 1, __ATOMIC_RELAXED);
+	if (_ioctl_unlock_mutex)
+		pthread_mutex_unlock(_ioctl_unlock_mutex);
 	r = ioctl(fd, _cmd_data_v4[dmt->type].cmd, dmi);
 	if (r < 0)
 		dmt->ioctl_errno = errno;
+	if (_ioctl_unlock_mutex)
+		pthread_mutex_lock(_ioctl_unlock_mutex);
 #else /* Userspace alternative for testing */
 	r = 0;
 #endif
@@ -2595,13 +2612,15 @@ static struct dm_ioctl *_do_dm_ioctl(struct dm_task *dmt,
 				     unsigned buffer_repeat_count)
 {
 	struct dm_ioctl *dmi;
+	size_t size;
 	int r;
 
-	if (!(dmi = _dm_task_build_dmi(dmt, buffer_repeat_count)))
+	if (!(dmi = _dm_task_build_dmi(dmt, buffer_repeat_count, &size)))
 		return_NULL;
 
-	_dm_zfree_dmi(dmt->dmi.v4);
+	_dm_task_release_dmi(dmt);
 	dmt->dmi.v4 = dmi;
+	dmt->dmi_size = size;
 
 	r = _dm_ioctl_exec_retry(_get_control_fd(), dmt);
 
@@ -2610,8 +2629,7 @@ static struct dm_ioctl *_do_dm_ioctl(struct dm_task *dmt,
 			stack;
 
 	if (!_dm_ioctl_post(dmt, dmi, r)) {
-		_dm_zfree_dmi(dmi);
-		dmt->dmi.v4 = NULL;
+		_dm_task_release_dmi(dmt);
 		return_NULL;
 	}
 
@@ -2694,7 +2712,7 @@ int dm_task_get_errno(struct dm_task *dmt)
 
 /*
  * Check whether a DM_BUFFER_FULL_FLAG retry is allowed for this task type.
- * Increments the global doubling factor on success.
+ * Increments the thread's doubling factor for the type on success.
  * Returns 1 if the caller should retry with a larger buffer, 0 otherwise.
  */
 static int _can_retry_buffer_full(struct dm_task *dmt)
@@ -2713,15 +2731,13 @@ static int _can_retry_buffer_full(struct dm_task *dmt)
 		return 0;
 	}
 
-	if (_ioctl_buffer_double_factor >= DM_IOCTL_BUFFER_MAX_DOUBLINGS) {
+	if (!dm_ioctl_buffer_grow(dmt->type)) {
 		log_error("Ioctl buffer maximum reached (16KB << %u = %zu bytes), giving up.",
-			  _ioctl_buffer_double_factor,
-			  (size_t)16 * 1024 << _ioctl_buffer_double_factor);
+			  dm_ioctl_buffer_doublings(dmt->type),
+			  (size_t)16 * 1024 << dm_ioctl_buffer_doublings(dmt->type));
 		return 0;
 	}
 
-	_ioctl_buffer_double_factor++;
-
 	return 1;
 }
 
@@ -2786,7 +2802,7 @@ DM_EXPORT_NEW_SYMBOL(int, dm_task_run, 1_02_197)
 
 	/* FIXME Detect and warn if cookie set but should not be. */
 repeat_ioctl:
-	if (!(dmi = _do_dm_ioctl(dmt, _ioctl_buffer_double_factor))) {
+	if (!(dmi = _do_dm_ioctl(dmt, dm_ioctl_buffer_doublings(dmt->type)))) {
 		_udev_complete(dmt);
 		return_0;
 	}
@@ -2804,8 +2820,7 @@ repeat_ioctl:
 	return 1;
 
       bad:
-	_dm_zfree_dmi(dmt->dmi.v4);
-	dmt->dmi.v4 = NULL;
+	_dm_task_release_dmi(dmt);
 	return 0;
 }
 
@@ -2830,6 +2845,7 @@ void dm_lib_release(void)
 }
 
 void dm_pools_check_leaks(void);
+void dm_pools_release_cache(void);
 
 static pthread_once_t _exit_once = PTHREAD_ONCE_INIT;
 
@@ -2847,6 +2863,8 @@ static void _do_lib_exit(void)
 		dm_bitset_destroy(_dm_bitset);
 	_dm_bitset = NULL;
 	pthread_mutex_unlock(&_control_fd_mutex);
+	dm_ioctl_cache_exit();
+	dm_pools_release_cache();
 	dm_pools_check_leaks();
 	dm_dump_memory();
 }
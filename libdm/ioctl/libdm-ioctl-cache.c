@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of the device-mapper userspace tools.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libdm/misc/dmlib.h"
+#include "libdm-ioctl-cache.h"
+
+#include <pthread.h>
+
+/*
+ * Per-thread ioctl buffer cache.
+ *
+ * Keeps one spare dm_ioctl buffer so back-to-back dm_task_run() calls
+ * do not hit the allocator, and the number of buffer doublings the
+ * last DM_BUFFER_FULL_FLAG retry needed for each ioctl type, so the
+ * next ioctl of that type starts with a large enough buffer.
+ * The spare is freed by the thread-specific key destructor on thread
+ * exit or by dm_lib_exit() for the calling thread.  dm_lib_exit() also
+ * deletes the key, so no destructor is left pointing into the library
+ * once it is unloaded, and buffers are no longer cached after that.
+ */
+#define DM_IOCTL_CACHE_TYPES (DM_DEVICE_GET_TARGET_VERSION + 1)
+
+struct ioctl_cache {
+	struct dm_ioctl *spare;
+	size_t spare_size;
+	int key_set;
+	unsigned char doublings[DM_IOCTL_CACHE_TYPES];
+};
+
+static __thread struct ioctl_cache _ioctl_cache;
+static pthread_key_t _ioctl_cache_key;
+static pthread_once_t _ioctl_cache_once = PTHREAD_ONCE_INIT;
+static int _ioctl_cache_key_ok = 0;
+
+static void _ioctl_cache_release(void *data)
+{
+	struct ioctl_cache *cache = data;
+
+	dm_free(cache->spare);
+	cache->spare = NULL;
+	cache->spare_size = 0;
+}
+
+static void _ioctl_cache_key_create(void)
+{
+	if (pthread_key_create(&_ioctl_cache_key, _ioctl_cache_release))
+		log_sys_debug("pthread_key_create", "ioctl buffer cache");
+	else
+		_ioctl_cache_key_ok = 1;
+}
+
+static void _ioctl_cache_key_delete(void)
+{
+	if (!_ioctl_cache_key_ok)
+		return;
+
+	_ioctl_cache_key_ok = 0;
+	if (pthread_key_delete(_ioctl_cache_key))
+		log_sys_debug("pthread_key_delete", "ioctl buffer cache");
+}
+
+static void _wipe_free(struct dm_ioctl *dmi, size_t size)
+{
+	memset(dmi, 0, size);
+	__asm__ volatile ("" ::: "memory"); /* Compiler barrier. */
+	dm_free(dmi);
+}
+
+struct dm_ioctl *dm_ioctl_buffer_alloc(size_t len, size_t *size)
+{
+	struct ioctl_cache *cache = &_ioctl_cache;
+	struct dm_ioctl *dmi;
+
+	if (cache->spare && (cache->spare_size >= len)) {
+		dmi = cache->spare;
+		*size = cache->spare_size;
+		cache->spare = NULL;
+		cache->spare_size = 0;
+		memset(dmi, 0, len);
+		return dmi;
+	}
+
+	*size = len;
+
+	return dm_zalloc(len);
+}
+
+/* Keeps the larger of the returned buffer and the current spare. */
+void dm_ioctl_buffer_free(struct dm_ioctl *dmi, size_t size, int secure_data)
+{
+	struct ioctl_cache *cache = &_ioctl_cache;
+
+	if (!dmi)
+		return;
+
+	if (secure_data || (size > DM_IOCTL_CACHE_MAX_SIZE) ||
+	    (size <= cache->spare_size)) {
+		_wipe_free(dmi, size);
+		return;
+	}
+
+	if (!cache->key_set) {
+		pthread_once(&_ioctl_cache_once, _ioctl_cache_key_create);
+		if (_ioctl_cache_key_ok &&
+		    !pthread_setspecific(_ioctl_cache_key, cache))
+			cache->key_set = 1;
+	}
+
+	/* Without a destructor the spare would leak on thread exit */
+	if (!cache->key_set || !_ioctl_cache_key_ok) {
+		_wipe_free(dmi, size);
+		return;
+	}
+
+	dm_free(cache->spare);
+	cache->spare = dmi;
+	cache->spare_size = size;
+}
+
+unsigned dm_ioctl_buffer_doublings(int type)
+{
+	if ((type < 0) || (type >= DM_IOCTL_CACHE_TYPES))
+		return 0;
+
+	return _ioctl_cache.doublings[type];
+}
+
+int dm_ioctl_buffer_grow(int type)
+{
+	if ((type < 0) || (type >= DM_IOCTL_CACHE_TYPES) ||
+	    (_ioctl_cache.doublings[type] >= DM_IOCTL_BUFFER_MAX_DOUBLINGS))
+		return 0;
+
+	_ioctl_cache.doublings[type]++;
+
+	return 1;
+}
+
+void dm_ioctl_cache_exit(void)
+{
+	_ioctl_cache_release(&_ioctl_cache);
+	_ioctl_cache_key_delete();
+}
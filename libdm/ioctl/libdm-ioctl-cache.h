@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of the device-mapper userspace tools.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LIB_DMIOCTL_CACHE_H
+#define LIB_DMIOCTL_CACHE_H
+
+#include <stddef.h>
+
+struct dm_ioctl;
+
+/* Largest ioctl buffer kept for reuse by a thread */
+#define DM_IOCTL_CACHE_MAX_SIZE (1024 * 1024)
+
+/* Max ioctl buffer: 16KB << 16 = 1GB */
+#define DM_IOCTL_BUFFER_MAX_DOUBLINGS 16
+
+/*
+ * Zeroed ioctl buffer of at least len bytes, the thread's spare buffer
+ * if it is large enough.  The allocated size is returned in size.
+ */
+struct dm_ioctl *dm_ioctl_buffer_alloc(size_t len, size_t *size);
+
+/*
+ * Return a buffer from dm_ioctl_buffer_alloc() to the thread's cache.
+ * Buffers of tasks with secure data are wiped and never cached.
+ */
+void dm_ioctl_buffer_free(struct dm_ioctl *dmi, size_t size, int secure_data);
+
+/* Double the buffer size for task type, 0 once the maximum is reached */
+int dm_ioctl_buffer_grow(int type);
+
+/* Number of doublings of the buffer size for task type */
+unsigned dm_ioctl_buffer_doublings(int type);
+
+/* Free the calling thread's spare buffer and stop caching buffers */
+void dm_ioctl_cache_exit(void);
+
+#endif
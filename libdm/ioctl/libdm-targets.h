@@ -19,6 +19,7 @@
 #include "libdm/libdevmapper.h"
 
 #include <inttypes.h>
+#include <pthread.h>
 #include <sys/types.h>
 
 struct dm_ioctl;
@@ -52,6 +53,7 @@ struct dm_task {
 	union dmi_u {
 		struct dm_ioctl *v4;
 	} dmi;
+	size_t dmi_size;	/* Allocated size of dmi */
 	char *newname;
 	char *message;
 	char *geometry;
@@ -94,6 +96,12 @@ struct cmd_data {
 /* Execute a single DM ioctl (no retry, no logging). */
 int dm_ioctl_exec(int fd, struct dm_task *dmt, struct dm_ioctl *dmi);
 
+/*
+ * While set, the calling thread unlocks the mutex for the duration
+ * of the ioctl syscall, see dm_task_batch worker threads.
+ */
+void dm_ioctl_set_unlock_mutex(pthread_mutex_t *mutex);
+
 int dm_check_version(void);
 uint64_t dm_task_get_existing_table_size(const struct dm_task *dmt);
 
@@ -1483,6 +1483,40 @@ int dm_task_get_errno(struct dm_task *dmt);
  */
 void dm_task_update_nodes(void);
 
+/*
+ * Task batches: run the same read-only query (DM_DEVICE_INFO,
+ * DM_DEVICE_DEPS, DM_DEVICE_STATUS or DM_DEVICE_TABLE) for many devices
+ * with one library call.
+ *
+ * Each device is queried by the name, uuid or device number it was
+ * added with.  The per-device ioctls are issued by up to
+ * 'threads' worker threads set with dm_task_batch_set_threads()
+ * (default 1, the calling thread only).  The optional prepare_fn is
+ * called for each task before it runs to apply further task options,
+ * e.g. dm_task_no_open_count().
+ *
+ * dm_task_batch_run() returns 0 if any task failed.  Afterwards
+ * dm_task_batch_get_task() returns the completed task for each device
+ * in the order they were added, or NULL if its ioctl failed.  Use the
+ * usual dm_task_get_info(), dm_get_next_target() etc. on it; the tasks
+ * are owned and destroyed by the batch.  A batch can only be run once.
+ */
+struct dm_task_batch;
+typedef int (*dm_task_batch_prepare_fn)(struct dm_task *dmt, void *context);
+
+struct dm_task_batch *dm_task_batch_create(int type);
+void dm_task_batch_destroy(struct dm_task_batch *batch);
+int dm_task_batch_add_name(struct dm_task_batch *batch, const char *name);
+int dm_task_batch_add_uuid(struct dm_task_batch *batch, const char *uuid);
+int dm_task_batch_add_devno(struct dm_task_batch *batch, uint32_t major, uint32_t minor);
+void dm_task_batch_set_threads(struct dm_task_batch *batch, unsigned threads);
+void dm_task_batch_set_prepare_fn(struct dm_task_batch *batch,
+				  dm_task_batch_prepare_fn prepare_fn,
+				  void *context);
+int dm_task_batch_run(struct dm_task_batch *batch);
+unsigned dm_task_batch_get_count(const struct dm_task_batch *batch);
+struct dm_task *dm_task_batch_get_task(const struct dm_task_batch *batch, unsigned idx);
+
 /*
  * Mangling support
  *
@@ -1595,6 +1629,12 @@ void dm_lib_exit(void) __attribute__((destructor));
 /* An optimisation for clients making repeated calls involving dm ioctls */
 void dm_hold_control_dev(int hold_open);
 
+/*
+ * Total number of DM ioctls issued by the library in this process.
+ * Intended for performance accounting by library users.
+ */
+uint64_t dm_lib_ioctl_count(void);
+
 /*
  * Use NULL for all devices.
  */
@@ -2461,6 +2501,20 @@ void *dm_pool_alloc_aligned(struct dm_pool *p, size_t s, unsigned alignment)
 void dm_pool_empty(struct dm_pool *p);
 void dm_pool_free(struct dm_pool *p, void *ptr);
 
+/*
+ * Chunks freed by dm_pool_destroy() and dm_pool_free() are kept in a
+ * small per-thread cache and reused when any pool of the same thread
+ * grows.  These counters describe the calling thread's cache.
+ */
+struct dm_pool_cache_stats {
+	uint64_t hits;		/* chunks reused from the cache */
+	uint64_t misses;	/* cacheable chunks allocated with malloc */
+	uint64_t recycled;	/* chunks returned to the cache */
+	uint64_t overflows;	/* chunks freed because the cache was full */
+	uint64_t cached_bytes;	/* bytes currently held by the cache */
+};
+void dm_pool_get_cache_stats(struct dm_pool_cache_stats *stats);
+
 /*
  * To aid debugging, a pool can be locked. Any modifications made
  * to the content of the pool while it is locked can be detected.
@@ -2604,6 +2658,11 @@ struct dm_hash_node;
 
 typedef void (*dm_hash_iterate_fn) (void *data);
 
+/*
+ * size_hint is only the initial number of slots, the table grows
+ * when it holds more entries than slots.  Do not insert while
+ * iterating with dm_hash_get_first/next().
+ */
 struct dm_hash_table *dm_hash_create(unsigned size_hint)
 	__attribute__((__warn_unused_result__));
 void dm_hash_destroy(struct dm_hash_table *t);
@@ -3145,6 +3204,22 @@ struct dm_regex;
 struct dm_regex *dm_regex_create(struct dm_pool *mem, const char * const *patterns,
 				 unsigned num_patterns);
 
+/*
+ * Same as dm_regex_create() but with the fully calculated dfa kept
+ * in cache_file.  When cache_file was saved for the same patterns,
+ * it is mapped into memory and used for matching without building
+ * the dfa.  Otherwise the dfa is built and saved into cache_file.
+ * Failure to read or write cache_file is not an error.
+ * dm_regex_destroy() must be called before mem is released.
+ */
+struct dm_regex *dm_regex_create_cached(struct dm_pool *mem, const char * const *patterns,
+					unsigned num_patterns, const char *cache_file);
+
+/*
+ * Release resources of regex not allocated from its pool.
+ */
+void dm_regex_destroy(struct dm_regex *regex);
+
 /*
  * Match string s against the patterns.
  * Returns the index of the highest pattern in the array that matches,
@@ -3615,6 +3690,41 @@ uint64_t dm_stats_get_total_read_nsecs(const struct dm_stats *dms,
 uint64_t dm_stats_get_total_write_nsecs(const struct dm_stats *dms,
 					uint64_t region_id, uint64_t area_id);
 
+/*
+ * Incremental (delta) polling
+ *
+ * A dm_stats_delta handle keeps the previous sample of the counters of
+ * each region it is updated with, so that a polling program handling
+ * regions with many areas can restrict its work to the areas that
+ * changed between two dm_stats_populate() calls.
+ *
+ * dm_stats_delta_update() stores the counters of region_id from dms as
+ * the newest sample and sets *area_ids to an array of the *nr_areas
+ * area_ids whose counters differ from the previous sample. The first
+ * update of a region, or an update after the number of areas of the
+ * region changed, reports every area. The array remains valid until the
+ * next update of the same region or dm_stats_delta_destroy().
+ *
+ * dm_stats_delta_get_counter() returns the difference of a counter
+ * between the two most recent samples (or the value of the only sample).
+ * This is only meaningful for monotonic counters read without clearing
+ * them (i.e. not for io_in_progress).
+ *
+ * Returns 1 on success and 0 on error.
+ */
+struct dm_stats_delta;
+
+struct dm_stats_delta *dm_stats_delta_create(void);
+void dm_stats_delta_destroy(struct dm_stats_delta *delta);
+
+int dm_stats_delta_update(struct dm_stats_delta *delta,
+			  const struct dm_stats *dms, uint64_t region_id,
+			  const uint64_t **area_ids, uint64_t *nr_areas);
+
+uint64_t dm_stats_delta_get_counter(const struct dm_stats_delta *delta,
+				    dm_stats_counter_t counter,
+				    uint64_t region_id, uint64_t area_id);
+
 /*
  * Derived statistics access methods
  *
@@ -3829,6 +3939,102 @@ uint64_t dm_histogram_get_sum(const struct dm_histogram *dmh);
 const char *dm_histogram_to_string(const struct dm_histogram *dmh, int bin,
 				   int width, int flags);
 
+/*
+ * Stats recorder
+ *
+ * A dm_stats_record is a fixed size ring buffer file holding a time
+ * series of samples. Each sample stores, for every series (a region or
+ * group of some device), the DM_STATS_NR_COUNTERS counter values and
+ * histogram bin counts of one sampling interval. Once the ring is full
+ * the oldest sample is overwritten.
+ *
+ * Writer:
+ *
+ * dm_stats_record_create() creates the file at path with space for
+ * nr_samples samples of nr_series series with up to nr_bins histogram
+ * bins each, or reopens an existing file with the same layout to
+ * continue its history. A file with a different layout is recreated
+ * and its samples discarded. The writer holds an exclusive flock() on
+ * the file until dm_stats_record_close(), so a second writer fails.
+ *
+ * dm_stats_record_set_series() names a series, sets its id (a region_id
+ * or a group_id with DM_STATS_WALK_GROUP set) and copies the histogram
+ * bin boundaries from bounds (may be NULL).
+ *
+ * dm_stats_record_sample() stores the aggregate counters and histogram
+ * of region or group id of dms in the current sample. The values are
+ * those read by the last dm_stats_populate(), which clears the kernel
+ * counters, so each sample holds the activity of one interval.
+ * dm_stats_record_set_values() stores values obtained by other means.
+ *
+ * dm_stats_record_commit() timestamps the current sample (nanoseconds
+ * since the epoch) and makes it visible to readers.
+ *
+ * Reader:
+ *
+ * dm_stats_record_open() maps an existing file read-only; it may be
+ * used while a writer is appending to the same file.
+ *
+ * dm_stats_record_get_counter() returns the sum of a counter over the
+ * retained samples with a timestamp in [start_ns, end_ns] (end_ns of 0
+ * means no upper limit).
+ *
+ * dm_stats_record_get_percentile() returns the estimated value at the
+ * given percentile (0, 100] of the histogram accumulated over the same
+ * window, interpolating linearly within a bin. Values that fall into
+ * the final, unbounded bin are reported as its lower bound. A window
+ * without any I/O returns 0.
+ *
+ * dm_stats_record_close() releases a handle from either side.
+ */
+struct dm_stats_record;
+
+struct dm_stats_record *dm_stats_record_create(const char *path,
+					       unsigned nr_series,
+					       unsigned nr_bins,
+					       uint64_t nr_samples);
+
+int dm_stats_record_set_series(struct dm_stats_record *rec, unsigned series,
+			       const char *name, uint64_t id,
+			       const struct dm_histogram *bounds);
+
+int dm_stats_record_sample(struct dm_stats_record *rec, unsigned series,
+			   const struct dm_stats *dms, uint64_t id);
+
+int dm_stats_record_set_values(struct dm_stats_record *rec, unsigned series,
+			       const uint64_t *counters,
+			       const uint64_t *bins, unsigned nr_bins);
+
+int dm_stats_record_commit(struct dm_stats_record *rec, uint64_t timestamp_ns,
+			   uint64_t interval_ns);
+
+struct dm_stats_record *dm_stats_record_open(const char *path);
+
+void dm_stats_record_close(struct dm_stats_record *rec);
+
+unsigned dm_stats_record_get_nr_series(const struct dm_stats_record *rec);
+
+const char *dm_stats_record_get_series_name(const struct dm_stats_record *rec,
+					    unsigned series);
+
+uint64_t dm_stats_record_get_series_id(const struct dm_stats_record *rec,
+				       unsigned series);
+
+/*
+ * Number of samples currently retained in the ring.
+ */
+uint64_t dm_stats_record_get_nr_samples(const struct dm_stats_record *rec);
+
+int dm_stats_record_get_counter(const struct dm_stats_record *rec,
+				unsigned series, dm_stats_counter_t counter,
+				uint64_t start_ns, uint64_t end_ns,
+				uint64_t *value);
+
+int dm_stats_record_get_percentile(const struct dm_stats_record *rec,
+				   unsigned series, double percentile,
+				   uint64_t start_ns, uint64_t end_ns,
+				   uint64_t *value);
+
 /*************************
  * config file parse/print
  *************************/
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of the device-mapper userspace tools.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Batches of read-only queries (info, status, table, deps) for many
+ * devices.
+ *
+ * Each device is queried by the name, uuid or device number it was
+ * added with.  The per-device ioctls are issued by a small pool of
+ * worker threads.  All library code runs under _batch_mutex, which is
+ * released only while a worker waits in the ioctl syscall, so only the
+ * kernel latency overlaps.
+ */
+
+#include "libdm/misc/dmlib.h"
+#include "libdm/ioctl/libdm-targets.h"
+
+/* Upper limit for dm_task_batch_set_threads() */
+#define DM_TASK_BATCH_MAX_THREADS 64
+#define DM_TASK_BATCH_DEFAULT_THREADS 1
+
+struct batch_entry {
+	const char *name;
+	const char *uuid;
+	uint32_t major;
+	uint32_t minor;
+	int has_devno;
+	struct dm_task *dmt;
+};
+
+struct dm_task_batch {
+	struct dm_pool *mem;
+	int type;
+	unsigned threads;
+	unsigned count;
+	unsigned alloc;
+	unsigned next;		/* Next entry to run, under _batch_mutex */
+	int failed;
+	struct batch_entry *entries;
+	dm_task_batch_prepare_fn prepare_fn;
+	void *prepare_context;
+};
+
+static pthread_mutex_t _batch_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+struct dm_task_batch *dm_task_batch_create(int type)
+{
+	struct dm_task_batch *batch;
+	struct dm_pool *mem;
+
+	switch (type) {
+	case DM_DEVICE_INFO:
+	case DM_DEVICE_DEPS:
+	case DM_DEVICE_STATUS:
+	case DM_DEVICE_TABLE:
+		break;
+	default:
+		log_error(INTERNAL_ERROR "Unsupported task type %d for batch.", type);
+		return NULL;
+	}
+
+	if (!(mem = dm_pool_create("task_batch", 1024)))
+		return_NULL;
+
+	if (!(batch = dm_pool_zalloc(mem, sizeof(*batch)))) {
+		dm_pool_destroy(mem);
+		return_NULL;
+	}
+
+	batch->mem = mem;
+	batch->type = type;
+	batch->threads = DM_TASK_BATCH_DEFAULT_THREADS;
+
+	return batch;
+}
+
+void dm_task_batch_destroy(struct dm_task_batch *batch)
+{
+	unsigned i;
+
+	if (!batch)
+		return;
+
+	for (i = 0; i < batch->count; i++)
+		if (batch->entries[i].dmt)
+			dm_task_destroy(batch->entries[i].dmt);
+
+	dm_free(batch->entries);
+	dm_pool_destroy(batch->mem);
+}
+
+void dm_task_batch_set_threads(struct dm_task_batch *batch, unsigned threads)
+{
+	if (!threads)
+		threads = 1;
+
+	batch->threads = (threads > DM_TASK_BATCH_MAX_THREADS) ?
+		DM_TASK_BATCH_MAX_THREADS : threads;
+}
+
+void dm_task_batch_set_prepare_fn(struct dm_task_batch *batch,
+				  dm_task_batch_prepare_fn prepare_fn,
+				  void *context)
+{
+	batch->prepare_fn = prepare_fn;
+	batch->prepare_context = context;
+}
+
+static struct batch_entry *_batch_add(struct dm_task_batch *batch)
+{
+	struct batch_entry *entries;
+	unsigned alloc;
+
+	if (batch->next) {
+		log_error(INTERNAL_ERROR "Cannot add devices to batch that already ran.");
+		return NULL;
+	}
+
+	if (batch->count == batch->alloc) {
+		alloc = batch->alloc ? batch->alloc * 2 : 16;
+		if (!(entries = dm_realloc(batch->entries, alloc * sizeof(*entries))))
+			return_NULL;
+		batch->entries = entries;
+		batch->alloc = alloc;
+	}
+
+	entries = &batch->entries[batch->count++];
+	memset(entries, 0, sizeof(*entries));
+
+	return entries;
+}
+
+int dm_task_batch_add_name(struct dm_task_batch *batch, const char *name)
+{
+	struct batch_entry *entry;
+
+	if (!(entry = _batch_add(batch)))
+		return_0;
+
+	if (!(entry->name = dm_pool_strdup(batch->mem, name))) {
+		batch->count--;
+		return_0;
+	}
+
+	return 1;
+}
+
+int dm_task_batch_add_uuid(struct dm_task_batch *batch, const char *uuid)
+{
+	struct batch_entry *entry;
+
+	if (!(entry = _batch_add(batch)))
+		return_0;
+
+	if (!(entry->uuid = dm_pool_strdup(batch->mem, uuid))) {
+		batch->count--;
+		return_0;
+	}
+
+	return 1;
+}
+
+int dm_task_batch_add_devno(struct dm_task_batch *batch, uint32_t major, uint32_t minor)
+{
+	struct batch_entry *entry;
+
+	if (!(entry = _batch_add(batch)))
+		return_0;
+
+	entry->major = major;
+	entry->minor = minor;
+	entry->has_devno = 1;
+
+	return 1;
+}
+
+unsigned dm_task_batch_get_count(const struct dm_task_batch *batch)
+{
+	return batch->count;
+}
+
+struct dm_task *dm_task_batch_get_task(const struct dm_task_batch *batch, unsigned idx)
+{
+	if (idx >= batch->count)
+		return NULL;
+
+	return batch->entries[idx].dmt;
+}
+
+static struct dm_task *_batch_task_create(struct dm_task_batch *batch,
+					  const struct batch_entry *entry)
+{
+	struct dm_task *dmt;
+
+	if (!(dmt = dm_task_create(batch->type)))
+		return_NULL;
+
+	if (entry->has_devno) {
+		if (!dm_task_set_major_minor(dmt, (int) entry->major, (int) entry->minor, 0))
+			goto_bad;
+	} else if (entry->name) {
+		if (!dm_task_set_name(dmt, entry->name))
+			goto_bad;
+	} else if (!dm_task_set_uuid(dmt, entry->uuid))
+		goto_bad;
+
+	if (batch->prepare_fn && !batch->prepare_fn(dmt, batch->prepare_context))
+		goto_bad;
+
+	return dmt;
+
+bad:
+	dm_task_destroy(dmt);
+	return NULL;
+}
+
+static void *_batch_worker(void *arg)
+{
+	struct dm_task_batch *batch = arg;
+	struct batch_entry *entry;
+
+	pthread_mutex_lock(&_batch_mutex);
+	dm_ioctl_set_unlock_mutex(&_batch_mutex);
+
+	while (batch->next < batch->count) {
+		entry = &batch->entries[batch->next++];
+		if (!entry->dmt)
+			continue;
+		if (!dm_task_run(entry->dmt)) {
+			dm_task_destroy(entry->dmt);
+			entry->dmt = NULL;
+			batch->failed = 1;
+		}
+	}
+
+	dm_ioctl_set_unlock_mutex(NULL);
+	pthread_mutex_unlock(&_batch_mutex);
+
+	return NULL;
+}
+
+int dm_task_batch_run(struct dm_task_batch *batch)
+{
+	pthread_t threads[DM_TASK_BATCH_MAX_THREADS];
+	unsigned i, started = 0, nr_threads;
+
+	if (batch->next) {
+		log_error(INTERNAL_ERROR "Task batch already ran.");
+		return 0;
+	}
+
+	if (!batch->count)
+		return 1;
+
+	for (i = 0; i < batch->count; i++)
+		if (!(batch->entries[i].dmt = _batch_task_create(batch, &batch->entries[i])))
+			batch->failed = 1;
+
+	nr_threads = (batch->threads < batch->count) ? batch->threads : batch->count;
+
+	log_debug_activation("Running batch of %u tasks with %u threads.",
+			     batch->count, nr_threads);
+
+	/* Calling thread is one of the workers */
+	for (i = 1; i < nr_threads; i++) {
+		if (pthread_create(&threads[started], NULL, _batch_worker, batch)) {
+			log_debug_activation("Failed to create batch worker thread.");
+			break;
+		}
+		started++;
+	}
+
+	(void) _batch_worker(batch);
+
+	for (i = 0; i < started; i++)
+		if (pthread_join(threads[i], NULL))
+			log_debug_activation("Failed to join batch worker thread.");
+
+	return !batch->failed;
+}
@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2016 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of the device-mapper userspace tools.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libdm/misc/dmlib.h"
+#include "libdm/libdm-stats.h"
+
+/*
+ * Parse a histogram specification returned by the kernel in a
+ * @stats_list response.
+ */
+int stats_parse_histogram_spec(struct dm_stats *dms,
+			       struct dm_stats_region *region,
+			       char *histogram)
+{
+	const char valid_chars[] = "0123456789,";
+	uint64_t scale = region->timescale, this_val = 0;
+	struct dm_pool *mem = dms->hist_mem;
+	struct dm_histogram_bin cur;
+	struct dm_histogram hist = { 0 };
+	int nr_bins = 1;
+	const char *c, *v, *val_start;
+	char *p, *endptr = NULL;
+
+	/* Advance past "histogram:". */
+	histogram = strchr(histogram, ':');
+	if (!histogram) {
+		log_error("Could not parse histogram description.");
+		return 0;
+	}
+	histogram++;
+
+	/* @stats_list rows are newline terminated. */
+	if ((p = strchr(histogram, '\n')))
+		*p = '\0';
+
+	if (!dm_pool_begin_object(mem, sizeof(cur)))
+		return_0;
+
+	hist.nr_bins = 0; /* fix later */
+	hist.region = region;
+	hist.dms = dms;
+
+	if (!dm_pool_grow_object(mem, &hist, sizeof(hist)))
+		goto_bad;
+
+	c = histogram;
+	do {
+		for (v = valid_chars; *v; v++)
+			if (*c == *v)
+				break;
+		if (!*v) {
+			stack;
+			goto badchar;
+		}
+
+		if (*c == ',') {
+			log_error("Invalid histogram description: %s",
+				  histogram);
+			goto bad;
+		} else {
+			val_start = c;
+			endptr = NULL;
+
+			errno = 0;
+			this_val = strtoull(val_start, &endptr, 10);
+			if (errno || !endptr) {
+				log_error("Could not parse histogram boundary.");
+				goto bad;
+			}
+
+			c = endptr; /* Advance to units, comma, or end. */
+
+			if (*c == ',')
+				c++;
+			else if (*c || (*c == ' ')) { /* Expected ',' or NULL. */
+				stack;
+				goto badchar;
+			}
+
+			if (*c == ',')
+				c++;
+
+			cur.upper = scale * this_val;
+			cur.count = 0;
+
+			if (!dm_pool_grow_object(mem, &cur, sizeof(cur)))
+				goto_bad;
+
+			nr_bins++;
+		}
+	} while (*c && (*c != ' '));
+
+	/* final upper bound. */
+	cur.upper = UINT64_MAX;
+	if (!dm_pool_grow_object(mem, &cur, sizeof(cur)))
+		goto_bad;
+
+	region->bounds = dm_pool_end_object(mem);
+
+	if (!region->bounds)
+		return_0;
+
+	region->bounds->nr_bins = nr_bins;
+
+	log_debug("Added region histogram spec with %d entries.", nr_bins);
+	return 1;
+
+badchar:
+	log_error("Invalid character in histogram: '%c' (0x%x).", *c, (unsigned char) *c);
+bad:
+	dm_pool_abandon_object(mem);
+	return 0;
+}
+
+/*
+ * Parse an unsigned decimal value at *c and advance *c past it.
+ * Returns 0 if no digit is present or the value does not fit 64 bits.
+ */
+int stats_parse_u64(const char **c, uint64_t *val)
+{
+	const char *p = *c;
+	uint64_t v = 0;
+	unsigned d;
+
+	if ((d = (unsigned)(*p - '0')) > 9)
+		return 0;
+
+	do {
+		if ((v >= UINT64_MAX / 10) &&
+		    ((v > UINT64_MAX / 10) || (d > UINT64_MAX % 10)))
+			return 0;
+		v = v * 10 + d;
+	} while ((d = (unsigned)(*++p - '0')) <= 9);
+
+	*val = v;
+	*c = p;
+
+	return 1;
+}
+
+/*
+ * Parse histogram data returned from a @stats_print operation.
+ */
+static int _stats_parse_histogram(struct dm_pool *mem, const char *hist_str,
+				  struct dm_histogram **histogram,
+				  struct dm_stats_region *region)
+{
+	struct dm_histogram *bounds = region->bounds;
+	struct dm_histogram hist = {
+		.nr_bins = region->bounds->nr_bins
+	};
+	const char *c = hist_str;
+	struct dm_histogram_bin cur;
+	uint64_t sum = 0, this_val;
+	int bin = 0;
+
+	if (!dm_pool_begin_object(mem, sizeof(cur)))
+		return_0;
+
+	if (!dm_pool_grow_object(mem, &hist, sizeof(hist)))
+		goto_bad;
+
+	do {
+		if (!stats_parse_u64(&c, &this_val))
+			goto badchar;
+
+		if (*c == ':')
+			c++;
+		else if (*c && (*c != '\n'))
+			/* Expected ':', '\n', or NULL. */
+			goto badchar;
+
+		if (bin >= hist.nr_bins) {
+			log_error("Too many histogram bins in data.");
+			goto bad;
+		}
+
+		cur.upper = bounds->bins[bin].upper;
+		cur.count = this_val;
+		sum += this_val;
+
+		if (!dm_pool_grow_object(mem, &cur, sizeof(cur)))
+			goto_bad;
+
+		bin++;
+	} while (*c && (*c != '\n'));
+
+	if (bin < hist.nr_bins) {
+		log_error("Too few histogram bins in data.");
+		goto bad;
+	}
+
+	log_debug("Added region histogram data with %d entries.", hist.nr_bins);
+
+	*histogram = dm_pool_end_object(mem);
+	(*histogram)->sum = sum;
+
+	return 1;
+
+badchar:
+	log_error("Invalid character in histogram data: '%c' (0x%x).", *c, (unsigned char) *c);
+bad:
+	dm_pool_abandon_object(mem);
+	return 0;
+}
+
+const size_t stats_counter_offsets[DM_STATS_NR_COUNTERS] = {
+	offsetof(struct dm_stats_counters, reads),
+	offsetof(struct dm_stats_counters, reads_merged),
+	offsetof(struct dm_stats_counters, read_sectors),
+	offsetof(struct dm_stats_counters, read_nsecs),
+	offsetof(struct dm_stats_counters, writes),
+	offsetof(struct dm_stats_counters, writes_merged),
+	offsetof(struct dm_stats_counters, write_sectors),
+	offsetof(struct dm_stats_counters, write_nsecs),
+	offsetof(struct dm_stats_counters, io_in_progress),
+	offsetof(struct dm_stats_counters, io_nsecs),
+	offsetof(struct dm_stats_counters, weighted_io_nsecs),
+	offsetof(struct dm_stats_counters, total_read_nsecs),
+	offsetof(struct dm_stats_counters, total_write_nsecs),
+};
+
+/* Parse the areas of a region from a @stats_print response. */
+int stats_parse_region(struct dm_stats *dms, const char *resp,
+		       struct dm_stats_region *region,
+		       uint64_t timescale)
+{
+	struct dm_histogram *hist = NULL;
+	struct dm_pool *mem = dms->mem;
+	struct dm_stats_counters cur;
+	uint64_t start = 0, len = 0;
+	const char *c, *row, *eol, *hist_str;
+	int i;
+
+	if (!resp) {
+		log_error("Could not parse empty @stats_print response.");
+		return 0;
+	}
+
+	region->start = UINT64_MAX;
+
+	if (!dm_pool_begin_object(mem, 512))
+		return_0;
+
+	/*
+	 * Output format for each step-sized area of a region:
+	 *
+	 * <start_sector>+<length> counters
+	 *
+	 * The first 11 counters have the same meaning as
+	 * /sys/block/ * /stat or /proc/diskstats.
+	 *
+	 * Please refer to Documentation/iostats.txt for details.
+	 *
+	 * 1. the number of reads completed
+	 * 2. the number of reads merged
+	 * 3. the number of sectors read
+	 * 4. the number of milliseconds spent reading
+	 * 5. the number of writes completed
+	 * 6. the number of writes merged
+	 * 7. the number of sectors written
+	 * 8. the number of milliseconds spent writing
+	 * 9. the number of I/Os currently in progress
+	 * 10. the number of milliseconds spent doing I/Os
+	 * 11. the weighted number of milliseconds spent doing I/Os
+	 *
+	 * Additional counters:
+	 * 12. the total time spent reading in milliseconds
+	 * 13. the total time spent writing in milliseconds
+	 *
+	 * Regions of files mapped by dm_stats_create_regions_from_fd()
+	 * may have tens of thousands of areas, so the response is parsed
+	 * in place in a single pass.
+	*/
+	for (c = resp; *c; c = *eol ? eol + 1 : eol) {
+		row = c;
+
+		if (!stats_parse_u64(&c, &start) || (*c++ != '+') ||
+		    !stats_parse_u64(&c, &len))
+			goto badrow;
+
+		for (i = 0; i < DM_STATS_NR_COUNTERS; i++) {
+			while (*c == ' ')
+				c++;
+			if (!stats_parse_u64(&c, &stats_counter_field(&cur, i)))
+				goto badrow;
+		}
+
+		if (!(eol = strchr(c, '\n')))
+			eol = c + strlen(c);
+
+		/* scale time values up if needed */
+		if (timescale != 1) {
+			cur.read_nsecs *= timescale;
+			cur.write_nsecs *= timescale;
+			cur.io_nsecs *= timescale;
+			cur.weighted_io_nsecs *= timescale;
+			cur.total_read_nsecs *= timescale;
+			cur.total_write_nsecs *= timescale;
+		}
+
+		if (region->bounds) {
+			/* Find first histogram separator. */
+			if (!(hist_str = memchr(c, ':', eol - c))) {
+				log_error("Could not parse histogram value.");
+				goto bad;
+			}
+			/* Find space preceding histogram. */
+			while ((hist_str > row) && (*(hist_str - 1) != ' '))
+				hist_str--;
+
+			/* Use a separate pool for histogram objects since we
+			 * are growing the area table and each area's histogram
+			 * table simultaneously.
+			 */
+			if (!_stats_parse_histogram(dms->hist_mem, hist_str,
+						    &hist, region))
+				goto_bad;
+			hist->dms = dms;
+			hist->region = region;
+		}
+
+		cur.histogram = hist;
+
+		if (!dm_pool_grow_object(mem, &cur, sizeof(cur)))
+			goto_bad;
+
+		if (region->start == UINT64_MAX) {
+			region->start = start;
+			region->step = len; /* area size is always uniform. */
+		}
+	}
+
+	if (region->start == UINT64_MAX)
+		/* no area data read from @stats_print */
+		goto bad;
+
+	region->len = (start + len) - region->start;
+	region->timescale = timescale;
+	region->counters = dm_pool_end_object(mem);
+
+	return 1;
+
+badrow:
+	log_error("Could not parse @stats_print row.");
+bad:
+	dm_pool_abandon_object(mem);
+
+	return 0;
+}
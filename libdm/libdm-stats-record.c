@@ -0,0 +1,586 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of the device-mapper userspace tools.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Time series of dm_stats counters kept in a memory mapped ring buffer
+ * file.
+ *
+ * File layout (native endian, all fields 64 bit aligned):
+ *
+ *   struct _record_header
+ *   struct _record_series * nr_series (each followed by nr_bins bounds)
+ *   <padding to page size>
+ *   struct _record_slot * nr_slots
+ *
+ * Every slot holds one sample: for each series DM_STATS_NR_COUNTERS
+ * counter values followed by nr_bins histogram bin counts. The writer
+ * invalidates a slot (seq = 0) before filling it and publishes it by
+ * storing its sequence number, so a reader mapping the same file can
+ * detect and skip slots that are rewritten while it reads them.
+ */
+
+#include "libdm/misc/dmlib.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <math.h> /* ceil() */
+
+#define RECORD_MAGIC "DMSTREC1"
+#define RECORD_VERSION 1
+#define RECORD_NAME_LEN 128
+
+struct _record_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t nr_series;
+	uint32_t nr_bins;	/* histogram bins stored per series */
+	uint32_t slot_size;
+	uint64_t nr_slots;
+	uint64_t head;		/* number of samples committed */
+	uint64_t data_offset;
+};
+
+struct _record_series {
+	char name[RECORD_NAME_LEN];
+	uint64_t id;		/* region_id, or group_id | DM_STATS_WALK_GROUP */
+	uint64_t nr_bins;	/* bins used by this series */
+	uint64_t bounds[];	/* upper bound of each bin */
+};
+
+struct _record_slot {
+	uint64_t seq;		/* sample number + 1, 0 while being written */
+	uint64_t timestamp_ns;
+	uint64_t interval_ns;
+	uint64_t values[];
+};
+
+struct dm_stats_record {
+	int fd;
+	int writable;
+	size_t size;
+	char *map;
+	struct _record_header *hdr;
+	struct _record_slot *pending;	/* slot filled by the writer */
+};
+
+static size_t _series_size(uint32_t nr_bins)
+{
+	return sizeof(struct _record_series) + nr_bins * sizeof(uint64_t);
+}
+
+static size_t _series_values(const struct _record_header *hdr)
+{
+	return DM_STATS_NR_COUNTERS + hdr->nr_bins;
+}
+
+static struct _record_series *_series(const struct dm_stats_record *rec,
+				      unsigned series)
+{
+	return (struct _record_series *)(rec->map + sizeof(*rec->hdr) +
+					 series * _series_size(rec->hdr->nr_bins));
+}
+
+static struct _record_slot *_slot(const struct dm_stats_record *rec,
+				  uint64_t sample)
+{
+	return (struct _record_slot *)(rec->map + rec->hdr->data_offset +
+				       (sample % rec->hdr->nr_slots) *
+				       rec->hdr->slot_size);
+}
+
+static void _record_free(struct dm_stats_record *rec)
+{
+	if (rec->map && munmap(rec->map, rec->size))
+		log_sys_debug("munmap", "stats record");
+
+	if ((rec->fd >= 0) && close(rec->fd))
+		log_sys_debug("close", "stats record");
+
+	dm_free(rec);
+}
+
+static struct dm_stats_record *_record_map(const char *path, int writable)
+{
+	struct dm_stats_record *rec;
+	const struct _record_header *hdr;
+	struct stat st;
+
+	if (!(rec = dm_zalloc(sizeof(*rec)))) {
+		log_error("Could not allocate stats record handle.");
+		return NULL;
+	}
+
+	rec->writable = writable;
+
+	if ((rec->fd = open(path, (writable ? O_RDWR | O_CREAT : O_RDONLY) |
+			    O_CLOEXEC, 0644)) < 0) {
+		log_sys_error("open", path);
+		goto bad;
+	}
+
+	/* Concurrent writers would interleave their samples. */
+	if (writable && flock(rec->fd, LOCK_EX | LOCK_NB)) {
+		if (errno == EWOULDBLOCK)
+			log_error("Stats record file %s is in use by another writer.",
+				  path);
+		else
+			log_sys_error("flock", path);
+		goto bad;
+	}
+
+	if (fstat(rec->fd, &st)) {
+		log_sys_error("fstat", path);
+		goto bad;
+	}
+
+	/* New file for the writer. */
+	if (!st.st_size && writable)
+		return rec;
+
+	if ((size_t) st.st_size < sizeof(*hdr)) {
+		log_error("Stats record file %s is too short.", path);
+		goto bad;
+	}
+
+	rec->size = (size_t) st.st_size;
+	if ((rec->map = mmap(NULL, rec->size,
+			     writable ? PROT_READ | PROT_WRITE : PROT_READ,
+			     MAP_SHARED, rec->fd, 0)) == MAP_FAILED) {
+		rec->map = NULL;
+		log_sys_error("mmap", path);
+		goto bad;
+	}
+
+	hdr = rec->hdr = (struct _record_header *) rec->map;
+
+	if (memcmp(hdr->magic, RECORD_MAGIC, sizeof(hdr->magic)) ||
+	    (hdr->version != RECORD_VERSION)) {
+		log_error("%s is not a stats record file.", path);
+		goto bad;
+	}
+
+	if (!hdr->nr_slots ||
+	    (hdr->slot_size != sizeof(struct _record_slot) +
+	     hdr->nr_series * _series_values(hdr) * sizeof(uint64_t)) ||
+	    (hdr->data_offset < sizeof(*hdr) +
+	     hdr->nr_series * _series_size(hdr->nr_bins)) ||
+	    (hdr->data_offset > rec->size) ||
+	    (hdr->nr_slots > (rec->size - hdr->data_offset) / hdr->slot_size)) {
+		log_error("Stats record file %s is damaged.", path);
+		goto bad;
+	}
+
+	return rec;
+bad:
+	_record_free(rec);
+
+	return NULL;
+}
+
+struct dm_stats_record *dm_stats_record_create(const char *path,
+					       unsigned nr_series,
+					       unsigned nr_bins,
+					       uint64_t nr_samples)
+{
+	struct dm_stats_record *rec;
+	struct _record_header *hdr;
+	size_t slot_size, data_offset, page_size = (size_t) sysconf(_SC_PAGESIZE);
+
+	if (!nr_series || !nr_samples) {
+		log_error("Stats record needs at least one series and sample.");
+		return NULL;
+	}
+
+	slot_size = sizeof(struct _record_slot) +
+		(size_t) nr_series * (DM_STATS_NR_COUNTERS + nr_bins) * sizeof(uint64_t);
+	data_offset = sizeof(*hdr) + (size_t) nr_series * _series_size(nr_bins);
+	data_offset = (data_offset + page_size - 1) & ~(page_size - 1);
+
+	if ((slot_size > UINT32_MAX) ||
+	    (nr_samples > (SIZE_MAX - data_offset) / slot_size)) {
+		log_error("Stats record of " FMTu64 " samples is too large.",
+			  nr_samples);
+		return NULL;
+	}
+
+	if (!(rec = _record_map(path, 1)))
+		return_NULL;
+
+	/* Keep the history of an existing file with the same layout. */
+	if (rec->map) {
+		hdr = rec->hdr;
+		if ((hdr->nr_series == nr_series) && (hdr->nr_bins == nr_bins) &&
+		    (hdr->nr_slots == nr_samples))
+			return rec;
+
+		log_warn("WARNING: Recreating stats record file %s with a new layout.",
+			 path);
+		if (munmap(rec->map, rec->size))
+			log_sys_debug("munmap", path);
+		rec->map = NULL;
+		rec->hdr = NULL;
+
+		/* Truncating first zeroes the old samples. */
+		if (ftruncate(rec->fd, 0)) {
+			log_sys_error("ftruncate", path);
+			goto bad;
+		}
+	}
+
+	rec->size = data_offset + nr_samples * slot_size;
+	if (ftruncate(rec->fd, (off_t) rec->size)) {
+		log_sys_error("ftruncate", path);
+		goto bad;
+	}
+
+	if ((rec->map = mmap(NULL, rec->size, PROT_READ | PROT_WRITE,
+			     MAP_SHARED, rec->fd, 0)) == MAP_FAILED) {
+		rec->map = NULL;
+		log_sys_error("mmap", path);
+		goto bad;
+	}
+
+	hdr = rec->hdr = (struct _record_header *) rec->map;
+	hdr->version = RECORD_VERSION;
+	hdr->nr_series = nr_series;
+	hdr->nr_bins = nr_bins;
+	hdr->slot_size = (uint32_t) slot_size;
+	hdr->nr_slots = nr_samples;
+	hdr->data_offset = data_offset;
+	memcpy(hdr->magic, RECORD_MAGIC, sizeof(hdr->magic));
+
+	return rec;
+bad:
+	_record_free(rec);
+
+	return NULL;
+}
+
+struct dm_stats_record *dm_stats_record_open(const char *path)
+{
+	return _record_map(path, 0);
+}
+
+void dm_stats_record_close(struct dm_stats_record *rec)
+{
+	if (!rec)
+		return;
+
+	if (rec->writable && rec->map && msync(rec->map, rec->size, MS_ASYNC))
+		log_sys_debug("msync", "stats record");
+
+	_record_free(rec);
+}
+
+static int _record_check_series(const struct dm_stats_record *rec,
+				unsigned series)
+{
+	if (series >= rec->hdr->nr_series) {
+		log_error("Invalid stats record series %u.", series);
+		return 0;
+	}
+
+	return 1;
+}
+
+int dm_stats_record_set_series(struct dm_stats_record *rec, unsigned series,
+			       const char *name, uint64_t id,
+			       const struct dm_histogram *bounds)
+{
+	struct _record_series *s;
+	int bin, nr_bins = bounds ? dm_histogram_get_nr_bins(bounds) : 0;
+
+	if (!rec->writable || !_record_check_series(rec, series))
+		return_0;
+
+	if ((unsigned) nr_bins > rec->hdr->nr_bins) {
+		log_error("Stats record has space for %u histogram bins, not %d.",
+			  rec->hdr->nr_bins, nr_bins);
+		return 0;
+	}
+
+	s = _series(rec, series);
+	memset(s, 0, _series_size(rec->hdr->nr_bins));
+	(void) dm_strncpy(s->name, name, sizeof(s->name));
+	s->id = id;
+	s->nr_bins = (uint64_t) nr_bins;
+	for (bin = 0; bin < nr_bins; bin++)
+		s->bounds[bin] = dm_histogram_get_bin_upper(bounds, bin);
+
+	return 1;
+}
+
+static struct _record_slot *_record_pending(struct dm_stats_record *rec)
+{
+	struct _record_slot *slot;
+
+	if (rec->pending)
+		return rec->pending;
+
+	slot = _slot(rec, rec->hdr->head);
+
+	/* Invalidate the slot for readers before overwriting it. */
+	__atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memset(slot->values, 0, rec->hdr->slot_size - sizeof(*slot));
+
+	return rec->pending = slot;
+}
+
+int dm_stats_record_set_values(struct dm_stats_record *rec, unsigned series,
+			       const uint64_t *counters,
+			       const uint64_t *bins, unsigned nr_bins)
+{
+	uint64_t *values;
+
+	if (!rec->writable || !_record_check_series(rec, series))
+		return_0;
+
+	if (nr_bins > rec->hdr->nr_bins) {
+		log_error("Too many histogram bins for stats record.");
+		return 0;
+	}
+
+	values = _record_pending(rec)->values + series * _series_values(rec->hdr);
+	memcpy(values, counters, DM_STATS_NR_COUNTERS * sizeof(*values));
+	if (nr_bins)
+		memcpy(values + DM_STATS_NR_COUNTERS, bins, nr_bins * sizeof(*values));
+
+	return 1;
+}
+
+int dm_stats_record_sample(struct dm_stats_record *rec, unsigned series,
+			   const struct dm_stats *dms, uint64_t id)
+{
+	uint64_t counters[DM_STATS_NR_COUNTERS], *bins = NULL;
+	uint64_t area_id = (id & DM_STATS_WALK_GROUP) ? DM_STATS_WALK_GROUP
+						      : DM_STATS_WALK_REGION;
+	struct dm_histogram *dmh = NULL;
+	int i, nr_bins = 0, r;
+
+	for (i = 0; i < DM_STATS_NR_COUNTERS; i++)
+		counters[i] = dm_stats_get_counter(dms, (dm_stats_counter_t) i,
+						   id, area_id);
+
+	if (dm_stats_get_region_nr_histogram_bins(dms, id & ~DM_STATS_WALK_GROUP) &&
+	    (dmh = dm_stats_get_histogram(dms, id, area_id)))
+		nr_bins = dm_histogram_get_nr_bins(dmh);
+
+	if (nr_bins) {
+		if (!(bins = dm_malloc(nr_bins * sizeof(*bins)))) {
+			log_error("Could not allocate histogram sample.");
+			return 0;
+		}
+		for (i = 0; i < nr_bins; i++)
+			bins[i] = dm_histogram_get_bin_count(dmh, i);
+	}
+
+	r = dm_stats_record_set_values(rec, series, counters, bins,
+				       (unsigned) nr_bins);
+	dm_free(bins);
+
+	return r;
+}
+
+int dm_stats_record_commit(struct dm_stats_record *rec, uint64_t timestamp_ns,
+			   uint64_t interval_ns)
+{
+	struct _record_slot *slot;
+
+	if (!rec->writable)
+		return_0;
+
+	slot = _record_pending(rec);
+	slot->timestamp_ns = timestamp_ns;
+	slot->interval_ns = interval_ns;
+	__atomic_store_n(&slot->seq, rec->hdr->head + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&rec->hdr->head, rec->hdr->head + 1, __ATOMIC_RELEASE);
+	rec->pending = NULL;
+
+	return 1;
+}
+
+unsigned dm_stats_record_get_nr_series(const struct dm_stats_record *rec)
+{
+	return rec->hdr->nr_series;
+}
+
+const char *dm_stats_record_get_series_name(const struct dm_stats_record *rec,
+					    unsigned series)
+{
+	if (!_record_check_series(rec, series))
+		return_NULL;
+
+	return _series(rec, series)->name;
+}
+
+uint64_t dm_stats_record_get_series_id(const struct dm_stats_record *rec,
+				       unsigned series)
+{
+	if (!_record_check_series(rec, series))
+		return 0;
+
+	return _series(rec, series)->id;
+}
+
+uint64_t dm_stats_record_get_nr_samples(const struct dm_stats_record *rec)
+{
+	uint64_t head = __atomic_load_n(&rec->hdr->head, __ATOMIC_ACQUIRE);
+
+	return (head < rec->hdr->nr_slots) ? head : rec->hdr->nr_slots;
+}
+
+/*
+ * Sum the counters and bins of one series over the retained samples
+ * with a timestamp in [start_ns, end_ns]. An end_ns of zero means no
+ * upper limit. Slots rewritten while being read are skipped.
+ */
+static int _record_sum(const struct dm_stats_record *rec, unsigned series,
+		       uint64_t start_ns, uint64_t end_ns, uint64_t *sums)
+{
+	const struct _record_header *hdr = rec->hdr;
+	size_t i, nr_values = _series_values(hdr);
+	const struct _record_slot *slot;
+	uint64_t head, sample, seq, ts;
+	const uint64_t *values;
+
+	if (!_record_check_series(rec, series))
+		return_0;
+
+	memset(sums, 0, nr_values * sizeof(*sums));
+
+	head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+	sample = (head > hdr->nr_slots) ? head - hdr->nr_slots : 0;
+
+	for (; sample < head; sample++) {
+		slot = _slot(rec, sample);
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != sample + 1)
+			continue;
+
+		ts = slot->timestamp_ns;
+		if ((ts < start_ns) || (end_ns && (ts > end_ns)))
+			continue;
+
+		values = slot->values + series * nr_values;
+		for (i = 0; i < nr_values; i++)
+			sums[i] += values[i];
+
+		/* Undo the sample if the writer reused the slot meanwhile. */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+		if (seq != sample + 1)
+			for (i = 0; i < nr_values; i++)
+				sums[i] -= values[i];
+	}
+
+	return 1;
+}
+
+int dm_stats_record_get_counter(const struct dm_stats_record *rec,
+				unsigned series, dm_stats_counter_t counter,
+				uint64_t start_ns, uint64_t end_ns,
+				uint64_t *value)
+{
+	uint64_t *sums;
+
+	if (counter >= DM_STATS_NR_COUNTERS) {
+		log_error("Attempt to read invalid counter: %u.", counter);
+		return 0;
+	}
+
+	if (!(sums = dm_malloc(_series_values(rec->hdr) * sizeof(*sums)))) {
+		log_error("Could not allocate stats record sums.");
+		return 0;
+	}
+
+	if (!_record_sum(rec, series, start_ns, end_ns, sums)) {
+		dm_free(sums);
+		return_0;
+	}
+
+	*value = sums[counter];
+	dm_free(sums);
+
+	return 1;
+}
+
+int dm_stats_record_get_percentile(const struct dm_stats_record *rec,
+				   unsigned series, double percentile,
+				   uint64_t start_ns, uint64_t end_ns,
+				   uint64_t *value)
+{
+	const struct _record_series *s;
+	uint64_t *sums, *bins, total = 0, cum = 0, rank, lower, upper;
+	unsigned bin;
+	int r = 0;
+
+	if ((percentile <= 0.0) || (percentile > 100.0)) {
+		log_error("Percentile must be in the range (0, 100].");
+		return 0;
+	}
+
+	if (!_record_check_series(rec, series))
+		return_0;
+
+	if (!(s = _series(rec, series))->nr_bins) {
+		log_error("Stats record series %s (" FMTu64 ") has no histogram.",
+			  s->name, s->id);
+		return 0;
+	}
+
+	if (!(sums = dm_malloc(_series_values(rec->hdr) * sizeof(*sums)))) {
+		log_error("Could not allocate stats record sums.");
+		return 0;
+	}
+
+	if (!_record_sum(rec, series, start_ns, end_ns, sums))
+		goto_out;
+
+	bins = sums + DM_STATS_NR_COUNTERS;
+	for (bin = 0; bin < s->nr_bins; bin++)
+		total += bins[bin];
+
+	*value = 0;
+	r = 1;
+
+	if (!total)
+		goto out;
+
+	rank = (uint64_t) ceil(percentile / 100.0 * (double) total);
+
+	/*
+	 * Interpolate linearly inside the bin holding the requested rank;
+	 * the final bin is unbounded so report its lower bound.
+	 */
+	for (bin = 0; bin < s->nr_bins; bin++) {
+		if (cum + bins[bin] >= rank)
+			break;
+		cum += bins[bin];
+	}
+
+	lower = bin ? s->bounds[bin - 1] : 0;
+	upper = s->bounds[bin];
+
+	if ((bin == s->nr_bins - 1) || (upper == UINT64_MAX))
+		*value = lower;
+	else
+		*value = lower + (uint64_t) ((double) (upper - lower) *
+					     (double) (rank - cum) /
+					     (double) bins[bin]);
+out:
+	dm_free(sums);
+
+	return r;
+}
@@ -17,6 +17,7 @@
 
 #include "libdm/misc/dmlib.h"
 #include "libdm/misc/kdev_t.h"
+#include "libdm/libdm-stats.h"
 
 #include <math.h> /* log10() */
 
@@ -36,9 +37,6 @@
   #include <linux/magic.h> /* BTRFS_SUPER_MAGIC */
 #endif
 
-#define DM_STATS_REGION_NOT_PRESENT UINT64_MAX
-#define DM_STATS_GROUP_NOT_PRESENT DM_STATS_GROUP_NONE
-
 #define NSEC_PER_USEC   1000L
 #define NSEC_PER_MSEC   1000000L
 #define NSEC_PER_SEC    1000000000L
@@ -52,90 +50,6 @@
 
 #define SECTOR_SHIFT 9L
 
-/* Histogram bin */
-struct dm_histogram_bin {
-	uint64_t upper; /* Upper bound on this bin. */
-	uint64_t count; /* Count value for this bin. */
-};
-
-struct dm_histogram {
-	/* The stats handle this histogram belongs to. */
-	const struct dm_stats *dms;
-	/* The region this histogram belongs to. */
-	const struct dm_stats_region *region;
-	uint64_t sum; /* Sum of histogram bin counts. */
-	int nr_bins; /* Number of histogram bins assigned. */
-	struct dm_histogram_bin bins[];
-};
-
-/*
- * See Documentation/device-mapper/statistics.txt for full descriptions
- * of the device-mapper statistics counter fields.
- */
-struct dm_stats_counters {
-	uint64_t reads;		    /* Num reads completed */
-	uint64_t reads_merged;	    /* Num reads merged */
-	uint64_t read_sectors;	    /* Num sectors read */
-	uint64_t read_nsecs;	    /* Num milliseconds spent reading */
-	uint64_t writes;	    /* Num writes completed */
-	uint64_t writes_merged;	    /* Num writes merged */
-	uint64_t write_sectors;	    /* Num sectors written */
-	uint64_t write_nsecs;	    /* Num milliseconds spent writing */
-	uint64_t io_in_progress;    /* Num I/Os currently in progress */
-	uint64_t io_nsecs;	    /* Num milliseconds spent doing I/Os */
-	uint64_t weighted_io_nsecs; /* Weighted num milliseconds doing I/Os */
-	uint64_t total_read_nsecs;  /* Total time spent reading in milliseconds */
-	uint64_t total_write_nsecs; /* Total time spent writing in milliseconds */
-	struct dm_histogram *histogram; /* Histogram. */
-};
-
-struct dm_stats_region {
-	uint64_t region_id; /* as returned by @stats_list */
-	uint64_t group_id;
-	uint64_t start;
-	uint64_t len;
-	uint64_t step;
-	char *program_id;
-	char *aux_data;
-	uint64_t timescale; /* precise_timestamps is per-region */
-	struct dm_histogram *bounds; /* histogram configuration */
-	struct dm_histogram *histogram; /* aggregate cache */
-	struct dm_stats_counters *counters;
-};
-
-struct dm_stats_group {
-	uint64_t group_id;
-	const char *alias;
-	dm_bitset_t regions;
-	struct dm_histogram *histogram;
-};
-
-struct dm_stats {
-	/* device binding */
-	int bind_major;  /* device major that this dm_stats object is bound to */
-	int bind_minor;  /* device minor that this dm_stats object is bound to */
-	char *bind_name; /* device-mapper device name */
-	char *bind_uuid; /* device-mapper UUID */
-	char *program_id; /* default program_id for this handle */
-	const char *name; /* cached device_name used for reporting */
-	struct dm_pool *mem; /* memory pool for region and counter tables */
-	struct dm_pool *hist_mem; /* separate pool for histogram tables */
-	struct dm_pool *group_mem; /* separate pool for group tables */
-	uint64_t nr_regions; /* total number of present regions */
-	uint64_t max_region; /* size of the regions table */
-	uint64_t interval_ns;  /* sampling interval in nanoseconds */
-	uint64_t timescale; /* default sample value multiplier */
-	int precise; /* use precise_timestamps when creating regions */
-	struct dm_stats_region *regions;
-	struct dm_stats_group *groups;
-	/* statistics cursor */
-	uint64_t walk_flags; /* walk control flags */
-	uint64_t cur_flags;
-	uint64_t cur_group;
-	uint64_t cur_region;
-	uint64_t cur_area;
-};
-
 static char *_stats_escape_aux_data(const char *aux_data)
 {
 	size_t aux_data_len = strlen(aux_data);
@@ -829,114 +743,6 @@ bad:
 	return 0;
 }
 
-/*
- * Parse a histogram specification returned by the kernel in a
- * @stats_list response.
- */
-static int _stats_parse_histogram_spec(struct dm_stats *dms,
-				       struct dm_stats_region *region,
-				       char *histogram)
-{
-	const char valid_chars[] = "0123456789,";
-	uint64_t scale = region->timescale, this_val = 0;
-	struct dm_pool *mem = dms->hist_mem;
-	struct dm_histogram_bin cur;
-	struct dm_histogram hist = { 0 };
-	int nr_bins = 1;
-	const char *c, *v, *val_start;
-	char *p, *endptr = NULL;
-
-	/* Advance past "histogram:". */
-	histogram = strchr(histogram, ':');
-	if (!histogram) {
-		log_error("Could not parse histogram description.");
-		return 0;
-	}
-	histogram++;
-
-	/* @stats_list rows are newline terminated. */
-	if ((p = strchr(histogram, '\n')))
-		*p = '\0';
-
-	if (!dm_pool_begin_object(mem, sizeof(cur)))
-		return_0;
-
-	hist.nr_bins = 0; /* fix later */
-	hist.region = region;
-	hist.dms = dms;
-
-	if (!dm_pool_grow_object(mem, &hist, sizeof(hist)))
-		goto_bad;
-
-	c = histogram;
-	do {
-		for (v = valid_chars; *v; v++)
-			if (*c == *v)
-				break;
-		if (!*v) {
-			stack;
-			goto badchar;
-		}
-
-		if (*c == ',') {
-			log_error("Invalid histogram description: %s",
-				  histogram);
-			goto bad;
-		} else {
-			val_start = c;
-			endptr = NULL;
-
-			errno = 0;
-			this_val = strtoull(val_start, &endptr, 10);
-			if (errno || !endptr) {
-				log_error("Could not parse histogram boundary.");
-				goto bad;
-			}
-
-			c = endptr; /* Advance to units, comma, or end. */
-
-			if (*c == ',')
-				c++;
-			else if (*c || (*c == ' ')) { /* Expected ',' or NULL. */
-				stack;
-				goto badchar;
-			}
-
-			if (*c == ',')
-				c++;
-
-			cur.upper = scale * this_val;
-			cur.count = 0;
-
-			if (!dm_pool_grow_object(mem, &cur, sizeof(cur)))
-				goto_bad;
-
-			nr_bins++;
-		}
-	} while (*c && (*c != ' '));
-
-	/* final upper bound. */
-	cur.upper = UINT64_MAX;
-	if (!dm_pool_grow_object(mem, &cur, sizeof(cur)))
-		goto_bad;
-
-	region->bounds = dm_pool_end_object(mem);
-
-	if (!region->bounds)
-		return_0;
-
-	region->bounds->nr_bins = nr_bins;
-
-	log_debug("Added region histogram spec with %d entries.", nr_bins);
-	return 1;
-
-badchar:
-	log_error("Invalid character in histogram: '%c' (0x%x).", *c, (unsigned char) *c);
-bad:
-	dm_pool_abandon_object(mem);
-	return 0;
-}
-
 static int _stats_parse_string_data(char *string_data, char **program_id,
 				    char **aux_data, char **stats_args)
 {
@@ -1028,7 +834,7 @@ static int _stats_parse_list_region(struct dm_stats *dms,
 
 	p = strstr(stats_args, HISTOGRAM_ARG);
 	if (p) {
-		if (!_stats_parse_histogram_spec(dms, region, p)) {
+		if (!stats_parse_histogram_spec(dms, region, p)) {
 			return_0;
 		}
 	} else {
@@ -1203,233 +1009,6 @@ bad:
 	return 0;
 }
 
-/*
- * Parse histogram data returned from a @stats_print operation.
- */
-static int _stats_parse_histogram(struct dm_pool *mem, char *hist_str,
-				  struct dm_histogram **histogram,
-				  struct dm_stats_region *region)
-{
-	const char valid_chars[] = "0123456789:";
-	struct dm_histogram *bounds = region->bounds;
-	struct dm_histogram hist = {
-		.nr_bins = region->bounds->nr_bins
-	};
-	const char *c, *v, *val_start;
-	struct dm_histogram_bin cur;
-	uint64_t sum = 0, this_val;
-	char *endptr = NULL;
-	int bin = 0;
-
-	c = hist_str;
-
-	if (!dm_pool_begin_object(mem, sizeof(cur)))
-		return_0;
-
-	if (!dm_pool_grow_object(mem, &hist, sizeof(hist)))
-		goto_bad;
-
-	do {
-		memset(&cur, 0, sizeof(cur));
-		for (v = valid_chars; *v; v++)
-			if (*c == *v)
-				break;
-		if (!*v)
-			goto badchar;
-
-		if (*c == ',')
-			goto badchar;
-		else {
-			val_start = c;
-			endptr = NULL;
-
-			errno = 0;
-			this_val = strtoull(val_start, &endptr, 10);
-			if (errno || !endptr) {
-				log_error("Could not parse histogram value.");
-				goto bad;
-			}
-			c = endptr; /* Advance to colon, or end. */
-
-			if (*c == ':')
-				c++;
-			else if (*c && (*c != '\n'))
-				/* Expected ':', '\n', or NULL. */
-				goto badchar;
-
-			if (*c == ':')
-				c++;
-
-			cur.upper = bounds->bins[bin].upper;
-			cur.count = this_val;
-			sum += this_val;
-
-			if (!dm_pool_grow_object(mem, &cur, sizeof(cur)))
-				goto_bad;
-
-			bin++;
-		}
-	} while (*c && (*c != '\n'));
-
-	log_debug("Added region histogram data with %d entries.", hist.nr_bins);
-
-	*histogram = dm_pool_end_object(mem);
-	(*histogram)->sum = sum;
-
-	return 1;
-
-badchar:
-	log_error("Invalid character in histogram data: '%c' (0x%x).", *c, (unsigned char) *c);
-bad:
-	dm_pool_abandon_object(mem);
-	return 0;
-}
-
-static int _stats_parse_region(struct dm_stats *dms, const char *resp,
-			       struct dm_stats_region *region,
-			       uint64_t timescale)
-{
-	struct dm_histogram *hist = NULL;
-	struct dm_pool *mem = dms->mem;
-	struct dm_stats_counters cur;
-	FILE *stats_rows = NULL;
-	uint64_t start = 0, len = 0;
-	char row[STATS_ROW_BUF_LEN];
-	int r;
-
-	if (!resp) {
-		log_error("Could not parse empty @stats_print response.");
-		return 0;
-	}
-
-	region->start = UINT64_MAX;
-
-	if (!dm_pool_begin_object(mem, 512))
-		goto_bad;
-
-	/*
-	 * dm_task_get_message_response() returns a 'const char *' but
-	 * since fmemopen also permits "w" it expects a 'char *'.
-	 */
-	/* coverity[alloc_strlen] intentional */
-	stats_rows = fmemopen((char *)resp, strlen(resp), "r");
-	if (!stats_rows)
-		goto_bad;
-
-	/*
-	 * Output format for each step-sized area of a region:
-	 *
-	 * <start_sector>+<length> counters
-	 *
-	 * The first 11 counters have the same meaning as
-	 * /sys/block/ * /stat or /proc/diskstats.
-	 *
-	 * Please refer to Documentation/iostats.txt for details.
-	 *
-	 * 1. the number of reads completed
-	 * 2. the number of reads merged
-	 * 3. the number of sectors read
-	 * 4. the number of milliseconds spent reading
-	 * 5. the number of writes completed
-	 * 6. the number of writes merged
-	 * 7. the number of sectors written
-	 * 8. the number of milliseconds spent writing
-	 * 9. the number of I/Os currently in progress
-	 * 10. the number of milliseconds spent doing I/Os
-	 * 11. the weighted number of milliseconds spent doing I/Os
-	 *
-	 * Additional counters:
-	 * 12. the total time spent reading in milliseconds
-	 * 13. the total time spent writing in milliseconds
-	 *
-	*/
-	while (fgets(row, sizeof(row), stats_rows)) {
-		r = sscanf(row, FMTu64 "+" FMTu64 /* start+len */
-			   /* reads */
-			   FMTu64 " " FMTu64 " " FMTu64 " " FMTu64 " "
-			   /* writes */
-			   FMTu64 " " FMTu64 " " FMTu64 " " FMTu64 " "
-			   /* in flight & io nsecs */
-			   FMTu64 " " FMTu64 " " FMTu64 " "
-			   /* tot read/write nsecs */
-			   FMTu64 " " FMTu64, &start, &len,
-			   &cur.reads, &cur.reads_merged, &cur.read_sectors,
-			   &cur.read_nsecs,
-			   &cur.writes, &cur.writes_merged, &cur.write_sectors,
-			   &cur.write_nsecs,
-			   &cur.io_in_progress,
-			   &cur.io_nsecs, &cur.weighted_io_nsecs,
-			   &cur.total_read_nsecs, &cur.total_write_nsecs);
-		if (r != 15) {
-			log_error("Could not parse @stats_print row.");
-			goto bad;
-		}
-
-		/* scale time values up if needed */
-		if (timescale != 1) {
-			cur.read_nsecs *= timescale;
-			cur.write_nsecs *= timescale;
-			cur.io_nsecs *= timescale;
-			cur.weighted_io_nsecs *= timescale;
-			cur.total_read_nsecs *= timescale;
-			cur.total_write_nsecs *= timescale;
-		}
-
-		if (region->bounds) {
-			/* Find first histogram separator. */
-			char *hist_str = strchr(row, ':');
-			if (!hist_str) {
-				log_error("Could not parse histogram value.");
-				goto bad;
-			}
-			/* Find space preceding histogram. */
-			while (hist_str && *(hist_str - 1) != ' ')
-				hist_str--;
-
-			/* Use a separate pool for histogram objects since we
-			 * are growing the area table and each area's histogram
-			 * table simultaneously.
-			 */
-			if (!_stats_parse_histogram(dms->hist_mem, hist_str,
-						    &hist, region))
-				goto_bad;
-			hist->dms = dms;
-			hist->region = region;
-		}
-
-		cur.histogram = hist;
-
-		if (!dm_pool_grow_object(mem, &cur, sizeof(cur)))
-			goto_bad;
-
-		if (region->start == UINT64_MAX) {
-			region->start = start;
-			region->step = len; /* area size is always uniform. */
-		}
-	}
-
-	if (region->start == UINT64_MAX)
-		/* no area data read from @stats_print */
-		goto bad;
-
-	region->len = (start + len) - region->start;
-	region->timescale = timescale;
-	region->counters = dm_pool_end_object(mem);
-
-	if (fclose(stats_rows))
-		stack;
-
-	return 1;
-
-bad:
-	if (stats_rows)
-		if (fclose(stats_rows))
-			stack;
-	dm_pool_abandon_object(mem);
-
-	return 0;
-}
-
 static void _stats_walk_next_present(const struct dm_stats *dms,
 				     uint64_t *flags,
 				     uint64_t *cur_r, uint64_t *cur_a,
@@ -2405,7 +1984,7 @@ static int _dm_stats_populate_region(struct dm_stats *dms, uint64_t region_id,
 	if (!_stats_bound(dms))
 		return_0;
 
-	if (!_stats_parse_region(dms, resp, region, region->timescale)) {
+	if (!stats_parse_region(dms, resp, region, region->timescale)) {
 		log_error("Could not parse @stats_print message response.");
 		return 0;
 	}
@@ -2662,6 +2241,190 @@ MK_STATS_GET_COUNTER_FN(total_read_nsecs, TOTAL_READ_NSECS)
 MK_STATS_GET_COUNTER_FN(total_write_nsecs, TOTAL_WRITE_NSECS)
 #undef MK_STATS_GET_COUNTER_FN
 
+/*
+ * Incremental polling of region counters.
+ *
+ * Each tracked region keeps two samples of its counters in a
+ * struct-of-arrays layout: DM_STATS_NR_COUNTERS arrays of nr_areas
+ * values. An update overwrites the older sample, compares it with the
+ * newer one and records the area_ids whose counters changed.
+ */
+struct dm_stats_delta_region {
+	uint64_t nr_areas;
+	uint64_t *samples;	/* 2 * DM_STATS_NR_COUNTERS * nr_areas */
+	uint64_t *changed;	/* area_ids changed by the last update */
+	uint64_t nr_changed;
+	unsigned cur;		/* index of the most recent sample */
+	unsigned nr_samples;	/* valid samples: 0, 1 or 2 */
+};
+
+struct dm_stats_delta {
+	uint64_t nr_regions;
+	struct dm_stats_delta_region *regions;
+};
+
+#define _delta_sample(dr, s, counter) \
+	((dr)->samples + ((s) * DM_STATS_NR_COUNTERS + (counter)) * (dr)->nr_areas)
+
+struct dm_stats_delta *dm_stats_delta_create(void)
+{
+	struct dm_stats_delta *delta;
+
+	if (!(delta = dm_zalloc(sizeof(*delta)))) {
+		log_error("Could not allocate stats delta handle.");
+		return NULL;
+	}
+
+	return delta;
+}
+
+static void _stats_delta_region_clear(struct dm_stats_delta_region *dr)
+{
+	dm_free(dr->samples);
+	dm_free(dr->changed);
+	memset(dr, 0, sizeof(*dr));
+}
+
+void dm_stats_delta_destroy(struct dm_stats_delta *delta)
+{
+	uint64_t i;
+
+	if (!delta)
+		return;
+
+	for (i = 0; i < delta->nr_regions; i++)
+		_stats_delta_region_clear(&delta->regions[i]);
+
+	dm_free(delta->regions);
+	dm_free(delta);
+}
+
+static struct dm_stats_delta_region *_stats_delta_region(struct dm_stats_delta *delta,
+							 uint64_t region_id,
+							 uint64_t nr_areas)
+{
+	struct dm_stats_delta_region *dr, *regions;
+	uint64_t nr_regions;
+
+	if (region_id >= delta->nr_regions) {
+		nr_regions = region_id + 1;
+		if (nr_regions < 2 * delta->nr_regions)
+			nr_regions = 2 * delta->nr_regions;
+		if (!(regions = dm_realloc(delta->regions,
+					   nr_regions * sizeof(*regions)))) {
+			log_error("Could not grow stats delta region table.");
+			return NULL;
+		}
+		memset(regions + delta->nr_regions, 0,
+		       (nr_regions - delta->nr_regions) * sizeof(*regions));
+		delta->regions = regions;
+		delta->nr_regions = nr_regions;
+	}
+
+	dr = &delta->regions[region_id];
+
+	/* Region was deleted and re-created with a different geometry. */
+	if (dr->samples && (dr->nr_areas != nr_areas))
+		_stats_delta_region_clear(dr);
+
+	if (!dr->samples) {
+		dr->nr_areas = nr_areas;
+		if (!(dr->samples = dm_malloc(2 * DM_STATS_NR_COUNTERS * nr_areas *
+					      sizeof(*dr->samples))) ||
+		    !(dr->changed = dm_malloc(nr_areas * sizeof(*dr->changed)))) {
+			log_error("Could not allocate stats delta samples.");
+			_stats_delta_region_clear(dr);
+			return NULL;
+		}
+	}
+
+	return dr;
+}
+
+int dm_stats_delta_update(struct dm_stats_delta *delta,
+			  const struct dm_stats *dms, uint64_t region_id,
+			  const uint64_t **area_ids, uint64_t *nr_areas)
+{
+	const struct dm_stats_counters *counters;
+	struct dm_stats_delta_region *dr;
+	uint64_t area, n, *cur, *prev;
+	unsigned s;
+	int i;
+
+	if ((region_id & DM_STATS_WALK_GROUP) ||
+	    (region_id > dms->max_region) || !dms->regions ||
+	    !_stats_region_present(&dms->regions[region_id]) ||
+	    !(counters = dms->regions[region_id].counters)) {
+		log_error("No counters for stats region " FMTu64 " to compare.",
+			  region_id);
+		return 0;
+	}
+
+	n = _nr_areas_region(&dms->regions[region_id]);
+
+	if (!(dr = _stats_delta_region(delta, region_id, n)))
+		return_0;
+
+	s = dr->nr_samples ? !dr->cur : 0;
+
+	for (i = 0; i < DM_STATS_NR_COUNTERS; i++) {
+		cur = _delta_sample(dr, s, i);
+		for (area = 0; area < n; area++)
+			cur[area] = stats_counter_field(&counters[area], i);
+	}
+
+	dr->nr_changed = 0;
+	if (!dr->nr_samples) {
+		for (area = 0; area < n; area++)
+			dr->changed[area] = area;
+		dr->nr_changed = n;
+	} else {
+		/*
+		 * Scan each counter array in turn and mark changed areas in
+		 * the changed[] table before compacting it into area_ids.
+		 */
+		memset(dr->changed, 0, n * sizeof(*dr->changed));
+		for (i = 0; i < DM_STATS_NR_COUNTERS; i++) {
+			cur = _delta_sample(dr, s, i);
+			prev = _delta_sample(dr, !s, i);
+			for (area = 0; area < n; area++)
+				dr->changed[area] |= (cur[area] != prev[area]);
+		}
+		for (area = 0; area < n; area++)
+			if (dr->changed[area])
+				dr->changed[dr->nr_changed++] = area;
+	}
+
+	dr->cur = s;
+	if (dr->nr_samples < 2)
+		dr->nr_samples++;
+
+	*area_ids = dr->changed;
+	*nr_areas = dr->nr_changed;
+
+	return 1;
+}
+
+uint64_t dm_stats_delta_get_counter(const struct dm_stats_delta *delta,
+				    dm_stats_counter_t counter,
+				    uint64_t region_id, uint64_t area_id)
+{
+	const struct dm_stats_delta_region *dr;
+
+	if ((region_id >= delta->nr_regions) ||
+	    !(dr = &delta->regions[region_id])->nr_samples ||
+	    (area_id >= dr->nr_areas) || (counter >= DM_STATS_NR_COUNTERS)) {
+		log_error("Attempt to read invalid stats delta counter.");
+		return 0;
+	}
+
+	if (dr->nr_samples == 1)
+		return _delta_sample(dr, dr->cur, counter)[area_id];
+
+	return _delta_sample(dr, dr->cur, counter)[area_id] -
+		_delta_sample(dr, !dr->cur, counter)[area_id];
+}
+
 /*
  * Floating point stats metric functions
  *
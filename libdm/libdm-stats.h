@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2016 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of the device-mapper userspace tools.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU Lesser General Public License v.2.1.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LIB_DMSTATS_H
+#define LIB_DMSTATS_H
+
+#include "libdm/libdevmapper.h"
+
+#include <stddef.h>
+
+#define DM_STATS_REGION_NOT_PRESENT UINT64_MAX
+#define DM_STATS_GROUP_NOT_PRESENT DM_STATS_GROUP_NONE
+
+/* Histogram bin */
+struct dm_histogram_bin {
+	uint64_t upper; /* Upper bound on this bin. */
+	uint64_t count; /* Count value for this bin. */
+};
+
+struct dm_histogram {
+	/* The stats handle this histogram belongs to. */
+	const struct dm_stats *dms;
+	/* The region this histogram belongs to. */
+	const struct dm_stats_region *region;
+	uint64_t sum; /* Sum of histogram bin counts. */
+	int nr_bins; /* Number of histogram bins assigned. */
+	struct dm_histogram_bin bins[];
+};
+
+/*
+ * See Documentation/device-mapper/statistics.txt for full descriptions
+ * of the device-mapper statistics counter fields.
+ */
+struct dm_stats_counters {
+	uint64_t reads;		    /* Num reads completed */
+	uint64_t reads_merged;	    /* Num reads merged */
+	uint64_t read_sectors;	    /* Num sectors read */
+	uint64_t read_nsecs;	    /* Num milliseconds spent reading */
+	uint64_t writes;	    /* Num writes completed */
+	uint64_t writes_merged;	    /* Num writes merged */
+	uint64_t write_sectors;	    /* Num sectors written */
+	uint64_t write_nsecs;	    /* Num milliseconds spent writing */
+	uint64_t io_in_progress;    /* Num I/Os currently in progress */
+	uint64_t io_nsecs;	    /* Num milliseconds spent doing I/Os */
+	uint64_t weighted_io_nsecs; /* Weighted num milliseconds doing I/Os */
+	uint64_t total_read_nsecs;  /* Total time spent reading in milliseconds */
+	uint64_t total_write_nsecs; /* Total time spent writing in milliseconds */
+	struct dm_histogram *histogram; /* Histogram. */
+};
+
+struct dm_stats_region {
+	uint64_t region_id; /* as returned by @stats_list */
+	uint64_t group_id;
+	uint64_t start;
+	uint64_t len;
+	uint64_t step;
+	char *program_id;
+	char *aux_data;
+	uint64_t timescale; /* precise_timestamps is per-region */
+	struct dm_histogram *bounds; /* histogram configuration */
+	struct dm_histogram *histogram; /* aggregate cache */
+	struct dm_stats_counters *counters;
+};
+
+struct dm_stats_group {
+	uint64_t group_id;
+	const char *alias;
+	dm_bitset_t regions;
+	struct dm_histogram *histogram;
+};
+
+struct dm_stats {
+	/* device binding */
+	int bind_major;  /* device major that this dm_stats object is bound to */
+	int bind_minor;  /* device minor that this dm_stats object is bound to */
+	char *bind_name; /* device-mapper device name */
+	char *bind_uuid; /* device-mapper UUID */
+	char *program_id; /* default program_id for this handle */
+	const char *name; /* cached device_name used for reporting */
+	struct dm_pool *mem; /* memory pool for region and counter tables */
+	struct dm_pool *hist_mem; /* separate pool for histogram tables */
+	struct dm_pool *group_mem; /* separate pool for group tables */
+	uint64_t nr_regions; /* total number of present regions */
+	uint64_t max_region; /* size of the regions table */
+	uint64_t interval_ns;  /* sampling interval in nanoseconds */
+	uint64_t timescale; /* default sample value multiplier */
+	int precise; /* use precise_timestamps when creating regions */
+	struct dm_stats_region *regions;
+	struct dm_stats_group *groups;
+	/* statistics cursor */
+	uint64_t walk_flags; /* walk control flags */
+	uint64_t cur_flags;
+	uint64_t cur_group;
+	uint64_t cur_region;
+	uint64_t cur_area;
+};
+
+/* Counter fields of struct dm_stats_counters in dm_stats_counter_t order. */
+extern const size_t stats_counter_offsets[DM_STATS_NR_COUNTERS];
+
+#define stats_counter_field(area, counter) \
+	(*(uint64_t *)((char *)(area) + stats_counter_offsets[(counter)]))
+
+/*
+ * Parsers of the kernel @stats_list and @stats_print responses,
+ * in libdm-stats-parse.c.
+ */
+int stats_parse_u64(const char **c, uint64_t *val);
+int stats_parse_histogram_spec(struct dm_stats *dms,
+			       struct dm_stats_region *region,
+			       char *histogram);
+int stats_parse_region(struct dm_stats *dms, const char *resp,
+		       struct dm_stats_region *region,
+		       uint64_t timescale);
+
+#endif
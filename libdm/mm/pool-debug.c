@@ -290,3 +290,13 @@ static int _pool_protect(struct dm_pool *p, int prot)
 #endif
 	return 1;
 }
+
+/* Chunks are not cached with DEBUG_POOL */
+void dm_pool_get_cache_stats(struct dm_pool_cache_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+}
+
+void dm_pools_release_cache(void)
+{
+}
@@ -42,6 +42,150 @@ struct dm_pool {
 static void _align_chunk(struct chunk *c, unsigned alignment);
 static struct chunk *_new_chunk(struct dm_pool *p, size_t s);
 static void _free_chunk(struct chunk *c);
+static void _release_chunk(struct chunk *c);
+
+/*
+ * Per-thread cache of free chunks.
+ *
+ * Commands create and destroy many short lived pools (per VG, format
+ * instance, report and config tree pools) that mostly use the few
+ * power of 2 chunk sizes dm_pool_create() rounds chunk hints to.
+ * Freed chunks of those sizes are kept on per-thread lists and handed
+ * out again by _new_chunk() instead of going back to malloc.
+ * The cache is bounded per size class and in total, and is emptied by
+ * a thread-specific key destructor on thread exit and by dm_lib_exit()
+ * for the calling thread.  dm_lib_exit() also deletes the key, so no
+ * destructor is left pointing into an unloaded library, and chunks are
+ * no longer cached after that.
+ */
+#define CHUNK_CACHE_MIN_SHIFT	10	/* 1KiB */
+#define CHUNK_CACHE_MAX_SHIFT	16	/* 64KiB */
+#define CHUNK_CACHE_CLASSES	(CHUNK_CACHE_MAX_SHIFT - CHUNK_CACHE_MIN_SHIFT + 1)
+#define CHUNK_CACHE_CLASS_CHUNKS 16
+#define CHUNK_CACHE_MAX_BYTES	(1024 * 1024)
+
+struct chunk_cache {
+	struct chunk *free[CHUNK_CACHE_CLASSES];
+	unsigned count[CHUNK_CACHE_CLASSES];
+	int key_set;
+	struct dm_pool_cache_stats stats;
+};
+
+static __thread struct chunk_cache _chunk_cache;
+static pthread_key_t _chunk_cache_key;
+static pthread_once_t _chunk_cache_once = PTHREAD_ONCE_INIT;
+static int _chunk_cache_key_ok = 0;
+
+static void _chunk_cache_release(void *data)
+{
+	struct chunk_cache *cache = data;
+	struct chunk *c;
+	unsigned i;
+
+	for (i = 0; i < CHUNK_CACHE_CLASSES; i++) {
+		while ((c = cache->free[i])) {
+			cache->free[i] = c->prev;
+			_release_chunk(c);
+		}
+		cache->count[i] = 0;
+	}
+
+	cache->stats.cached_bytes = 0;
+}
+
+static void _chunk_cache_key_create(void)
+{
+	if (pthread_key_create(&_chunk_cache_key, _chunk_cache_release))
+		log_sys_debug("pthread_key_create", "pool chunk cache");
+	else
+		_chunk_cache_key_ok = 1;
+}
+
+static void _chunk_cache_key_delete(void)
+{
+	if (!_chunk_cache_key_ok)
+		return;
+
+	_chunk_cache_key_ok = 0;
+	if (pthread_key_delete(_chunk_cache_key))
+		log_sys_debug("pthread_key_delete", "pool chunk cache");
+}
+
+/* Size class of a chunk of s bytes, -1 if it is not cached */
+static int _chunk_cache_class(size_t s)
+{
+#ifdef DEBUG_ENFORCE_POOL_LOCKING
+	/* Chunks are page aligned and may be mprotected */
+	return -1;
+#else
+	if ((s & (s - 1)) ||
+	    (s < (1U << CHUNK_CACHE_MIN_SHIFT)) ||
+	    (s > (1U << CHUNK_CACHE_MAX_SHIFT)))
+		return -1;
+
+	return __builtin_ctzl(s) - CHUNK_CACHE_MIN_SHIFT;
+#endif
+}
+
+static struct chunk *_chunk_cache_get(int class)
+{
+	struct chunk_cache *cache = &_chunk_cache;
+	struct chunk *c;
+
+	if (!(c = cache->free[class])) {
+		cache->stats.misses++;
+		return NULL;
+	}
+
+	cache->free[class] = c->prev;
+	cache->count[class]--;
+	cache->stats.cached_bytes -= c->end - (char *) c;
+	cache->stats.hits++;
+
+	return c;
+}
+
+static int _chunk_cache_put(struct chunk *c, int class)
+{
+	struct chunk_cache *cache = &_chunk_cache;
+	size_t s = c->end - (char *) c;
+
+	if ((cache->count[class] >= CHUNK_CACHE_CLASS_CHUNKS) ||
+	    (cache->stats.cached_bytes + s > CHUNK_CACHE_MAX_BYTES)) {
+		cache->stats.overflows++;
+		return 0;
+	}
+
+	if (!cache->key_set) {
+		pthread_once(&_chunk_cache_once, _chunk_cache_key_create);
+		if (_chunk_cache_key_ok &&
+		    !pthread_setspecific(_chunk_cache_key, cache))
+			cache->key_set = 1;
+	}
+
+	/* Without a destructor cached chunks would leak on thread exit */
+	if (!cache->key_set || !_chunk_cache_key_ok)
+		return 0;
+
+	c->prev = cache->free[class];
+	cache->free[class] = c;
+	cache->count[class]++;
+	cache->stats.cached_bytes += s;
+	cache->stats.recycled++;
+
+	return 1;
+}
+
+void dm_pool_get_cache_stats(struct dm_pool_cache_stats *stats)
+{
+	*stats = _chunk_cache.stats;
+}
+
+void dm_pools_release_cache(void)
+{
+	_chunk_cache_release(&_chunk_cache);
+	_chunk_cache_key_delete();
+}
 
 /* by default things come out aligned for doubles */
 #define DEFAULT_ALIGNMENT __alignof__ (double)
@@ -265,12 +409,21 @@ static void _align_chunk(struct chunk *c, unsigned alignment)
 static struct chunk *_new_chunk(struct dm_pool *p, size_t s)
 {
 	struct chunk *c;
+	int class;
 
 	if (p->spare_chunk &&
 	    ((p->spare_chunk->end - p->spare_chunk->begin) >= (ptrdiff_t)s)) {
 		/* reuse old chunk */
 		c = p->spare_chunk;
 		p->spare_chunk = 0;
+	} else if (((class = _chunk_cache_class(s)) >= 0) &&
+		   (c = _chunk_cache_get(class))) {
+		/* recycle chunk of another pool */
+		c->begin = (char *) (c + 1);
+
+#ifdef VALGRIND_POOL
+		VALGRIND_MAKE_MEM_NOACCESS(c->begin, c->end - c->begin);
+#endif
 	} else {
 #ifdef DEBUG_ENFORCE_POOL_LOCKING
 		/*
@@ -304,6 +457,17 @@ static struct chunk *_new_chunk(struct dm_pool *p, size_t s)
 }
 
 static void _free_chunk(struct chunk *c)
+{
+	int class;
+
+	if (c && ((class = _chunk_cache_class(c->end - (char *) c)) >= 0) &&
+	    _chunk_cache_put(c, class))
+		return;
+
+	_release_chunk(c);
+}
+
+static void _release_chunk(struct chunk *c)
 {
 #ifdef VALGRIND_POOL
 #  ifdef DEBUG_MEM
@@ -20,6 +20,7 @@
 static DM_LIST_INIT(_dm_pools);
 static pthread_mutex_t _dm_pools_mutex = PTHREAD_MUTEX_INITIALIZER;
 void dm_pools_check_leaks(void);
+void dm_pools_release_cache(void);
 
 #ifdef DEBUG_ENFORCE_POOL_LOCKING
 #ifdef DEBUG_POOL
@@ -17,10 +17,15 @@
 #include "parse_rx.h"
 #include "ttree.h"
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 struct dfa_state {
 	struct dfa_state *next;
 	int final;
+	uint32_t id;		/* index + 1 in saved dfa table */
 	dm_bitset_t bits;
 	struct dfa_state *lookup[256];
 };
@@ -41,6 +46,13 @@ struct dm_regex {		/* Instance variables for the lexer */
         struct ttree *tt;
         dm_bitset_t bs;
         struct dfa_state *h, *t;
+
+	/* dfa table mapped from cache file, see dm_regex_create_cached() */
+	uint32_t num_states;
+	const int32_t *final;
+	const uint32_t *table;
+	void *map;
+	size_t map_size;
 };
 
 static int _count_nodes(struct rx_node *rx)
@@ -418,11 +430,47 @@ static struct dfa_state *_step_matcher(struct dm_regex *m, int c, struct dfa_sta
 	return ns;
 }
 
+#define DFA_NO_STATE UINT32_MAX
+
+static uint32_t _step_table(const struct dm_regex *m, uint32_t cs, int c, int *r)
+{
+	uint32_t ns = m->table[cs * 256 + (unsigned char) c];
+
+	if (ns >= m->num_states)
+		return DFA_NO_STATE;
+
+	if (m->final[ns] > *r)
+		*r = m->final[ns];
+
+	return ns;
+}
+
+static int _match_table(const struct dm_regex *m, const char *s)
+{
+	uint32_t cs = 0;
+	int r = 0;
+
+	if ((cs = _step_table(m, cs, HAT_CHAR, &r)) == DFA_NO_STATE)
+		goto out;
+
+	for (; *s; s++)
+		if ((cs = _step_table(m, cs, *s, &r)) == DFA_NO_STATE)
+			goto out;
+
+	(void) _step_table(m, cs, DOLLAR_CHAR, &r);
+
+      out:
+	return r - 1;
+}
+
 int dm_regex_match(struct dm_regex *regex, const char *s)
 {
 	struct dfa_state *cs = regex->start;
 	int r = 0;
 
+	if (regex->table)
+		return _match_table(regex, s);
+
         dm_bit_clear_all(regex->bs);
 	if (!(cs = _step_matcher(regex, HAT_CHAR, cs, &r)))
 		goto out;
@@ -438,6 +486,276 @@ int dm_regex_match(struct dm_regex *regex, const char *s)
 	return r - 1;
 }
 
+/*
+ * Cache file with fully calculated dfa.
+ *
+ * States are numbered in breadth first order from the start state and
+ * saved as a dense table of 256 transitions per state, preceded by the
+ * final value of each state.  The mapped file is used for matching
+ * directly, so nothing needs to be parsed or calculated at startup.
+ * The file is valid only for the same list of patterns, identified by
+ * their hash, and for the same byte order.
+ */
+#define DFA_CACHE_MAGIC "DMRXDFA1"
+#define DFA_CACHE_BYTE_ORDER 0x01020304
+
+struct dfa_cache_header {
+	char magic[8];
+	uint32_t byte_order;
+	uint32_t num_states;
+	uint64_t patterns_hash;
+	uint32_t num_patterns;
+	uint32_t reserved;
+};
+
+/* FNV-1a over all patterns including terminating zeros. */
+static uint64_t _patterns_hash(const char * const *patterns, unsigned num_patterns)
+{
+	uint64_t h = UINT64_C(14695981039346656037);
+	const char *p;
+	unsigned i;
+
+	for (i = 0; i < num_patterns; i++) {
+		p = patterns[i];
+		do {
+			h ^= (unsigned char) *p;
+			h *= UINT64_C(1099511628211);
+		} while (*p++);
+	}
+
+	return h;
+}
+
+static size_t _dfa_cache_size(uint32_t num_states)
+{
+	return sizeof(struct dfa_cache_header) +
+		(size_t) num_states * (sizeof(int32_t) + 256 * sizeof(uint32_t));
+}
+
+static int _load_dfa_cache(struct dm_regex *m, const char *file,
+			   uint64_t patterns_hash, unsigned num_patterns)
+{
+	const struct dfa_cache_header *hdr;
+	struct stat info;
+	void *map;
+	int fd, r = 0;
+
+	if ((fd = open(file, O_RDONLY)) < 0) {
+		if (errno != ENOENT)
+			log_sys_debug("open", file);
+		return 0;
+	}
+
+	if (fstat(fd, &info)) {
+		log_sys_debug("fstat", file);
+		goto out;
+	}
+
+	if ((size_t) info.st_size < sizeof(*hdr)) {
+		log_debug("Regex cache %s is too small.", file);
+		goto out;
+	}
+
+	if ((map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+		log_sys_debug("mmap", file);
+		goto out;
+	}
+
+	hdr = map;
+	if (memcmp(hdr->magic, DFA_CACHE_MAGIC, sizeof(hdr->magic)) ||
+	    (hdr->byte_order != DFA_CACHE_BYTE_ORDER) ||
+	    !hdr->num_states ||
+	    ((size_t) info.st_size != _dfa_cache_size(hdr->num_states))) {
+		log_debug("Regex cache %s has unknown format.", file);
+		goto bad;
+	}
+
+	if ((hdr->patterns_hash != patterns_hash) ||
+	    (hdr->num_patterns != num_patterns)) {
+		log_debug("Regex cache %s is for different patterns.", file);
+		goto bad;
+	}
+
+	m->map = map;
+	m->map_size = info.st_size;
+	m->num_states = hdr->num_states;
+	m->final = (const int32_t *) (hdr + 1);
+	m->table = (const uint32_t *) (m->final + m->num_states);
+	r = 1;
+	goto out;
+bad:
+	if (munmap(map, info.st_size))
+		log_sys_debug("munmap", file);
+out:
+	if (close(fd))
+		log_sys_debug("close", file);
+
+	return r;
+}
+
+static int _push_state(struct dfa_state ***states, uint32_t *num_states,
+		       uint32_t *size, struct dfa_state *s)
+{
+	struct dfa_state **tmp;
+
+	if (*num_states == *size) {
+		*size = *size ? *size * 2 : 64;
+		if (!(tmp = dm_realloc(*states, *size * sizeof(*tmp))))
+			return_0;
+		*states = tmp;
+	}
+
+	(*states)[(*num_states)++] = s;
+	s->id = *num_states;
+
+	return 1;
+}
+
+static int _write_dfa_cache(FILE *fp, struct dfa_state **states, uint32_t num_states)
+{
+	uint32_t row[256];
+	int32_t final;
+	uint32_t i;
+	int c;
+
+	for (i = 0; i < num_states; i++) {
+		final = states[i]->final;
+		if (fwrite(&final, sizeof(final), 1, fp) != 1)
+			return_0;
+	}
+
+	for (i = 0; i < num_states; i++) {
+		for (c = 0; c < 256; c++)
+			row[c] = states[i]->lookup[c] ?
+				states[i]->lookup[c]->id - 1 : DFA_NO_STATE;
+		if (fwrite(row, sizeof(row), 1, fp) != 1)
+			return_0;
+	}
+
+	return 1;
+}
+
+static int _save_dfa_cache(struct dm_regex *m, const char *file,
+			   uint64_t patterns_hash, unsigned num_patterns)
+{
+	struct dfa_cache_header hdr = {
+		.byte_order = DFA_CACHE_BYTE_ORDER,
+		.patterns_hash = patterns_hash,
+		.num_patterns = num_patterns,
+	};
+	struct dfa_state **states = NULL;
+	uint32_t num_states = 0, size = 0, i;
+	char tmp_file[PATH_MAX];
+	FILE *fp = NULL;
+	int fd, c, r = 0;
+
+	if (!_force_states(m))
+		return_0;
+
+	memcpy(hdr.magic, DFA_CACHE_MAGIC, sizeof(hdr.magic));
+
+	/* Number the states breadth first, the list is also the queue. */
+	if (!_push_state(&states, &num_states, &size, m->start))
+		goto_out;
+
+	for (i = 0; i < num_states; i++)
+		for (c = 0; c < 256; c++)
+			if (states[i]->lookup[c] && !states[i]->lookup[c]->id &&
+			    !_push_state(&states, &num_states, &size, states[i]->lookup[c]))
+				goto_out;
+
+	hdr.num_states = num_states;
+
+	if (dm_snprintf(tmp_file, sizeof(tmp_file), "%s.%d", file, (int) getpid()) < 0)
+		goto_out;
+
+	if ((fd = open(tmp_file, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+		log_sys_debug("open", tmp_file);
+		goto out;
+	}
+
+	if (!(fp = fdopen(fd, "w"))) {
+		log_sys_debug("fdopen", tmp_file);
+		if (close(fd))
+			stack;
+		goto bad;
+	}
+
+	if ((fwrite(&hdr, sizeof(hdr), 1, fp) != 1) ||
+	    !_write_dfa_cache(fp, states, num_states)) {
+		log_debug("Failed to write regex cache %s.", tmp_file);
+		goto bad;
+	}
+
+	if (fclose(fp)) {
+		fp = NULL;
+		log_sys_debug("fclose", tmp_file);
+		goto bad;
+	}
+	fp = NULL;
+
+	if (rename(tmp_file, file)) {
+		log_sys_debug("rename", tmp_file);
+		goto bad;
+	}
+
+	log_debug("Saved regex cache %s with %u states.", file, num_states);
+	r = 1;
+	goto out;
+bad:
+	if (fp && fclose(fp))
+		stack;
+	if (unlink(tmp_file))
+		log_sys_debug("unlink", tmp_file);
+out:
+	for (i = 0; i < num_states; i++)
+		states[i]->id = 0;
+	dm_free(states);
+
+	return r;
+}
+
+struct dm_regex *dm_regex_create_cached(struct dm_pool *mem, const char * const *patterns,
+					unsigned num_patterns, const char *cache_file)
+{
+	uint64_t hash = _patterns_hash(patterns, num_patterns);
+	struct dm_regex *m;
+
+	if (!cache_file)
+		return dm_regex_create(mem, patterns, num_patterns);
+
+	if (!(m = dm_pool_zalloc(mem, sizeof(*m))))
+		return_NULL;
+
+	if (_load_dfa_cache(m, cache_file, hash, num_patterns)) {
+		log_debug("Using regex cache %s with %u states.", cache_file, m->num_states);
+		m->mem = mem;
+		return m;
+	}
+
+	dm_pool_free(mem, m);
+
+	if (!(m = dm_regex_create(mem, patterns, num_patterns)))
+		return_NULL;
+
+	/* Failing to save the cache is not fatal. */
+	if (!_save_dfa_cache(m, cache_file, hash, num_patterns))
+		log_debug("Failed to save regex cache %s.", cache_file);
+
+	return m;
+}
+
+void dm_regex_destroy(struct dm_regex *regex)
+{
+	if (regex->map) {
+		if (munmap(regex->map, regex->map_size))
+			log_sys_debug("munmap", "regex cache");
+		regex->map = NULL;
+		regex->table = NULL;
+		regex->final = NULL;
+	}
+}
+
 /*
  * The next block of code concerns calculating a fingerprint for the dfa.
  *
@@ -548,13 +866,57 @@ static uint32_t _fingerprint(struct printer *p)
         return result;
 }
 
+/*
+ * Same as _fingerprint() for the dfa table from cache file.
+ * Pending states are a stack, ids are assigned when first pushed.
+ */
+static uint32_t _fingerprint_table(const struct dm_regex *m)
+{
+	uint32_t *ids, *pending, next_id = 0, n, ns, result = 0;
+	unsigned sp = 0;
+	int c;
+
+	if (!(ids = dm_zalloc(m->num_states * sizeof(*ids))))
+		return_0;
+
+	if (!(pending = dm_malloc(m->num_states * sizeof(*pending)))) {
+		dm_free(ids);
+		return_0;
+	}
+
+	ids[0] = ++next_id;
+	pending[sp++] = 0;
+
+	while (sp) {
+		n = pending[--sp];
+		result = _combine(result, (m->final[n] < 0) ? 0 : (uint32_t) m->final[n]);
+		for (c = 0; c < 256; c++) {
+			if ((ns = m->table[n * 256 + c]) >= m->num_states)
+				continue;
+			if (!ids[ns]) {
+				ids[ns] = ++next_id;
+				pending[sp++] = ns;
+			}
+			result = _combine(result, ids[ns]);
+		}
+	}
+
+	dm_free(pending);
+	dm_free(ids);
+
+	return result;
+}
+
 uint32_t dm_regex_fingerprint(struct dm_regex *regex)
 {
         struct printer p;
         uint32_t result = 0;
-        struct dm_pool *mem = dm_pool_create("regex fingerprint", 1024);
+        struct dm_pool *mem;
+
+	if (regex->table)
+		return _fingerprint_table(regex);
 
-	if (!mem)
+	if (!(mem = dm_pool_create("regex fingerprint", 1024)))
 		return_0;
 
 	if (!_force_states(regex))
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * Query devices with one dm_task_batch and print, for each argument in
+ * order, its device number and its status or table lines.
+ *
+ * Usage: dmbatchtest [-v] [-t threads] status|table device...
+ *
+ * A device is a name, uuid:<uuid> or devno:<major>:<minor>.
+ * With -v library debug messages are printed.
+ */
+
+#include "libdm/libdevmapper.h"
+
+#include <unistd.h>
+
+int main(int argc, char *argv[])
+{
+	const char *dev_dir = getenv("DM_DEV_DIR");
+	struct dm_task_batch *batch;
+	struct dm_task *dmt;
+	struct dm_info info;
+	uint64_t start, length;
+	char *target_type, *params;
+	void *next;
+	unsigned threads = 4, major, minor;
+	int c, i, type, r = 0;
+
+	while ((c = getopt(argc, argv, "t:v")) != -1)
+		switch (c) {
+		case 't':
+			threads = (unsigned) atoi(optarg);
+			break;
+		case 'v':
+			dm_log_init_verbose(1);
+			break;
+		default:
+			return 2;
+		}
+
+	if (argc - optind < 2) {
+		fprintf(stderr, "Usage: %s [-v] [-t threads] status|table device...\n", argv[0]);
+		return 2;
+	}
+
+	if (dev_dir && *dev_dir && !dm_set_dev_dir(dev_dir)) {
+		fprintf(stderr, "Invalid DM_DEV_DIR environment variable value.\n");
+		return 2;
+	}
+
+	if (!strcmp(argv[optind], "status"))
+		type = DM_DEVICE_STATUS;
+	else if (!strcmp(argv[optind], "table"))
+		type = DM_DEVICE_TABLE;
+	else {
+		fprintf(stderr, "Unknown query %s.\n", argv[optind]);
+		return 2;
+	}
+
+	if (!(batch = dm_task_batch_create(type)))
+		return 1;
+
+	dm_task_batch_set_threads(batch, threads);
+
+	for (i = optind + 1; i < argc; i++) {
+		if (!strncmp(argv[i], "uuid:", 5))
+			r = dm_task_batch_add_uuid(batch, argv[i] + 5);
+		else if (sscanf(argv[i], "devno:%u:%u", &major, &minor) == 2)
+			r = dm_task_batch_add_devno(batch, major, minor);
+		else
+			r = dm_task_batch_add_name(batch, argv[i]);
+		if (!r) {
+			dm_task_batch_destroy(batch);
+			return 1;
+		}
+	}
+
+	r = dm_task_batch_run(batch);
+
+	for (i = optind + 1; i < argc; i++) {
+		if (!(dmt = dm_task_batch_get_task(batch, (unsigned) (i - optind - 1))) ||
+		    !dm_task_get_info(dmt, &info) || !info.exists) {
+			printf("%s: failed\n", argv[i]);
+			r = 0;
+			continue;
+		}
+
+		printf("%s: %u:%u\n", argv[i], info.major, info.minor);
+
+		next = NULL;
+		do {
+			next = dm_get_next_target(dmt, next, &start, &length,
+						  &target_type, &params);
+			if (target_type)
+				printf("%s: %" PRIu64 " %" PRIu64 " %s %s\n", argv[i],
+				       start, length, target_type, params);
+		} while (next);
+	}
+
+	dm_task_batch_destroy(batch);
+
+	return r ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+
+# Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+#
+# This copyrighted material is made available to anyone wishing to use,
+# modify, copy, or redistribute it subject to the terms and conditions
+# of the GNU General Public License v.2.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+# Test dm_task_batch queries match per-device dmsetup queries
+
+
+. lib/inittest --skip-with-lvmpolld --skip-with-lvmlockd
+
+# ensure we can create devices (uses dmsetup, etc)
+aux prepare_devs 3
+
+name1="${PREFIX}pv1"
+name2="${PREFIX}pv2"
+name3="${PREFIX}pv3"
+
+devno() {
+	dmsetup info -c --noheadings -o major,minor --separator : "$1"
+}
+
+# Lines printed by dmbatchtest for argument $1, without the prefix
+lines() {
+	awk -v p="$1: " 'index($0, p) == 1 { print substr($0, length(p) + 1) }' out
+}
+
+args=( "$name1" "uuid:TEST-$name2" "devno:$(devno "$name3")" )
+
+for threads in 1 4 ; do
+	dmbatchtest -v -t $threads table "${args[@]}" > out
+
+	# each device reports its device number and its table
+	for i in 1 2 3 ; do
+		name="${PREFIX}pv$i"
+		lines "${args[i - 1]}" > got
+		head -1 got | grep -Fx "$(devno "$name")"
+		dmsetup table "$name" > expected
+		tail -n +2 got | diff -w expected -
+	done
+done
+
+# status of a batch matches dmsetup status
+dmbatchtest status "$name1" "$name2" > out
+lines "$name2" | tail -n +2 > got
+dmsetup status "$name2" | diff -w - got
+
+# unknown devices fail individually, the others are still reported
+not dmbatchtest table "$name1" "${PREFIX}nosuchdev" "uuid:TEST-${PREFIX}nosuchdev" > out
+lines "$name1" | head -1 | grep -Fx "$(devno "$name1")"
+test "$(lines "${PREFIX}nosuchdev")" = "failed"
+test "$(lines "uuid:TEST-${PREFIX}nosuchdev")" = "failed"
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+
+# Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+#
+# This copyrighted material is made available to anyone wishing to use,
+# modify, copy, or redistribute it subject to the terms and conditions
+# of the GNU General Public License v.2.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+# Test lvcreate --snapshot with several thin origins
+
+
+
+export LVM_TEST_THIN_REPAIR_CMD=${LVM_TEST_THIN_REPAIR_CMD-/bin/false}
+
+. lib/inittest --skip-with-lvmpolld --skip-with-lvmlockd
+
+aux have_thin 1 0 0 || skip
+
+aux prepare_pvs 2 64
+get_devs
+
+vgcreate $SHARED -s 64K "$vg" "${DEVICES[@]}"
+
+lvcreate -L4M -V4M -T $vg/pool --name $lv1
+lvcreate -V4M -T $vg/pool --name $lv2
+lvcreate -L4M -V4M -T $vg/pool2 --name $lv3
+
+# One set over two pools, --name is the suffix
+lvcreate -s $vg/$lv1 $vg/$lv2 $vg/$lv3 --name snap
+check lv_field $vg/${lv1}_snap origin "$lv1"
+check lv_field $vg/${lv2}_snap origin "$lv2"
+check lv_field $vg/${lv3}_snap origin "$lv3"
+check lv_field $vg/${lv3}_snap pool_lv "pool2"
+
+# Persistent minor cannot be given to a set
+invalid lvcreate -s $vg/$lv1 $vg/$lv2 -My --major 253 --minor 250 --name snap2
+invalid lvcreate -s $vg/$lv1 $vg/$lv2 --minor 250 --name snap2
+check lv_not_exists $vg ${lv1}_snap2 ${lv2}_snap2
+
+# Whole set fails when one origin is not a thin volume
+not lvcreate -s $vg/$lv1 $vg/pool --name snap3
+check lv_not_exists $vg ${lv1}_snap3 pool_snap3
+
+# Pool above threshold refuses the whole set, as for a single snapshot
+dd if=/dev/zero of="$DM_DEV_DIR/$vg/$lv3" bs=1M count=3 oflag=direct
+not lvcreate --config 'activation/thin_pool_autoextend_threshold = 50' \
+	-s $vg/$lv1 $vg/$lv3 --name snap4 2>&1 | tee err
+grep "reached threshold" err
+check lv_not_exists $vg ${lv1}_snap4 ${lv3}_snap4
+
+# Inactive pools are activated for the checks and left inactive
+vgchange -an $vg
+lvcreate -s $vg/$lv1 $vg/$lv2 --name snap5
+check lv_exists $vg ${lv1}_snap5 ${lv2}_snap5
+check inactive $vg pool_tdata
+
+vgremove -ff $vg
@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+
+# Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+#
+# This copyrighted material is made available to anyone wishing to use,
+# modify, copy, or redistribute it subject to the terms and conditions
+# of the GNU General Public License v.2.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+# Metadata updates write the backup of the committed VG
+
+SKIP_WITH_LVMPOLLD=1
+
+. lib/inittest
+
+aux prepare_devs 2
+
+for check in 0 1 ; do
+	aux lvmconf "backup/archive = 1" "backup/backup = 1" \
+		    "metadata/check_written_metadata = $check"
+	rm -f "etc/backup/$vg"
+
+	vgcreate $SHARED $vg "$dev1"
+	test -f "etc/backup/$vg"
+
+	vgchange --addtag foo $vg
+	grep -q '"foo"' "etc/backup/$vg"
+
+	lvcreate -l1 -n $lv1 $vg
+	grep -q "$lv1" "etc/backup/$vg"
+
+	vgextend $vg "$dev2"
+	lvchange --addtag bar $vg/$lv1
+	grep -q '"bar"' "etc/backup/$vg"
+
+	# Backup content matches what vgcfgbackup writes
+	vgcfgbackup -f backup.txt $vg
+	diff <(grep -v '^[a-z_]* = ' "etc/backup/$vg" | grep -v '^#') \
+	     <(grep -v '^[a-z_]* = ' backup.txt | grep -v '^#')
+
+	vgremove -ff $vg
+done
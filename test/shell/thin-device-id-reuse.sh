@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+
+# Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+#
+# This copyrighted material is made available to anyone wishing to use,
+# modify, copy, or redistribute it subject to the terms and conditions
+# of the GNU General Public License v.2.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+# Test device_id of removed thin LV is reused
+
+
+
+export LVM_TEST_THIN_REPAIR_CMD=${LVM_TEST_THIN_REPAIR_CMD-/bin/false}
+
+. lib/inittest --skip-with-lvmpolld
+
+aux have_thin 1 0 0 || skip
+
+aux prepare_vg 2 64
+
+lvcreate -L4M -V4M -T $vg/pool --name $lv1
+lvcreate -V4M -T $vg/pool --name $lv2
+lvcreate -V4M -T $vg/pool --name $lv3
+check lv_field $vg/$lv1 thin_id "1"
+check lv_field $vg/$lv2 thin_id "2"
+check lv_field $vg/$lv3 thin_id "3"
+
+# Hole in the middle is reused first
+lvremove -f $vg/$lv2
+lvcreate -V4M -T $vg/pool --name $lv4
+check lv_field $vg/$lv4 thin_id "2"
+
+lvcreate -V4M -T $vg/pool --name $lv5
+check lv_field $vg/$lv5 thin_id "4"
+
+# Lowest of several holes
+lvremove -f $vg/$lv3 $vg/$lv1
+lvcreate -V4M -T $vg/pool --name $lv1
+check lv_field $vg/$lv1 thin_id "1"
+lvcreate -V4M -T $vg/pool --name $lv3
+check lv_field $vg/$lv3 thin_id "3"
+
+# Thin snapshot takes a hole as well
+lvremove -f $vg/$lv4
+lvcreate -s $vg/$lv1 --name snap
+check lv_field $vg/snap thin_id "2"
+
+vgremove -ff $vg
@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+
+# Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+#
+# This copyrighted material is made available to anyone wishing to use,
+# modify, copy, or redistribute it subject to the terms and conditions
+# of the GNU General Public License v.2.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+# Test dmeventd thin pool forecast with data_time_to_full and
+# extension of a growing pool before it reaches the threshold
+
+
+
+export LVM_TEST_THIN_REPAIR_CMD=${LVM_TEST_THIN_REPAIR_CMD-/bin/false}
+
+. lib/inittest --skip-with-lvmpolld
+
+# Wait for up to 30 seconds (3 dmeventd timeouts) for a field to change
+wait_field_() {
+	for i in $(seq 1 30) ; do
+		test "$(get lv_field $vg/pool "$1")" != "$2" && return
+		sleep 1
+	done
+	return 1
+}
+
+aux have_thin 1 10 0 || skip
+
+aux lvmconf "activation/thin_pool_autoextend_percent = 50" \
+	    "activation/thin_pool_autoextend_threshold = 95" \
+	    "dmeventd/thin_forecast = 3600"
+
+aux prepare_dmeventd
+
+aux prepare_pvs 2 64
+get_devs
+
+vgcreate $SHARED -s 256K "$vg" "${DEVICES[@]}"
+
+lvcreate -L4M -c 64k -T $vg/pool
+lvcreate -V4M $vg/pool -n $lv1
+
+# No prediction without usage growth
+check lv_field $vg/pool data_time_to_full ""
+check lv_field $vg/pool metadata_time_to_full ""
+
+# 12.5% used, let dmeventd take a sample
+dd if=/dev/zero of="$DM_DEV_DIR/mapper/$vg-$lv1" bs=512K count=1 conv=fdatasync
+sleep 11
+
+# 37.5% used, still below 50% so only the prediction is reported
+dd if=/dev/zero of="$DM_DEV_DIR/mapper/$vg-$lv1" bs=512K count=2 seek=1 conv=fdatasync
+wait_field_ data_time_to_full "" || die "No thin pool forecast!"
+
+lvs -a -o+data_time_to_full,metadata_time_to_full $vg
+seconds=$(get lv_field $vg/pool data_time_to_full)
+test "$seconds" -le 3600
+check lv_field $vg/pool size "4.00m"
+
+# 62.5% used, predicted to be full within thin_forecast seconds,
+# so the pool is extended although it is below the threshold
+dd if=/dev/zero of="$DM_DEV_DIR/mapper/$vg-$lv1" bs=512K count=2 seek=3 conv=fdatasync
+wait_field_ size "4.00m" || die "Thin pool was NOT extended!"
+
+lvs -a -o+data_time_to_full,metadata_time_to_full $vg
+
+vgremove -ff $vg
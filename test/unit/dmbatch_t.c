@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "units.h"
+#include "libdm/libdevmapper.h"
+
+/*
+ * These tests must not depend on the devices present on the host.
+ * DM_DEVICE_TABLE of a device that does not exist fails both with and
+ * without a device-mapper driver (unlike DM_DEVICE_INFO and
+ * DM_DEVICE_STATUS which report such a device as not existing), so
+ * every task of a batch below fails.  Without a driver not even the
+ * tasks can be created.  Successful lookups are covered by
+ * test/shell/dmsetup-batch.sh.
+ */
+#define NO_SUCH_NAME "unit-test-batch-no-such-device"
+#define NO_SUCH_UUID "UNIT-TEST-BATCH-NO-SUCH-UUID"
+
+struct prepare_calls {
+	unsigned count;
+	unsigned fail_at;	/* 1-based call number to fail, 0 never */
+	struct dm_task *tasks[8];
+};
+
+/* Number of tasks prepare_fn sees for nr_devs devices */
+static unsigned _expected_tasks(unsigned nr_devs)
+{
+	struct dm_task *dmt;
+
+	if (!(dmt = dm_task_create(DM_DEVICE_TABLE)))
+		return 0;
+
+	dm_task_destroy(dmt);
+
+	return nr_devs;
+}
+
+static int _prepare(struct dm_task *dmt, void *context)
+{
+	struct prepare_calls *calls = context;
+
+	if (calls->count < DM_ARRAY_SIZE(calls->tasks))
+		calls->tasks[calls->count] = dmt;
+
+	return (++calls->count != calls->fail_at);
+}
+
+static void _test_create(void *fixture)
+{
+	struct dm_task_batch *batch;
+
+	/* Only read-only queries can be batched */
+	T_ASSERT(!dm_task_batch_create(DM_DEVICE_CREATE));
+	T_ASSERT(!dm_task_batch_create(DM_DEVICE_RESUME));
+	T_ASSERT(!dm_task_batch_create(DM_DEVICE_LIST));
+
+	T_ASSERT(batch = dm_task_batch_create(DM_DEVICE_INFO));
+	T_ASSERT_EQUAL(dm_task_batch_get_count(batch), 0);
+	T_ASSERT(!dm_task_batch_get_task(batch, 0));
+
+	/* An empty batch has nothing to run */
+	T_ASSERT(dm_task_batch_run(batch));
+	dm_task_batch_destroy(batch);
+
+	/* Destroying NULL is allowed */
+	dm_task_batch_destroy(NULL);
+}
+
+static void _test_add(void *fixture)
+{
+	struct dm_task_batch *batch;
+	char name[64];
+	unsigned i;
+
+	T_ASSERT(batch = dm_task_batch_create(DM_DEVICE_TABLE));
+
+	/* Grows beyond the initial allocation */
+	for (i = 0; i < 40; i++) {
+		(void) snprintf(name, sizeof(name), "%s%u", NO_SUCH_NAME, i);
+		T_ASSERT(dm_task_batch_add_name(batch, name));
+	}
+	T_ASSERT(dm_task_batch_add_uuid(batch, NO_SUCH_UUID));
+	T_ASSERT(dm_task_batch_add_devno(batch, 0, 0));
+	T_ASSERT_EQUAL(dm_task_batch_get_count(batch), 42);
+
+	/* No tasks before the batch ran */
+	for (i = 0; i < 42; i++)
+		T_ASSERT(!dm_task_batch_get_task(batch, i));
+
+	dm_task_batch_destroy(batch);
+}
+
+/* Each device is queried by its own identity and fails on its own */
+static void _run_failing(unsigned threads)
+{
+	struct prepare_calls calls = { 0 };
+	struct dm_task_batch *batch;
+	unsigned i;
+
+	T_ASSERT(batch = dm_task_batch_create(DM_DEVICE_TABLE));
+	dm_task_batch_set_threads(batch, threads);
+	dm_task_batch_set_prepare_fn(batch, _prepare, &calls);
+
+	T_ASSERT(dm_task_batch_add_name(batch, NO_SUCH_NAME "1"));
+	T_ASSERT(dm_task_batch_add_uuid(batch, NO_SUCH_UUID));
+	T_ASSERT(dm_task_batch_add_name(batch, NO_SUCH_NAME "2"));
+	T_ASSERT(dm_task_batch_add_devno(batch, 0, 0));
+
+	T_ASSERT(!dm_task_batch_run(batch));
+
+	/* prepare_fn saw one task per device */
+	T_ASSERT_EQUAL(calls.count, _expected_tasks(4));
+	for (i = 0; i < calls.count; i++)
+		T_ASSERT(calls.tasks[i]);
+
+	/* Failed tasks are released */
+	for (i = 0; i < 4; i++)
+		T_ASSERT(!dm_task_batch_get_task(batch, i));
+
+	/* A batch runs once and takes no devices afterwards */
+	T_ASSERT(!dm_task_batch_run(batch));
+	T_ASSERT(!dm_task_batch_add_name(batch, NO_SUCH_NAME "3"));
+	T_ASSERT(!dm_task_batch_add_devno(batch, 0, 1));
+	T_ASSERT_EQUAL(dm_task_batch_get_count(batch), 4);
+
+	dm_task_batch_destroy(batch);
+}
+
+static void _test_run_failing(void *fixture)
+{
+	_run_failing(1);
+}
+
+static void _test_run_failing_threads(void *fixture)
+{
+	/* More threads than devices and more than the upper limit */
+	_run_failing(8);
+	_run_failing(1000);
+	/* 0 is serial */
+	_run_failing(0);
+}
+
+static void _test_prepare_fails(void *fixture)
+{
+	struct prepare_calls calls = { .fail_at = 2 };
+	struct dm_task_batch *batch;
+
+	T_ASSERT(batch = dm_task_batch_create(DM_DEVICE_TABLE));
+	dm_task_batch_set_prepare_fn(batch, _prepare, &calls);
+
+	T_ASSERT(dm_task_batch_add_devno(batch, 0, 0));
+	T_ASSERT(dm_task_batch_add_devno(batch, 0, 1));
+	T_ASSERT(dm_task_batch_add_devno(batch, 0, 2));
+
+	/* The failing device does not stop the others */
+	T_ASSERT(!dm_task_batch_run(batch));
+	T_ASSERT_EQUAL(calls.count, _expected_tasks(3));
+	T_ASSERT(!dm_task_batch_get_task(batch, 1));
+
+	dm_task_batch_destroy(batch);
+}
+
+void dm_task_batch_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(NULL, NULL);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	register_test(ts, "/device-mapper/batch/create", "task batch types and empty batch", _test_create);
+	register_test(ts, "/device-mapper/batch/add", "adding devices to a task batch", _test_add);
+	register_test(ts, "/device-mapper/batch/run-failing", "failing tasks of a batch", _test_run_failing);
+	register_test(ts, "/device-mapper/batch/run-failing-threads", "failing tasks of a threaded batch", _test_run_failing_threads);
+	register_test(ts, "/device-mapper/batch/prepare-fails", "failing prepare_fn of a batch", _test_prepare_fails);
+	dm_list_add(all_tests, &ts->list);
+}
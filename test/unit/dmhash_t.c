@@ -45,6 +45,53 @@ static void test_hash_insert(void *fixture)
 	dm_hash_destroy(hash);
 }
 
+/* Table created with a tiny hint must grow and keep all entries reachable */
+static void test_hash_grow(void *fixture)
+{
+	struct dm_hash_table *hash = dm_hash_create(16);
+	struct dm_hash_node *node;
+	unsigned i, count = 0;
+	char key[32];
+
+	T_ASSERT(hash);
+
+	for (i = 0; i < 5000; i++) {
+		snprintf(key, sizeof(key), "key%u", i);
+		T_ASSERT(dm_hash_insert(hash, key, (void *)(uintptr_t)(i + 1)));
+	}
+
+	/* multiple values with the same key keep their order */
+	T_ASSERT(dm_hash_insert_allow_multiple(hash, "dup", "a", 2));
+	T_ASSERT(dm_hash_insert_allow_multiple(hash, "dup", "b", 2));
+
+	for (i = 0; i < 5000; i++) {
+		snprintf(key, sizeof(key), "key%u", i);
+		T_ASSERT_EQUAL((uintptr_t) dm_hash_lookup(hash, key), i + 1);
+	}
+
+	T_ASSERT(dm_hash_lookup_with_val(hash, "dup", "a", 2));
+	T_ASSERT(dm_hash_lookup_with_val(hash, "dup", "b", 2));
+	T_ASSERT_EQUAL(dm_hash_get_num_entries(hash), 5002);
+
+	for (node = dm_hash_get_first(hash); node; node = dm_hash_get_next(hash, node))
+		count++;
+	T_ASSERT_EQUAL(count, 5002);
+
+	/* removal after growing leaves the other entries reachable */
+	for (i = 0; i < 5000; i += 2) {
+		snprintf(key, sizeof(key), "key%u", i);
+		dm_hash_remove(hash, key);
+	}
+	T_ASSERT_EQUAL(dm_hash_get_num_entries(hash), 2502);
+
+	for (i = 0; i < 5000; i++) {
+		snprintf(key, sizeof(key), "key%u", i);
+		T_ASSERT_EQUAL((uintptr_t) dm_hash_lookup(hash, key), (i & 1) ? i + 1 : 0);
+	}
+
+	dm_hash_destroy(hash);
+}
+
 #define T(path, desc, fn) register_test(ts, "/base/data-struct/hash/" path, desc, fn)
 
 void dm_hash_tests(struct dm_list *all_tests)
@@ -56,6 +103,7 @@ void dm_hash_tests(struct dm_list *all_tests)
 	}
 
 	T("insert", "inserting hash elements", test_hash_insert);
+	T("grow", "growing hash table keeps all elements", test_hash_grow);
 
 	dm_list_add(all_tests, &ts->list);
 }
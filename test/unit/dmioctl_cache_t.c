@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "units.h"
+#include "libdm/libdevmapper.h"
+#include "libdm/ioctl/libdm-ioctl-cache.h"
+
+#include <stdlib.h>
+
+/*
+ * The cache is per thread and these tests share it, so they only
+ * check changes relative to the state they find.
+ */
+
+static void _test_grow(void *fixture)
+{
+	unsigned table = dm_ioctl_buffer_doublings(DM_DEVICE_TABLE);
+	unsigned status = dm_ioctl_buffer_doublings(DM_DEVICE_STATUS);
+
+	T_ASSERT(dm_ioctl_buffer_grow(DM_DEVICE_TABLE));
+	T_ASSERT_EQUAL(dm_ioctl_buffer_doublings(DM_DEVICE_TABLE), table + 1);
+	T_ASSERT(dm_ioctl_buffer_grow(DM_DEVICE_TABLE));
+	T_ASSERT_EQUAL(dm_ioctl_buffer_doublings(DM_DEVICE_TABLE), table + 2);
+
+	/* Kept per ioctl type */
+	T_ASSERT_EQUAL(dm_ioctl_buffer_doublings(DM_DEVICE_STATUS), status);
+
+	/* Invalid types never grow */
+	T_ASSERT(!dm_ioctl_buffer_grow(-1));
+	T_ASSERT(!dm_ioctl_buffer_grow(DM_DEVICE_GET_TARGET_VERSION + 1));
+	T_ASSERT_EQUAL(dm_ioctl_buffer_doublings(-1), 0);
+}
+
+static void _test_grow_max(void *fixture)
+{
+	unsigned i = dm_ioctl_buffer_doublings(DM_DEVICE_DEPS);
+
+	while (dm_ioctl_buffer_grow(DM_DEVICE_DEPS))
+		T_ASSERT(++i <= DM_IOCTL_BUFFER_MAX_DOUBLINGS);
+
+	T_ASSERT_EQUAL(i, DM_IOCTL_BUFFER_MAX_DOUBLINGS);
+	T_ASSERT_EQUAL(dm_ioctl_buffer_doublings(DM_DEVICE_DEPS), DM_IOCTL_BUFFER_MAX_DOUBLINGS);
+	/* 16KB << 16 */
+	T_ASSERT_EQUAL((size_t) 16 * 1024 << dm_ioctl_buffer_doublings(DM_DEVICE_DEPS),
+		       (size_t) 1024 * 1024 * 1024);
+}
+
+/* Take and drop any spare left by another test */
+static void _drop_spare(void)
+{
+	struct dm_ioctl *dmi;
+	size_t size;
+
+	T_ASSERT(dmi = dm_ioctl_buffer_alloc(1, &size));
+	dm_ioctl_buffer_free(dmi, size, 1);
+}
+
+static void _test_reuse(void *fixture)
+{
+	struct dm_ioctl *dmi, *dmi2;
+	size_t size, size2;
+
+	_drop_spare();
+
+	/* Leaves a spare of the maximal cached size */
+	T_ASSERT(dmi = dm_ioctl_buffer_alloc(DM_IOCTL_CACHE_MAX_SIZE, &size));
+	T_ASSERT_EQUAL(size, DM_IOCTL_CACHE_MAX_SIZE);
+	memset(dmi, 0xff, size);
+	dm_ioctl_buffer_free(dmi, size, 0);
+
+	/* Smaller request gets the whole spare, cleared */
+	T_ASSERT(dmi = dm_ioctl_buffer_alloc(16 * 1024, &size));
+	T_ASSERT_EQUAL(size, DM_IOCTL_CACHE_MAX_SIZE);
+	T_ASSERT(!((char *) dmi)[0] && !((char *) dmi)[16 * 1024 - 1]);
+
+	/* Spare is taken, next one is allocated */
+	T_ASSERT(dmi2 = dm_ioctl_buffer_alloc(16 * 1024, &size2));
+	T_ASSERT_EQUAL(size2, 16 * 1024);
+
+	/* The larger buffer stays cached */
+	dm_ioctl_buffer_free(dmi2, size2, 0);
+	dm_ioctl_buffer_free(dmi, size, 0);
+	T_ASSERT(dmi = dm_ioctl_buffer_alloc(2 * 1024, &size));
+	T_ASSERT_EQUAL(size, DM_IOCTL_CACHE_MAX_SIZE);
+	dm_ioctl_buffer_free(dmi, size, 0);
+}
+
+static void _test_no_cache(void *fixture)
+{
+	struct dm_ioctl *dmi;
+	size_t size;
+
+	_drop_spare();
+
+	/* Buffers with secure data are not cached */
+	T_ASSERT(dmi = dm_ioctl_buffer_alloc(DM_IOCTL_CACHE_MAX_SIZE, &size));
+	dm_ioctl_buffer_free(dmi, size, 1);
+	T_ASSERT(dmi = dm_ioctl_buffer_alloc(2 * 1024, &size));
+	T_ASSERT_EQUAL(size, 2 * 1024);
+	dm_ioctl_buffer_free(dmi, size, 1);
+
+	/* Nor are huge buffers */
+	T_ASSERT(dmi = dm_ioctl_buffer_alloc(2 * DM_IOCTL_CACHE_MAX_SIZE, &size));
+	T_ASSERT_EQUAL(size, 2 * DM_IOCTL_CACHE_MAX_SIZE);
+	dm_ioctl_buffer_free(dmi, size, 0);
+	T_ASSERT(dmi = dm_ioctl_buffer_alloc(2 * 1024, &size));
+	T_ASSERT_EQUAL(size, 2 * 1024);
+	dm_ioctl_buffer_free(dmi, size, 0);
+}
+
+#define T(path, desc, fn) register_test(ts, "/libdm/ioctl-cache/" path, desc, fn)
+
+void dm_ioctl_cache_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(NULL, NULL);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	T("grow", "buffer size doubles per ioctl type", _test_grow);
+	T("grow-max", "buffer size doubling stops at the maximum", _test_grow_max);
+	T("reuse", "spare buffer is reused", _test_reuse);
+	T("no-cache", "secure and huge buffers are not cached", _test_no_cache);
+
+	dm_list_add(all_tests, &ts->list);
+}
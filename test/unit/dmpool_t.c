@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "units.h"
+#include "libdm/libdevmapper.h"
+
+//----------------------------------------------------------------
+
+static void _stats_delta(struct dm_pool_cache_stats *before,
+			 struct dm_pool_cache_stats *delta)
+{
+	struct dm_pool_cache_stats now;
+
+	dm_pool_get_cache_stats(&now);
+
+	delta->hits = now.hits - before->hits;
+	delta->misses = now.misses - before->misses;
+	delta->recycled = now.recycled - before->recycled;
+	delta->overflows = now.overflows - before->overflows;
+	delta->cached_bytes = now.cached_bytes;
+}
+
+static void _test_recycle(void *fixture)
+{
+	struct dm_pool_cache_stats before, delta;
+	struct dm_pool *mem;
+	char *p;
+	unsigned i;
+
+	dm_pool_get_cache_stats(&before);
+
+	/* 3KiB hint rounds up to 4KiB chunks */
+	T_ASSERT(mem = dm_pool_create("recycle1", 3 * 1024));
+	T_ASSERT(p = dm_pool_alloc(mem, 1000));
+	memset(p, 0xaa, 1000);
+	dm_pool_destroy(mem);
+
+	T_ASSERT(mem = dm_pool_create("recycle2", 3 * 1024));
+	for (i = 0; i < 3; i++) {
+		T_ASSERT(p = dm_pool_zalloc(mem, 1000));
+		T_ASSERT(!p[0] && !p[999]);
+	}
+	dm_pool_destroy(mem);
+
+	_stats_delta(&before, &delta);
+	T_ASSERT(delta.hits >= 1);
+	T_ASSERT(delta.recycled >= 2);
+	T_ASSERT(delta.cached_bytes >= 4096);
+}
+
+static void _test_oversized(void *fixture)
+{
+	struct dm_pool_cache_stats before, delta;
+	struct dm_pool *mem;
+
+	dm_pool_get_cache_stats(&before);
+
+	/* Chunks above the largest size class are never cached */
+	T_ASSERT(mem = dm_pool_create("oversized", 256 * 1024));
+	T_ASSERT(dm_pool_alloc(mem, 1024));
+	T_ASSERT(dm_pool_alloc(mem, 300 * 1024));
+	dm_pool_destroy(mem);
+
+	_stats_delta(&before, &delta);
+	T_ASSERT_EQUAL(delta.recycled, 0);
+	T_ASSERT_EQUAL(delta.hits, 0);
+}
+
+static void _test_bounded(void *fixture)
+{
+	struct dm_pool_cache_stats before, delta;
+	struct dm_pool *mem[64];
+	unsigned i;
+
+	dm_pool_get_cache_stats(&before);
+
+	for (i = 0; i < DM_ARRAY_SIZE(mem); i++) {
+		T_ASSERT(mem[i] = dm_pool_create("bounded", 100));
+		T_ASSERT(dm_pool_alloc(mem[i], 100));
+	}
+
+	for (i = 0; i < DM_ARRAY_SIZE(mem); i++)
+		dm_pool_destroy(mem[i]);
+
+	_stats_delta(&before, &delta);
+	T_ASSERT(delta.overflows > 0);
+	T_ASSERT(delta.recycled < DM_ARRAY_SIZE(mem));
+	T_ASSERT(delta.cached_bytes <= 1024 * 1024);
+}
+
+/*
+ * Mirrors the pools of a vg_read()/release_vg() cycle: the VG pool,
+ * a format instance pool, a metadata config tree and a few report
+ * style pools, each filled with small LV/segment sized objects and
+ * strings, then destroyed.
+ */
+static void _vg_cycle(void)
+{
+	struct dm_pool *vg_mem, *fid_mem, *cft_mem, *rep_mem;
+	unsigned i;
+	char name[32];
+
+	T_ASSERT(vg_mem = dm_pool_create("vg_mem", 63000));
+	T_ASSERT(fid_mem = dm_pool_create("fid", 1024));
+	T_ASSERT(cft_mem = dm_pool_create("config", 10 * 1024));
+	T_ASSERT(rep_mem = dm_pool_create("report", 1024));
+
+	for (i = 0; i < 200; i++) {
+		(void) snprintf(name, sizeof(name), "lvol%u", i);
+		T_ASSERT(dm_pool_zalloc(vg_mem, 320));
+		T_ASSERT(dm_pool_zalloc(vg_mem, 160));
+		T_ASSERT(dm_pool_strdup(vg_mem, name));
+		T_ASSERT(dm_pool_zalloc(cft_mem, 48));
+		T_ASSERT(dm_pool_strdup(cft_mem, name));
+	}
+
+	for (i = 0; i < 20; i++) {
+		T_ASSERT(dm_pool_zalloc(fid_mem, 64));
+		T_ASSERT(dm_pool_zalloc(rep_mem, 200));
+	}
+
+	dm_pool_destroy(rep_mem);
+	dm_pool_destroy(cft_mem);
+	dm_pool_destroy(fid_mem);
+	dm_pool_destroy(vg_mem);
+}
+
+static void _test_vg_cycle(void *fixture)
+{
+	struct dm_pool_cache_stats before, delta;
+	unsigned cycle;
+
+	_vg_cycle();
+
+	/* Once warm, repeated cycles take all their chunks from the cache */
+	dm_pool_get_cache_stats(&before);
+	for (cycle = 0; cycle < 10; cycle++)
+		_vg_cycle();
+	_stats_delta(&before, &delta);
+
+	T_ASSERT(delta.hits > 0);
+	T_ASSERT_EQUAL(delta.misses, 0);
+	T_ASSERT_EQUAL(delta.overflows, 0);
+}
+
+//----------------------------------------------------------------
+
+#define T(path, desc, fn) register_test(ts, "/base/memory/pool/" path, desc, fn)
+
+void dm_pool_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(NULL, NULL);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	T("recycle", "chunks of destroyed pools are reused", _test_recycle);
+	T("oversized", "large chunks bypass the chunk cache", _test_oversized);
+	T("bounded", "chunk cache is bounded", _test_bounded);
+	T("vg-cycle", "vg_read style pool cycles reuse chunks", _test_vg_cycle);
+
+	dm_list_add(all_tests, &ts->list);
+}
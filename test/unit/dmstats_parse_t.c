@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * @stats_print responses only come from the kernel, so the parsers of
+ * libdm-stats-parse.c are tested directly through its private header.
+ */
+#include "units.h"
+#include "libdm/libdm-stats.h"
+
+#include <stdlib.h>
+
+#define ROW(start, len) #start "+" #len " 1 2 3 4 5 6 7 8 9 10 11 12 13"
+
+struct fixture {
+	struct dm_stats *dms;
+	struct dm_stats_region *region;
+};
+
+static void *_fixture_init(void)
+{
+	struct fixture *f = dm_zalloc(sizeof(*f));
+
+	T_ASSERT(f);
+	T_ASSERT(f->dms = dm_stats_create("unit-test"));
+
+	/* A regions table with region 1 present, as after @stats_list */
+	T_ASSERT(f->dms->regions = dm_pool_zalloc(f->dms->mem, 2 * sizeof(*f->dms->regions)));
+	f->dms->regions[0].region_id = DM_STATS_REGION_NOT_PRESENT;
+	f->dms->regions[1].region_id = 1;
+	f->dms->max_region = 1;
+	f->dms->nr_regions = 1;
+	f->region = &f->dms->regions[1];
+
+	return f;
+}
+
+static void _fixture_exit(void *fixture)
+{
+	struct fixture *f = fixture;
+
+	/* Everything else lives in the pools of the handle */
+	f->dms->regions = NULL;
+	dm_stats_destroy(f->dms);
+	dm_free(f);
+}
+
+static int _parse_u64(const char *str, uint64_t *val, const char **end)
+{
+	const char *c = str;
+	int r = stats_parse_u64(&c, val);
+
+	*end = c;
+
+	return r;
+}
+
+static void _test_parse_u64(void *fixture)
+{
+	const char *end;
+	uint64_t v = 7;
+
+	T_ASSERT(_parse_u64("0", &v, &end));
+	T_ASSERT_EQUAL(v, 0);
+	T_ASSERT(!*end);
+
+	T_ASSERT(_parse_u64("12+8", &v, &end));
+	T_ASSERT_EQUAL(v, 12);
+	T_ASSERT_EQUAL(*end, '+');
+
+	T_ASSERT(_parse_u64("18446744073709551615", &v, &end));
+	T_ASSERT_EQUAL(v, UINT64_MAX);
+
+	/* Input is left alone when nothing is parsed */
+	v = 7;
+	T_ASSERT(!_parse_u64("18446744073709551616", &v, &end));
+	T_ASSERT(!_parse_u64("18446744073709551620", &v, &end));
+	T_ASSERT(!_parse_u64("99999999999999999999", &v, &end));
+	T_ASSERT(!_parse_u64("", &v, &end));
+	T_ASSERT(!_parse_u64("-1", &v, &end));
+	T_ASSERT(!_parse_u64(" 1", &v, &end));
+	T_ASSERT(!_parse_u64("x", &v, &end));
+	T_ASSERT_EQUAL(*end, 'x');
+	T_ASSERT_EQUAL(v, 7);
+}
+
+static void _test_parse_region(void *fixture)
+{
+	struct fixture *f = fixture;
+	struct dm_stats_counters *c;
+	int i;
+
+	T_ASSERT(stats_parse_region(f->dms,
+				     ROW(0, 8) "\n"
+				     "8+8 11 12 13 14 15 16 17 18 19 20 21 22 23\n",
+				     f->region, 1));
+	T_ASSERT_EQUAL(f->region->start, 0);
+	T_ASSERT_EQUAL(f->region->len, 16);
+	T_ASSERT_EQUAL(f->region->step, 8);
+	T_ASSERT_EQUAL(dm_stats_get_region_nr_areas(f->dms, 1), 2);
+
+	/* Counters are stored in dm_stats_counter_t order */
+	for (i = 0; i < DM_STATS_NR_COUNTERS; i++) {
+		T_ASSERT_EQUAL(stats_counter_field(&f->region->counters[0], i), i + 1);
+		T_ASSERT_EQUAL(stats_counter_field(&f->region->counters[1], i), i + 11);
+	}
+	T_ASSERT(!f->region->counters[0].histogram);
+
+	/* Last row without newline, millisecond counters are scaled */
+	T_ASSERT(stats_parse_region(f->dms, ROW(2048, 1024), f->region, 1000000));
+	T_ASSERT_EQUAL(f->region->start, 2048);
+	T_ASSERT_EQUAL(f->region->len, 1024);
+	c = &f->region->counters[0];
+	T_ASSERT_EQUAL(c->reads, 1);
+	T_ASSERT_EQUAL(c->read_sectors, 3);
+	T_ASSERT_EQUAL(c->read_nsecs, 4000000);
+	T_ASSERT_EQUAL(c->write_nsecs, 8000000);
+	T_ASSERT_EQUAL(c->io_in_progress, 9);
+	T_ASSERT_EQUAL(c->io_nsecs, 10000000);
+	T_ASSERT_EQUAL(c->weighted_io_nsecs, 11000000);
+	T_ASSERT_EQUAL(c->total_read_nsecs, 12000000);
+	T_ASSERT_EQUAL(c->total_write_nsecs, 13000000);
+
+	/* Extra spaces between counters are accepted */
+	T_ASSERT(stats_parse_region(f->dms, "0+8  1 2 3 4 5 6 7 8 9 10 11 12 13\n",
+				     f->region, 1));
+	T_ASSERT_EQUAL(f->region->counters[0].total_write_nsecs, 13);
+}
+
+static void _test_parse_region_malformed(void *fixture)
+{
+	static const char *const _bad[] = {
+		"",				/* no areas */
+		"\n",
+		"0 8 1 2 3 4 5 6 7 8 9 10 11 12 13",	/* no '+' */
+		"0+ 1 2 3 4 5 6 7 8 9 10 11 12 13",	/* no length */
+		"+8 1 2 3 4 5 6 7 8 9 10 11 12 13",	/* no start */
+		"0+8 1 2 3 4 5 6 7 8 9 10 11 12",	/* too few counters */
+		"0+8 1 2 3 4 5 6 7 8 9 10 11 12\n8+8 1 2 3 4 5 6 7 8 9 10 11 12 13",
+		"0+8 1 2 3 4 5 6 7 8 9 10 11 x 13",	/* not a number */
+		"0+8 1 2 3 4 5 6 7 8 9 10 11 -12 13",
+		"0+8 1 2 3 4 5 6 7 8 9 10 11 12 18446744073709551616",	/* overflow */
+		"18446744073709551616+8 1 2 3 4 5 6 7 8 9 10 11 12 13",
+		ROW(0, 8) "\n" "8+8 1 2 3\n",	/* truncated second row */
+		NULL
+	};
+	struct fixture *f = fixture;
+	unsigned i;
+
+	T_ASSERT(!stats_parse_region(f->dms, NULL, f->region, 1));
+
+	for (i = 0; _bad[i]; i++)
+		if (stats_parse_region(f->dms, _bad[i], f->region, 1))
+			test_fail("accepted malformed @stats_print row: '%s'", _bad[i]);
+
+	/* The pool is still usable after abandoned objects */
+	T_ASSERT(stats_parse_region(f->dms, ROW(0, 8), f->region, 1));
+}
+
+static void _test_parse_histogram(void *fixture)
+{
+	struct fixture *f = fixture;
+	struct dm_histogram *h;
+
+	char spec[] = "histogram:10,20,30";
+
+	/* Three bounds from @stats_list make four bins */
+	f->region->timescale = 1;
+	T_ASSERT(stats_parse_histogram_spec(f->dms, f->region, spec));
+	T_ASSERT_EQUAL(f->region->bounds->nr_bins, 4);
+	T_ASSERT_EQUAL(f->region->bounds->bins[3].upper, UINT64_MAX);
+
+	T_ASSERT(stats_parse_region(f->dms,
+				     ROW(0, 8) " 5:6:7:8\n"
+				     ROW(8, 8) " 0:0:0:18446744073709551615\n",
+				     f->region, 1));
+
+	h = f->region->counters[0].histogram;
+	T_ASSERT(h);
+	T_ASSERT_EQUAL(h->nr_bins, 4);
+	T_ASSERT_EQUAL(h->sum, 5 + 6 + 7 + 8);
+	T_ASSERT_EQUAL(h->bins[0].count, 5);
+	T_ASSERT_EQUAL(h->bins[3].count, 8);
+	T_ASSERT_EQUAL(h->bins[1].upper, f->region->bounds->bins[1].upper);
+	T_ASSERT(h->region == f->region);
+	/* Counters before the histogram are not affected */
+	T_ASSERT_EQUAL(f->region->counters[0].total_write_nsecs, 13);
+
+	h = f->region->counters[1].histogram;
+	T_ASSERT_EQUAL(h->bins[3].count, UINT64_MAX);
+
+	/* Fewer values than bins */
+	T_ASSERT(!stats_parse_region(f->dms, ROW(0, 8) " 1:2\n", f->region, 1));
+	/* Histogram configured but missing from the row */
+	T_ASSERT(!stats_parse_region(f->dms, ROW(0, 8) "\n", f->region, 1));
+	/* More values than bins */
+	T_ASSERT(!stats_parse_region(f->dms, ROW(0, 8) " 1:2:3:4:5\n", f->region, 1));
+	/* Bad characters and overflow */
+	T_ASSERT(!stats_parse_region(f->dms, ROW(0, 8) " 1:x:3:4\n", f->region, 1));
+	T_ASSERT(!stats_parse_region(f->dms, ROW(0, 8) " 1::3:4\n", f->region, 1));
+	T_ASSERT(!stats_parse_region(f->dms, ROW(0, 8) " 1:2;3:4\n", f->region, 1));
+	T_ASSERT(!stats_parse_region(f->dms, ROW(0, 8) " 1:2:3:18446744073709551616\n",
+				      f->region, 1));
+
+	T_ASSERT(stats_parse_region(f->dms, ROW(0, 8) " 1:2:3:4", f->region, 1));
+	T_ASSERT_EQUAL(f->region->counters[0].histogram->sum, 10);
+}
+
+static void _test_delta(void *fixture)
+{
+	struct fixture *f = fixture;
+	struct dm_stats_delta *delta;
+	const uint64_t *ids;
+	uint64_t nr;
+
+	T_ASSERT(delta = dm_stats_delta_create());
+
+	/* Nothing parsed yet */
+	T_ASSERT(!dm_stats_delta_update(delta, f->dms, 1, &ids, &nr));
+
+	T_ASSERT(stats_parse_region(f->dms,
+				     ROW(0, 8) "\n" ROW(8, 8) "\n" ROW(16, 8) "\n",
+				     f->region, 1));
+
+	/* Invalid regions */
+	T_ASSERT(!dm_stats_delta_update(delta, f->dms, 0, &ids, &nr));
+	T_ASSERT(!dm_stats_delta_update(delta, f->dms, 2, &ids, &nr));
+	T_ASSERT(!dm_stats_delta_update(delta, f->dms, 1 | DM_STATS_WALK_GROUP, &ids, &nr));
+
+	/* First sample: every area is new, values are absolute */
+	T_ASSERT(dm_stats_delta_update(delta, f->dms, 1, &ids, &nr));
+	T_ASSERT_EQUAL(nr, 3);
+	T_ASSERT_EQUAL(ids[0], 0);
+	T_ASSERT_EQUAL(ids[2], 2);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_READS_COUNT, 1, 1), 1);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_TOTAL_WRITE_NSECS, 1, 2), 13);
+
+	/* Only area 1 changed, in two counters */
+	T_ASSERT(stats_parse_region(f->dms,
+				     ROW(0, 8) "\n"
+				     "8+8 6 2 3 4 5 6 7 8 9 10 11 12 20\n"
+				     ROW(16, 8) "\n",
+				     f->region, 1));
+	T_ASSERT(dm_stats_delta_update(delta, f->dms, 1, &ids, &nr));
+	T_ASSERT_EQUAL(nr, 1);
+	T_ASSERT_EQUAL(ids[0], 1);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_READS_COUNT, 1, 1), 5);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_TOTAL_WRITE_NSECS, 1, 1), 7);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_READS_COUNT, 1, 0), 0);
+
+	/* Unchanged sample: nothing reported, deltas drop to zero */
+	T_ASSERT(dm_stats_delta_update(delta, f->dms, 1, &ids, &nr));
+	T_ASSERT_EQUAL(nr, 0);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_READS_COUNT, 1, 1), 0);
+
+	/* Invalid counters */
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_READS_COUNT, 1, 3), 0);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_READS_COUNT, 0, 0), 0);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_READS_COUNT, 5, 0), 0);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_NR_COUNTERS, 1, 0), 0);
+
+	/* Region re-created with another geometry starts over */
+	T_ASSERT(stats_parse_region(f->dms, "0+8 9 9 9 9 9 9 9 9 9 9 9 9 9\n",
+				     f->region, 1));
+	T_ASSERT(dm_stats_delta_update(delta, f->dms, 1, &ids, &nr));
+	T_ASSERT_EQUAL(nr, 1);
+	T_ASSERT_EQUAL(dm_stats_delta_get_counter(delta, DM_STATS_READS_COUNT, 1, 0), 9);
+
+	dm_stats_delta_destroy(delta);
+	dm_stats_delta_destroy(NULL);
+}
+
+#define T(path, desc, fn) register_test(ts, "/device-mapper/stats/parse/" path, desc, fn)
+
+void dm_stats_parse_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(_fixture_init, _fixture_exit);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	T("u64", "parse unsigned counter values", _test_parse_u64);
+	T("region", "parse @stats_print rows", _test_parse_region);
+	T("region-malformed", "reject malformed @stats_print rows", _test_parse_region_malformed);
+	T("histogram", "parse @stats_print histograms", _test_parse_histogram);
+	T("delta", "compare samples with dm_stats_delta", _test_delta);
+
+	dm_list_add(all_tests, &ts->list);
+}
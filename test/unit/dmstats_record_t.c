@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "units.h"
+#include "libdm/libdevmapper.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+struct fixture {
+	char fname[32];
+};
+
+static void *_record_init(void)
+{
+	struct fixture *f = malloc(sizeof(*f));
+	int fd;
+
+	T_ASSERT(f);
+	snprintf(f->fname, sizeof(f->fname), "unit-test-XXXXXX");
+	/* coverity[secure_temp] don't care */
+	fd = mkstemp(f->fname);
+	T_ASSERT(fd >= 0);
+	(void) close(fd);
+
+	return f;
+}
+
+static void _record_exit(void *fixture)
+{
+	struct fixture *f = fixture;
+
+	(void) unlink(f->fname);
+	free(f);
+}
+
+/*
+ * Sample n of series s: reads = n + 1, writes = 10 * s and all I/O
+ * in bin (n % 3).
+ */
+static void _fill(struct dm_stats_record *rec, unsigned nr_samples)
+{
+	uint64_t counters[DM_STATS_NR_COUNTERS] = { 0 }, bins[3];
+	unsigned n, s;
+
+	for (n = 0; n < nr_samples; n++) {
+		for (s = 0; s < 2; s++) {
+			counters[DM_STATS_READS_COUNT] = n + 1;
+			counters[DM_STATS_WRITES_COUNT] = 10 * s;
+			bins[0] = bins[1] = bins[2] = 0;
+			bins[n % 3] = 100;
+			T_ASSERT(dm_stats_record_set_values(rec, s, counters, bins, 3));
+		}
+		T_ASSERT(dm_stats_record_commit(rec, (n + 1) * 1000, 1000));
+	}
+}
+
+static void _test_ring(void *fixture)
+{
+	const char *path = ((struct fixture *) fixture)->fname;
+	struct dm_histogram *bounds = dm_histogram_bounds_from_string("10ns,20ns,30ns");
+	struct dm_stats_record *rec, *rd;
+	uint64_t v;
+
+	T_ASSERT(bounds);
+	T_ASSERT(rec = dm_stats_record_create(path, 2, 3, 4));
+	T_ASSERT(dm_stats_record_set_series(rec, 0, "vg-lv0", 0, bounds));
+	T_ASSERT(dm_stats_record_set_series(rec, 1, "vg-lv1", 3 | DM_STATS_WALK_GROUP, bounds));
+	T_ASSERT(!dm_stats_record_set_series(rec, 2, "vg-lv2", 0, NULL));
+
+	/* Six samples in a four sample ring: samples 3..6 are retained. */
+	_fill(rec, 6);
+
+	T_ASSERT(rd = dm_stats_record_open(path));
+	T_ASSERT_EQUAL(dm_stats_record_get_nr_series(rd), 2);
+	T_ASSERT_EQUAL(dm_stats_record_get_nr_samples(rd), 4);
+	T_ASSERT(!strcmp(dm_stats_record_get_series_name(rd, 1), "vg-lv1"));
+	T_ASSERT_EQUAL(dm_stats_record_get_series_id(rd, 1), 3 | DM_STATS_WALK_GROUP);
+
+	T_ASSERT(dm_stats_record_get_counter(rd, 0, DM_STATS_READS_COUNT, 0, 0, &v));
+	T_ASSERT_EQUAL(v, 3 + 4 + 5 + 6);
+	T_ASSERT(dm_stats_record_get_counter(rd, 1, DM_STATS_WRITES_COUNT, 0, 0, &v));
+	T_ASSERT_EQUAL(v, 4 * 10);
+
+	/* Window covering samples 4 and 5 only. */
+	T_ASSERT(dm_stats_record_get_counter(rd, 0, DM_STATS_READS_COUNT, 4000, 5000, &v));
+	T_ASSERT_EQUAL(v, 4 + 5);
+
+	/* Samples 3..6 put 100 I/Os in bins 2, 0, 1, 2. */
+	T_ASSERT(dm_stats_record_get_percentile(rd, 0, 25.0, 0, 0, &v));
+	T_ASSERT_EQUAL(v, 10);
+	T_ASSERT(dm_stats_record_get_percentile(rd, 0, 40.0, 0, 0, &v));
+	T_ASSERT_EQUAL(v, 16);
+	/* The last bin is open ended: its lower bound is reported. */
+	T_ASSERT(dm_stats_record_get_percentile(rd, 0, 99.0, 0, 0, &v));
+	T_ASSERT_EQUAL(v, 20);
+	/* Window with samples 4 and 5 only. */
+	T_ASSERT(dm_stats_record_get_percentile(rd, 0, 50.0, 4000, 5000, &v));
+	T_ASSERT_EQUAL(v, 10);
+	/* No samples in window. */
+	T_ASSERT(dm_stats_record_get_percentile(rd, 0, 50.0, 10000, 0, &v));
+	T_ASSERT_EQUAL(v, 0);
+	T_ASSERT(!dm_stats_record_get_percentile(rd, 0, 0.0, 0, 0, &v));
+
+	/* Readers cannot write. */
+	T_ASSERT(!dm_stats_record_commit(rd, 0, 0));
+
+	/* Only one writer at a time. */
+	T_ASSERT(!dm_stats_record_create(path, 2, 3, 4));
+
+	dm_stats_record_close(rec);
+
+	/* Reopening with the same layout continues the ring. */
+	T_ASSERT(rec = dm_stats_record_create(path, 2, 3, 4));
+	_fill(rec, 1);
+	T_ASSERT(dm_stats_record_get_counter(rd, 0, DM_STATS_READS_COUNT, 0, 0, &v));
+	T_ASSERT_EQUAL(v, 4 + 5 + 6 + 1);
+
+	dm_stats_record_close(rec);
+	dm_stats_record_close(rd);
+
+	/* A different layout recreates the file without the old samples. */
+	T_ASSERT(rec = dm_stats_record_create(path, 2, 3, 8));
+	T_ASSERT(rd = dm_stats_record_open(path));
+	T_ASSERT_EQUAL(dm_stats_record_get_nr_samples(rd), 0);
+	_fill(rec, 6);
+	T_ASSERT_EQUAL(dm_stats_record_get_nr_samples(rd), 6);
+	T_ASSERT(dm_stats_record_get_counter(rd, 0, DM_STATS_READS_COUNT, 0, 0, &v));
+	T_ASSERT_EQUAL(v, 1 + 2 + 3 + 4 + 5 + 6);
+
+	dm_stats_record_close(rec);
+	dm_stats_record_close(rd);
+	dm_histogram_bounds_destroy(bounds);
+}
+
+void dm_stats_record_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(_record_init, _record_exit);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	register_test(ts, "/device-mapper/stats/record", "stats record ring buffer", _test_ring);
+	dm_list_add(all_tests, &ts->list);
+}
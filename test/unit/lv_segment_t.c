@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "units.h"
+#include "lib/misc/lib.h"
+#include "lib/metadata/metadata.h"
+#include "lib/metadata/lv_alloc.h"
+#include "lib/metadata/segtype.h"
+
+#include <stdlib.h>
+
+struct fixture {
+	struct dm_pool *mem;
+	struct volume_group *vg;
+	struct logical_volume *lv;
+	struct segment_type striped;
+	struct segment_type raid1;
+};
+
+static void *_seg_init(void)
+{
+	struct fixture *f = zalloc(sizeof(*f));
+
+	T_ASSERT(f);
+	T_ASSERT(f->mem = dm_pool_create("lv_segment", 1024));
+	T_ASSERT(f->vg = dm_pool_zalloc(f->mem, sizeof(*f->vg)));
+	T_ASSERT(f->lv = dm_pool_zalloc(f->mem, sizeof(*f->lv)));
+	f->vg->vgmem = f->mem;
+	f->lv->vg = f->vg;
+	f->striped.name = SEG_TYPE_NAME_STRIPED;
+	f->striped.flags = SEG_AREAS_STRIPED;
+	f->raid1.name = SEG_TYPE_NAME_RAID1;
+	f->raid1.flags = SEG_RAID | SEG_RAID1 | SEG_AREAS_MIRRORED;
+
+	return f;
+}
+
+static void _seg_exit(void *fixture)
+{
+	struct fixture *f = fixture;
+
+	dm_pool_destroy(f->mem);
+	free(f);
+}
+
+static struct lv_segment *_alloc(struct fixture *f, const struct segment_type *segtype,
+				 uint32_t area_count)
+{
+	return alloc_lv_segment(segtype, f->lv, 0, 1, 0, 0, 0, NULL,
+				area_count, 1, 0, 0, 0, 0, NULL);
+}
+
+static void _test_size(void *fixture)
+{
+	struct fixture *f = fixture;
+	size_t seg = sizeof(struct lv_segment), area = sizeof(struct lv_segment_area);
+
+	T_ASSERT_EQUAL(lv_segment_size(&f->striped, 0), seg);
+	T_ASSERT_EQUAL(lv_segment_size(&f->striped, 4), seg + 4 * area);
+	/* raid with metadata areas: rimage and rmeta areas */
+	T_ASSERT_EQUAL(lv_segment_size(&f->raid1, 3), seg + 6 * area);
+}
+
+static void _test_one_block(void *fixture)
+{
+	struct fixture *f = fixture;
+	struct lv_segment *seg;
+
+	T_ASSERT(seg = _alloc(f, &f->striped, 4));
+	T_ASSERT(seg->areas == (struct lv_segment_area *) (seg + 1));
+	T_ASSERT(!seg->meta_areas);
+	T_ASSERT_EQUAL(seg->area_count, 4);
+	T_ASSERT_EQUAL(seg->data_copies, 1);
+
+	T_ASSERT(seg = _alloc(f, &f->raid1, 3));
+	T_ASSERT(seg->areas == (struct lv_segment_area *) (seg + 1));
+	T_ASSERT(seg->meta_areas == seg->areas + 3);
+	T_ASSERT_EQUAL(seg->data_copies, 3);
+}
+
+/* Segments of one LV laid out back to back, as metadata import does */
+static void _test_reserved(void *fixture)
+{
+	struct fixture *f = fixture;
+	struct volume_group *vg = f->vg;
+	struct lv_segment *seg1, *seg2, *seg3, *seg4;
+	size_t size1 = lv_segment_size(&f->striped, 1);
+	size_t size2 = lv_segment_size(&f->striped, 2);
+	size_t size3 = lv_segment_size(&f->raid1, 2);
+	char *block;
+
+	T_ASSERT(block = dm_pool_alloc(f->mem, size1 + size2 + size3));
+	memset(block, 0xff, size1 + size2 + size3);
+	vg->seg_arena = block;
+	vg->seg_arena_end = block + size1 + size2 + size3;
+
+	T_ASSERT(seg1 = _alloc(f, &f->striped, 1));
+	T_ASSERT(seg2 = _alloc(f, &f->striped, 2));
+	T_ASSERT(seg3 = _alloc(f, &f->raid1, 2));
+
+	T_ASSERT((char *) seg1 == block);
+	T_ASSERT((char *) seg2 == block + size1);
+	T_ASSERT((char *) seg3 == block + size1 + size2);
+	T_ASSERT(vg->seg_arena == vg->seg_arena_end);
+
+	/* Reused block is cleared */
+	T_ASSERT(!seg2->le && !seg2->status && !seg2->log_lv);
+	T_ASSERT(!seg2->areas[1].type);
+	T_ASSERT(!seg3->meta_areas[1].type);
+
+	/* Exhausted reservation falls back to the pool */
+	T_ASSERT(seg4 = _alloc(f, &f->striped, 1));
+	T_ASSERT(((char *) seg4 < block) || ((char *) seg4 >= block + size1 + size2 + size3));
+	T_ASSERT(vg->seg_arena == vg->seg_arena_end);
+
+	vg->seg_arena = vg->seg_arena_end = NULL;
+}
+
+#define T(path, desc, fn) register_test(ts, "/metadata/lv_segment/" path, desc, fn)
+
+void lv_segment_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(_seg_init, _seg_exit);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	T("size", "segment block size", _test_size);
+	T("one-block", "segment and areas in one block", _test_one_block);
+	T("reserved", "segments carved from a reserved block", _test_reserved);
+
+	dm_list_add(all_tests, &ts->list);
+}
@@ -18,6 +18,8 @@
 
 #include "matcher_data.h"
 
+#include <unistd.h>
+
 static void *_mem_init(void)
 {
 	struct dm_pool *mem = dm_pool_create("regex test", 1024);
@@ -129,6 +131,59 @@ static void test_invalid_patterns(void *fixture)
 	}
 }
 
+static struct dm_regex *make_cached_scanner(struct dm_pool *mem, const char * const *rx,
+					    const char *cache_file)
+{
+	struct dm_regex *scanner;
+	int nrx = 0;
+	for (; rx[nrx]; ++nrx);
+
+	scanner = dm_regex_create_cached(mem, rx, nrx, cache_file);
+	T_ASSERT(scanner != NULL);
+	return scanner;
+}
+
+static void test_cache_file(void *fixture)
+{
+	struct dm_pool *mem = fixture;
+	struct dm_regex *built, *loaded;
+	char fname[32];
+	int fd, i;
+
+	snprintf(fname, sizeof(fname), "unit-test-XXXXXX");
+	/* coverity[secure_temp] don't care */
+	fd = mkstemp(fname);
+	T_ASSERT(fd >= 0);
+	(void) close(fd);
+
+	/* Empty file is not a valid cache, dfa is built and saved. */
+	built = make_cached_scanner(mem, dev_patterns, fname);
+	loaded = make_cached_scanner(mem, dev_patterns, fname);
+	T_ASSERT_EQUAL(dm_regex_fingerprint(loaded), 0xc0f6e9d0);
+	for (i = 0; devices[i].str; ++i) {
+		T_ASSERT_EQUAL(dm_regex_match(built, devices[i].str), devices[i].expected - 1);
+		T_ASSERT_EQUAL(dm_regex_match(loaded, devices[i].str), devices[i].expected - 1);
+	}
+	dm_regex_destroy(built);
+	dm_regex_destroy(loaded);
+
+	/* Different patterns replace the cache. */
+	built = make_cached_scanner(mem, nonprint_patterns, fname);
+	loaded = make_cached_scanner(mem, nonprint_patterns, fname);
+	for (i = 0; nonprint[i].str; ++i)
+		T_ASSERT_EQUAL(dm_regex_match(loaded, nonprint[i].str), nonprint[i].expected - 1);
+	dm_regex_destroy(built);
+	dm_regex_destroy(loaded);
+
+	built = make_cached_scanner(mem, random_patterns, fname);
+	loaded = make_cached_scanner(mem, random_patterns, fname);
+	T_ASSERT_EQUAL(dm_regex_fingerprint(loaded), 0xeae862bc);
+	dm_regex_destroy(built);
+	dm_regex_destroy(loaded);
+
+	(void) unlink(fname);
+}
+
 #define T(path, desc, fn) register_test(ts, "/base/regex/" path, desc, fn)
 
 void regex_tests(struct dm_list *all_tests)
@@ -143,6 +198,7 @@ void regex_tests(struct dm_list *all_tests)
 	T("invalid-patterns", "test that invalid regexes are rejected", test_invalid_patterns);
 	T("matching", "test the matcher with a variety of regexes", test_matching);
 	T("kabi-query", "test the matcher with some specific patterns", test_kabi_query);
+	T("cache-file", "test the matcher with dfa saved to and mapped from file", test_cache_file);
 
 	dm_list_add(all_tests, &ts->list);
 }
@@ -1015,6 +1015,66 @@ static void test_overwrite_value_chain(void *fixture)
 	radix_tree_destroy(rt);
 }
 
+static void test_node16_lookup(void *fixture)
+{
+	struct radix_tree *rt = fixture;
+	union radix_value v;
+	unsigned i, nr;
+	uint8_t k;
+
+	/* 5..16 keys make a node16, check both present and missing keys */
+	for (nr = 1; nr <= 16; nr++) {
+		k = (uint8_t) (nr * 7);
+		v.n = nr;
+		T_ASSERT(radix_tree_insert(rt, &k, 1, v));
+		for (i = 0; i < 256; i++) {
+			k = (uint8_t) i;
+			if ((i % 7) || !i || (i / 7 > nr))
+				T_ASSERT(!radix_tree_lookup(rt, &k, 1, &v));
+			else {
+				T_ASSERT(radix_tree_lookup(rt, &k, 1, &v));
+				T_ASSERT_EQUAL(v.n, i / 7);
+			}
+		}
+	}
+	T_ASSERT(radix_tree_is_well_formed(rt));
+}
+
+static uint64_t _rand64(uint64_t *state)
+{
+	/* xorshift64* */
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+
+	return *state * UINT64_C(2685821657736338717);
+}
+
+static void test_random_u64_keys(void *fixture)
+{
+	struct radix_tree *rt = fixture;
+	uint64_t state = 1, k;
+	union radix_value v;
+	unsigned i;
+
+	/* Inserted keys have the top bit clear */
+	for (i = 0; i < 10000; i++) {
+		k = _rand64(&state) >> (1 + i % 63);
+		v.n = k;
+		T_ASSERT(radix_tree_insert(rt, &k, sizeof(k), v));
+	}
+
+	state = 1;
+	for (i = 0; i < 10000; i++) {
+		k = _rand64(&state) >> (1 + i % 63);
+		T_ASSERT(radix_tree_lookup(rt, &k, sizeof(k), &v));
+		T_ASSERT_EQUAL(v.n, k);
+		/* ... so with the top bit set they were never inserted */
+		k |= UINT64_C(0x8000000000000000);
+		T_ASSERT(!radix_tree_lookup(rt, &k, sizeof(k), &v));
+	}
+}
+
 /*----------------------------------------------------------------*/
 #define T(path, desc, fn) register_test(ts, "/base/data-struct/radix-tree/" path, desc, fn)
 
@@ -1055,6 +1115,8 @@ void radix_tree_tests(struct dm_list *all_tests)
 	T("prefix-chain-split-zero", "prefix chain split with zero-length remainder", test_prefix_chain_split_zero);
 	T("overwrite-calls-dtr", "overwrite calls destructor for old value", test_overwrite_calls_dtr);
 	T("overwrite-value-chain", "overwrite a prefix key stored as value chain", test_overwrite_value_chain);
+	T("node16-lookup", "lookup keys in node16 with all fill levels", test_node16_lookup);
+	T("random-u64-keys", "lookup random 8 byte keys", test_random_u64_keys);
 
 	dm_list_add(all_tests, &ts->list);
 }
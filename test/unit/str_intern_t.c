@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "units.h"
+#include "lib/misc/lib.h"
+#include "lib/commands/toolcontext.h"
+#include "lib/datastruct/str_intern.h"
+
+#include <stdlib.h>
+
+#define NR_STRINGS 10000
+
+static void _name(char *buf, size_t len, unsigned i)
+{
+	(void) snprintf(buf, len, "lv_tag_%u", i);
+}
+
+/* Interned copies do not move while the table grows */
+static void _test_stable(void *fixture)
+{
+	struct str_intern *si = str_intern_create();
+	const char **strs;
+	char buf[32];
+	unsigned i;
+
+	T_ASSERT(si);
+	T_ASSERT(strs = malloc(NR_STRINGS * sizeof(*strs)));
+
+	for (i = 0; i < NR_STRINGS; i++) {
+		_name(buf, sizeof(buf), i);
+		T_ASSERT(strs[i] = str_intern(si, buf));
+		/* The caller's buffer may be reused */
+		memset(buf, 'x', sizeof(buf) - 1);
+	}
+
+	T_ASSERT_EQUAL(str_intern_get_count(si), NR_STRINGS);
+	T_ASSERT_EQUAL(str_intern_get_hits(si), 0);
+
+	for (i = 0; i < NR_STRINGS; i++) {
+		_name(buf, sizeof(buf), i);
+		T_ASSERT(!strcmp(strs[i], buf));
+		T_ASSERT(str_intern(si, buf) == strs[i]);
+	}
+
+	/* Every second lookup was served by a shared copy */
+	T_ASSERT_EQUAL(str_intern_get_count(si), NR_STRINGS);
+	T_ASSERT_EQUAL(str_intern_get_hits(si), NR_STRINGS);
+
+	free(strs);
+	str_intern_destroy(si);
+}
+
+/* Strings differing only past a common prefix are separate entries */
+static void _test_prefix(void *fixture)
+{
+	struct str_intern *si = str_intern_create();
+	const char *a, *b, *c;
+
+	T_ASSERT(si);
+	T_ASSERT(a = str_intern(si, "vg0"));
+	T_ASSERT(b = str_intern(si, "vg"));
+	T_ASSERT(c = str_intern(si, "vg00"));
+	T_ASSERT(a != b && a != c && b != c);
+	T_ASSERT(!strcmp(a, "vg0") && !strcmp(b, "vg") && !strcmp(c, "vg00"));
+	T_ASSERT_EQUAL(str_intern_get_count(si), 3);
+	T_ASSERT_EQUAL(str_intern_get_hits(si), 0);
+
+	str_intern_destroy(si);
+}
+
+/* Tables are independent, destroying one leaves the other's copies valid */
+static void _test_separate(void *fixture)
+{
+	struct str_intern *si1 = str_intern_create();
+	struct str_intern *si2 = str_intern_create();
+	const char *a, *b;
+
+	T_ASSERT(si1 && si2);
+	T_ASSERT(a = str_intern(si1, "lvol0"));
+	T_ASSERT(b = str_intern(si2, "lvol0"));
+	T_ASSERT(a != b);
+	T_ASSERT_EQUAL(str_intern_get_hits(si1), 0);
+	T_ASSERT_EQUAL(str_intern_get_hits(si2), 0);
+
+	str_intern_destroy(si1);
+	T_ASSERT(!strcmp(b, "lvol0"));
+	T_ASSERT(str_intern(si2, "lvol0") == b);
+	T_ASSERT_EQUAL(str_intern_get_hits(si2), 1);
+
+	str_intern_destroy(si2);
+	str_intern_destroy(NULL);
+}
+
+/* Per-command table is created on first use and dropped by a reset */
+static void _test_cmd_reset(void *fixture)
+{
+	struct cmd_context *cmd = zalloc(sizeof(*cmd));
+	const char *a, *b;
+
+	T_ASSERT(cmd);
+
+	/* Nothing to release before the first string */
+	cmd_intern_reset(cmd);
+	T_ASSERT(!cmd->str_intern);
+
+	T_ASSERT(a = cmd_intern_str(cmd, "vg0"));
+	T_ASSERT(cmd->str_intern);
+	T_ASSERT(cmd_intern_str(cmd, "vg0") == a);
+	T_ASSERT_EQUAL(str_intern_get_count(cmd->str_intern), 1);
+	T_ASSERT_EQUAL(str_intern_get_hits(cmd->str_intern), 1);
+
+	cmd_intern_reset(cmd);
+	T_ASSERT(!cmd->str_intern);
+	cmd_intern_reset(cmd);
+
+	/* Next command starts with an empty table */
+	T_ASSERT(b = cmd_intern_str(cmd, "vg0"));
+	T_ASSERT(!strcmp(b, "vg0"));
+	T_ASSERT_EQUAL(str_intern_get_count(cmd->str_intern), 1);
+	T_ASSERT_EQUAL(str_intern_get_hits(cmd->str_intern), 0);
+
+	cmd_intern_reset(cmd);
+	free(cmd);
+}
+
+#define T(path, desc, fn) register_test(ts, "/base/data-struct/str-intern/" path, desc, fn)
+
+void str_intern_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(NULL, NULL);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	T("stable", "interned copies stay valid while the table grows", _test_stable);
+	T("prefix", "strings sharing a prefix are separate", _test_prefix);
+	T("separate", "tables have independent lifetimes", _test_separate);
+	T("cmd-reset", "per-command table is released by a reset", _test_cmd_reset);
+
+	dm_list_add(all_tests, &ts->list);
+}
@@ -14,7 +14,10 @@
 
 #include "units.h"
 #include "libdm/libdevmapper.h"
+#include "lib/datastruct/str_intern.h"
+#include "lib/misc/lvm-string.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -74,6 +77,80 @@ static void test_asprint(void *fixture)
 	free(buf);
 }
 
+static void test_intern(void *fixture)
+{
+	struct str_intern *si = str_intern_create();
+	char buf[16] = "lvol0";
+	const char *a, *b, *c;
+
+	T_ASSERT(si);
+	T_ASSERT(a = str_intern(si, "lvol0"));
+	T_ASSERT(b = str_intern(si, buf));
+	T_ASSERT(c = str_intern(si, "lvol1"));
+	T_ASSERT(a == b);
+	T_ASSERT(a != c);
+	T_ASSERT(a != buf);
+	T_ASSERT(!strcmp(a, "lvol0"));
+	T_ASSERT(!strcmp(c, "lvol1"));
+	T_ASSERT(str_intern(si, "") == str_intern(si, ""));
+	T_ASSERT_EQUAL(str_intern_get_count(si), 3);
+	T_ASSERT_EQUAL(str_intern_get_hits(si), 2);
+
+	str_intern_destroy(si);
+}
+
+__attribute__((format(printf, 3, 4)))
+static int _simple(char *buf, size_t size, const char *fmt, ...)
+{
+	va_list ap;
+	int r;
+
+	va_start(ap, fmt);
+	r = vsnprintf_simple(buf, size, fmt, ap);
+	va_end(ap);
+
+	return r;
+}
+
+/* Compares vsnprintf_simple() with snprintf() for the same arguments */
+#define CHECK_SIMPLE(fmt, ...) \
+	do { \
+		char _want[128], _got[128]; \
+		int _n = snprintf(_want, sizeof(_want), fmt, __VA_ARGS__); \
+		T_ASSERT_EQUAL(_simple(_got, sizeof(_got), fmt, __VA_ARGS__), _n); \
+		T_ASSERT(!strcmp(_got, _want)); \
+	} while (0)
+
+static void test_vsnprintf_simple(void *fixture)
+{
+	const char *volatile null_str = NULL;
+	char buf[8];
+
+	CHECK_SIMPLE("%s", "");
+	CHECK_SIMPLE("id = \"%s\"", "KNCEDE-S0YZ-lJxG-bWvg-BZ1C-8X11-beAeiC");
+	CHECK_SIMPLE("seqno = %u", 0U);
+	CHECK_SIMPLE("seqno = %u", UINT_MAX);
+	CHECK_SIMPLE("major = %d", -1);
+	CHECK_SIMPLE("%d %i", INT_MIN, INT_MAX);
+	CHECK_SIMPLE("%ld %lu", LONG_MIN, ULONG_MAX);
+	CHECK_SIMPLE("%lld %llu", LLONG_MIN, ULLONG_MAX);
+	CHECK_SIMPLE("pe_start = %llu", (unsigned long long) 2048);
+	CHECK_SIMPLE("\"%s\", %u%s", "pv0", 12345U, ",");
+	CHECK_SIMPLE("100%% of %s", "pool");
+
+	/* Output that does not fit including the terminating NUL */
+	T_ASSERT_EQUAL(_simple(buf, sizeof(buf), "%s", "1234567"), 7);
+	T_ASSERT_EQUAL(_simple(buf, sizeof(buf), "%s", "12345678"), -1);
+	T_ASSERT_EQUAL(_simple(buf, sizeof(buf), "%u", 12345678U), -1);
+	T_ASSERT_EQUAL(_simple(buf, 0, "%s", ""), -1);
+
+	/* Everything else is left to vsnprintf() */
+	T_ASSERT_EQUAL(_simple(buf, sizeof(buf), "%x", 10U), -2);
+	T_ASSERT_EQUAL(_simple(buf, sizeof(buf), "%5u", 10U), -2);
+	T_ASSERT_EQUAL(_simple(buf, sizeof(buf), "%.2s", "abc"), -2);
+	T_ASSERT_EQUAL(_simple(buf, sizeof(buf), "%s", null_str), -2);
+}
+
 #define T(path, desc, fn) register_test(ts, "/base/data-struct/string/" path, desc, fn)
 
 void string_tests(struct dm_list *all_tests)
@@ -86,6 +163,8 @@ void string_tests(struct dm_list *all_tests)
 
 	T("asprint", "tests asprint", test_asprint);
 	T("strncpy", "tests string copying", test_strncpy);
+	T("intern", "tests string interning", test_intern);
+	T("vsnprintf-simple", "hand-rolled formatting matches snprintf", test_vsnprintf_simple);
 
 	dm_list_add(all_tests, &ts->list);
 }
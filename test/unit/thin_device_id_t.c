@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "units.h"
+#include "lib/misc/lib.h"
+#include "lib/metadata/metadata.h"
+#include "lib/metadata/segtype.h"
+
+#include <stdlib.h>
+
+struct fixture {
+	struct dm_pool *mem;
+	struct segment_type thin_pool;
+	struct volume_group vg;
+	struct logical_volume pool_lv;
+	struct lv_segment *pool_seg;
+};
+
+static void *_device_id_init(void)
+{
+	struct fixture *f = zalloc(sizeof(*f));
+
+	T_ASSERT(f);
+	T_ASSERT(f->mem = dm_pool_create("thin_device_id", 1024));
+	f->thin_pool.name = SEG_TYPE_NAME_THIN_POOL;
+	f->thin_pool.flags = SEG_THIN_POOL;
+	f->vg.vgmem = f->mem;
+	f->pool_lv.vg = &f->vg;
+	dm_list_init(&f->pool_lv.segs_using_this_lv);
+	T_ASSERT(f->pool_seg = dm_pool_zalloc(f->mem, sizeof(*f->pool_seg)));
+	f->pool_seg->segtype = &f->thin_pool;
+	f->pool_seg->lv = &f->pool_lv;
+	dm_list_init(&f->pool_seg->thin_messages);
+
+	return f;
+}
+
+static void _device_id_exit(void *fixture)
+{
+	struct fixture *f = fixture;
+
+	dm_pool_destroy(f->mem);
+	free(f);
+}
+
+/* Thin LV with device_id using the pool */
+static void _add_thin(struct fixture *f, uint32_t device_id)
+{
+	struct seg_list *sl;
+
+	T_ASSERT(sl = dm_pool_zalloc(f->mem, sizeof(*sl)));
+	T_ASSERT(sl->seg = dm_pool_zalloc(f->mem, sizeof(*sl->seg)));
+	sl->seg->device_id = device_id;
+	sl->count = 1;
+	dm_list_add(&f->pool_lv.segs_using_this_lv, &sl->list);
+}
+
+static void _add_delete_message(struct fixture *f, uint32_t device_id)
+{
+	struct lv_thin_message *tmsg;
+
+	T_ASSERT(tmsg = dm_pool_zalloc(f->mem, sizeof(*tmsg)));
+	tmsg->type = DM_THIN_MESSAGE_DELETE;
+	tmsg->u.delete_id = device_id;
+	dm_list_add(&f->pool_seg->thin_messages, &tmsg->list);
+}
+
+static void _test_empty(void *fixture)
+{
+	struct fixture *f = fixture;
+
+	/* Device_id 0 is never used */
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 1);
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 2);
+}
+
+static void _test_holes(void *fixture)
+{
+	struct fixture *f = fixture;
+
+	_add_thin(f, 1);
+	_add_thin(f, 2);
+	_add_thin(f, 4);
+	_add_thin(f, 7);
+	/* Removed, but the pool still has to delete it */
+	_add_delete_message(f, 5);
+
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 3);
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 6);
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 8);
+}
+
+static void _test_add(void *fixture)
+{
+	struct fixture *f = fixture;
+
+	_add_thin(f, 1);
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 2);
+
+	/* Attached after the bitset was built */
+	T_ASSERT(thin_pool_device_id_add(f->pool_seg, 3));
+	T_ASSERT(thin_pool_device_id_add(f->pool_seg, 5000));
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 4);
+	T_ASSERT(*f->pool_seg->thin_device_ids > 5000);
+	T_ASSERT(dm_bit(f->pool_seg->thin_device_ids, 5000));
+}
+
+/* Full words are skipped and the bitset grows past its end */
+static void _test_grow(void *fixture)
+{
+	struct fixture *f = fixture;
+	dm_bitset_t bs;
+	unsigned size;
+	uint32_t id;
+
+	for (id = 1; id < 1024; id++)
+		_add_thin(f, id);
+
+	/* Sized for the highest used device_id, all bits used */
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 1024);
+	bs = f->pool_seg->thin_device_ids;
+	size = *bs;
+	T_ASSERT(size > 1024);
+	for (id = 0; id <= 1024; id++)
+		T_ASSERT(dm_bit(bs, id));
+	T_ASSERT(!dm_bit(bs, 1025));
+
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), 1025);
+
+	/* Up to the end of the grown bitset and across it */
+	for (id = 1026; id < size; id++)
+		T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), id);
+	T_ASSERT(*f->pool_seg->thin_device_ids == size);
+	T_ASSERT_EQUAL(get_free_thin_pool_device_id(f->pool_seg), size);
+	T_ASSERT(*f->pool_seg->thin_device_ids > size);
+
+	/* Bits set before the growth are kept */
+	bs = f->pool_seg->thin_device_ids;
+	for (id = 0; id <= size; id++)
+		T_ASSERT(dm_bit(bs, id));
+	T_ASSERT(!dm_bit(bs, size + 1));
+}
+
+#define T(path, desc, fn) register_test(ts, "/metadata/thin/device-id/" path, desc, fn)
+
+void thin_device_id_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(_device_id_init, _device_id_exit);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	T("empty", "device_ids of an empty pool", _test_empty);
+	T("holes", "free device_ids between used ones are reused", _test_holes);
+	T("add", "device_ids attached after the bitset was built", _test_add);
+	T("grow", "device_id bitset grows across word boundaries", _test_grow);
+
+	dm_list_add(all_tests, &ts->list);
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026 Red Hat, Inc. All rights reserved.
+ *
+ * This file is part of LVM2.
+ *
+ * This copyrighted material is made available to anyone wishing to use,
+ * modify, copy, or redistribute it subject to the terms and conditions
+ * of the GNU General Public License v.2.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "units.h"
+#include "lib/misc/lib.h"
+#include "lib/metadata/metadata.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+struct fixture {
+	char fname[32];
+};
+
+static void *_forecast_init(void)
+{
+	struct fixture *f = malloc(sizeof(*f));
+	int fd;
+
+	T_ASSERT(f);
+	snprintf(f->fname, sizeof(f->fname), "unit-test-XXXXXX");
+	/* coverity[secure_temp] don't care */
+	fd = mkstemp(f->fname);
+	T_ASSERT(fd >= 0);
+	(void) close(fd);
+
+	return f;
+}
+
+static void _forecast_exit(void *fixture)
+{
+	struct fixture *f = fixture;
+
+	(void) unlink(f->fname);
+	free(f);
+}
+
+/* Write forecast as the dmeventd thin plugin does, 'age' seconds ago */
+static void _write(const char *path, long long age, const char *values)
+{
+	FILE *fp;
+
+	T_ASSERT(fp = fopen(path, "w"));
+	fprintf(fp, "%lld %s\n", (long long) time(NULL) - age, values);
+	T_ASSERT(!fclose(fp));
+}
+
+static void _test_read(void *fixture)
+{
+	const char *path = ((struct fixture *) fixture)->fname;
+	int64_t data, metadata;
+
+	_write(path, 0, "3600 7200");
+	T_ASSERT(thin_pool_read_forecast(path, &data, &metadata));
+	/* The clock may tick between write and read */
+	T_ASSERT((data == 3600) || (data == 3599));
+	T_ASSERT((metadata == 7200) || (metadata == 7199));
+
+	/* Not growing */
+	_write(path, 0, "-1 -1");
+	T_ASSERT(thin_pool_read_forecast(path, &data, &metadata));
+	T_ASSERT_EQUAL(data, -1);
+	T_ASSERT_EQUAL(metadata, -1);
+
+	_write(path, 0, "-1 100");
+	T_ASSERT(thin_pool_read_forecast(path, &data, &metadata));
+	T_ASSERT_EQUAL(data, -1);
+	T_ASSERT((metadata == 100) || (metadata == 99));
+}
+
+static void _test_age(void *fixture)
+{
+	const char *path = ((struct fixture *) fixture)->fname;
+	int64_t data, metadata;
+
+	/* Time passed since the forecast is subtracted */
+	_write(path, 60, "3600 30");
+	T_ASSERT(thin_pool_read_forecast(path, &data, &metadata));
+	T_ASSERT((data <= 3540) && (data >= 3538));
+	/* ... down to already full */
+	T_ASSERT_EQUAL(metadata, 0);
+
+	/* Old forecast of a pool no longer monitored */
+	_write(path, 600, "3600 7200");
+	T_ASSERT(!thin_pool_read_forecast(path, &data, &metadata));
+	T_ASSERT_EQUAL(data, -1);
+	T_ASSERT_EQUAL(metadata, -1);
+
+	/* Forecast from the future */
+	_write(path, -600, "3600 7200");
+	T_ASSERT(!thin_pool_read_forecast(path, &data, &metadata));
+	T_ASSERT_EQUAL(data, -1);
+}
+
+static void _test_invalid(void *fixture)
+{
+	const char *path = ((struct fixture *) fixture)->fname;
+	int64_t data = 1, metadata = 1;
+	FILE *fp;
+
+	/* Empty file */
+	T_ASSERT(!thin_pool_read_forecast(path, &data, &metadata));
+	T_ASSERT_EQUAL(data, -1);
+	T_ASSERT_EQUAL(metadata, -1);
+
+	_write(path, 0, "3600");
+	T_ASSERT(!thin_pool_read_forecast(path, &data, &metadata));
+
+	_write(path, 0, "x 3600");
+	T_ASSERT(!thin_pool_read_forecast(path, &data, &metadata));
+
+	T_ASSERT(fp = fopen(path, "w"));
+	fprintf(fp, "garbage\n");
+	T_ASSERT(!fclose(fp));
+	T_ASSERT(!thin_pool_read_forecast(path, &data, &metadata));
+
+	/* Pool not monitored */
+	T_ASSERT(!unlink(path));
+	T_ASSERT(!thin_pool_read_forecast(path, &data, &metadata));
+	T_ASSERT_EQUAL(data, -1);
+}
+
+#define T(path, desc, fn) register_test(ts, "/metadata/thin/forecast/" path, desc, fn)
+
+void thin_forecast_tests(struct dm_list *all_tests)
+{
+	struct test_suite *ts = test_suite_create(_forecast_init, _forecast_exit);
+	if (!ts) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	T("read", "read thin pool forecast", _test_read);
+	T("age", "thin pool forecast ageing", _test_age);
+	T("invalid", "invalid or missing thin pool forecast", _test_invalid);
+
+	dm_list_add(all_tests, &ts->list);
+}
@@ -25,15 +25,24 @@ void bcache_utils_tests(struct dm_list *all_tests);
 void bitset_tests(struct dm_list *all_tests);
 void config_tests(struct dm_list *all_tests);
 void daemon_stray_tests(struct dm_list *all_tests);
+void dm_ioctl_cache_tests(struct dm_list *all_tests);
 void dm_list_tests(struct dm_list *all_tests);
+void dm_task_batch_tests(struct dm_list *all_tests);
+void dm_pool_tests(struct dm_list *all_tests);
 void dm_hash_tests(struct dm_list *all_tests);
 void dm_status_tests(struct dm_list *all_tests);
+void dm_stats_parse_tests(struct dm_list *all_tests);
+void dm_stats_record_tests(struct dm_list *all_tests);
 void io_engine_tests(struct dm_list *all_tests);
+void lv_segment_tests(struct dm_list *all_tests);
 void metadata_security_tests(struct dm_list *all_tests);
 void percent_tests(struct dm_list *all_tests);
 void radix_tree_tests(struct dm_list *all_tests);
 void regex_tests(struct dm_list *all_tests);
 void string_tests(struct dm_list *all_tests);
+void str_intern_tests(struct dm_list *all_tests);
+void thin_device_id_tests(struct dm_list *all_tests);
+void thin_forecast_tests(struct dm_list *all_tests);
 void vdo_tests(struct dm_list *all_tests);
 void vdo_stats_tests(struct dm_list *all_tests);
 
@@ -45,15 +54,24 @@ static inline void register_all_tests(struct dm_list *all_tests)
 	bitset_tests(all_tests);
 	config_tests(all_tests);
 	daemon_stray_tests(all_tests);
+	dm_ioctl_cache_tests(all_tests);
 	dm_list_tests(all_tests);
+	dm_task_batch_tests(all_tests);
+	dm_pool_tests(all_tests);
 	dm_hash_tests(all_tests);
 	dm_status_tests(all_tests);
+	dm_stats_parse_tests(all_tests);
+	dm_stats_record_tests(all_tests);
 	io_engine_tests(all_tests);
+	lv_segment_tests(all_tests);
 	metadata_security_tests(all_tests);
 	percent_tests(all_tests);
 	radix_tree_tests(all_tests);
 	regex_tests(all_tests);
 	string_tests(all_tests);
+	str_intern_tests(all_tests);
+	thin_device_id_tests(all_tests);
+	thin_forecast_tests(all_tests);
 	vdo_tests(all_tests);
 	vdo_stats_tests(all_tests);
 }
@@ -1835,6 +1835,130 @@ out:
 	return ret;
 }
 
+/*
+ * lvcreate --snapshot vg/thin1 vg/thin2 ...
+ * Origin names are passed in lcp->pvs.
+ */
+static int _lvcreate_thin_snapshot_set_single(struct cmd_context *cmd, const char *vg_name,
+					      struct volume_group *vg,
+					      struct processing_handle *handle)
+{
+	struct processing_params *pp = (struct processing_params *) handle->custom_handle;
+	struct lvcreate_params *lp = pp->lp;
+	struct lvcreate_cmdline_params *lcp = pp->lcp;
+	struct dm_list origins;
+	struct lv_list *lvl;
+	uint32_t i;
+
+	dm_list_init(&origins);
+
+	if (!_read_activation_params(cmd, vg, lp))
+		return_ECMD_FAILED;
+
+	for (i = 0; i < lcp->pv_count; ++i) {
+		if (!(lvl = dm_pool_alloc(cmd->mem, sizeof(*lvl))))
+			return_ECMD_FAILED;
+
+		if (!(lvl->lv = find_lv(vg, lcp->pvs[i]))) {
+			log_error("Logical volume %s not found in volume group %s.",
+				  lcp->pvs[i], vg_name);
+			return ECMD_FAILED;
+		}
+
+		dm_list_add(&origins, &lvl->list);
+	}
+
+	if (!lv_create_thin_snapshot_set(vg, &origins, lp->lv_name, lp))
+		return_ECMD_FAILED;
+
+	return ECMD_PROCESSED;
+}
+
+static int _lvcreate_thin_snapshot_set(struct cmd_context *cmd, int argc, char **argv)
+{
+	struct processing_handle *handle = NULL;
+	struct processing_params pp;
+	struct lvcreate_params lp = {
+		.major = -1,
+		.minor = -1,
+	};
+	struct lvcreate_cmdline_params lcp = { 0 };
+	const char *vg_name, *lv_name;
+	const char *tag;
+	struct arg_value_group_list *current_group;
+	int i, ret;
+
+	if (arg_is_set(cmd, major_ARG) || arg_is_set(cmd, minor_ARG)) {
+		log_error("Options --major and --minor are not supported with multiple thin snapshot origins.");
+		return EINVALID_CMD_LINE;
+	}
+
+	dm_list_init(&lp.tags);
+	lp.permission = arg_uint_value(cmd, permission_ARG, LVM_READ | LVM_WRITE);
+	lp.snapshot = 1;
+	if (!(lp.segtype = get_segtype_from_string(cmd, SEG_TYPE_NAME_THIN)))
+		return_ECMD_FAILED;
+
+	/* With a set of origins --name is used as snapshot name suffix */
+	lp.lv_name = arg_str_value(cmd, name_ARG, NULL);
+	if (!validate_restricted_lvname_param(cmd, &lp.vg_name, &lp.lv_name))
+		return EINVALID_CMD_LINE;
+
+	for (i = 0; i < argc; ++i) {
+		vg_name = NULL;
+		lv_name = argv[i];
+		if (!validate_lvname_param(cmd, &vg_name, &lv_name))
+			return EINVALID_CMD_LINE;
+
+		if (!vg_name && !(vg_name = extract_vgname(cmd, NULL))) {
+			log_error("The origin name should include the volume group.");
+			return EINVALID_CMD_LINE;
+		}
+
+		if (lp.vg_name && strcmp(lp.vg_name, vg_name)) {
+			log_error("All thin snapshot origins must be in one volume group.");
+			return EINVALID_CMD_LINE;
+		}
+
+		lp.vg_name = vg_name;
+		argv[i] = (char *) lv_name;
+	}
+
+	dm_list_iterate_items(current_group, &cmd->arg_value_groups) {
+		if (!grouped_arg_is_set(current_group->arg_values, addtag_ARG))
+			continue;
+
+		if (!(tag = grouped_arg_str_value(current_group->arg_values, addtag_ARG, NULL))) {
+			log_error("Failed to get tag.");
+			return EINVALID_CMD_LINE;
+		}
+
+		if (!str_list_add(cmd->mem, &lp.tags, tag)) {
+			log_error("Unable to allocate memory for tag %s.", tag);
+			return ECMD_FAILED;
+		}
+	}
+
+	lcp.pvs = argv;
+	lcp.pv_count = argc;
+	pp.lp = &lp;
+	pp.lcp = &lcp;
+
+	if (!(handle = init_processing_handle(cmd, NULL))) {
+		log_error("Failed to initialize processing handle.");
+		return ECMD_FAILED;
+	}
+
+	handle->custom_handle = &pp;
+
+	ret = process_each_vg(cmd, 0, NULL, lp.vg_name, NULL, READ_FOR_UPDATE, 0, handle,
+			      &_lvcreate_thin_snapshot_set_single);
+
+	destroy_processing_handle(cmd, handle);
+
+	return ret;
+}
+
 int lvcreate(struct cmd_context *cmd, int argc, char **argv)
 {
 	struct processing_handle *handle = NULL;
@@ -1846,6 +1970,9 @@ int lvcreate(struct cmd_context *cmd, int argc, char **argv)
 	struct lvcreate_cmdline_params lcp = { 0 };
 	int ret;
 
+	if ((cmd->command->command_enum == lvcreate_thin_snapshot_CMD) && (argc > 1))
+		return _lvcreate_thin_snapshot_set(cmd, argc, argv);
+
 	if (!_lvcreate_params(cmd, argc, argv, &lp, &lcp)) {
 		ret = EINVALID_CMD_LINE;
 		goto_out;
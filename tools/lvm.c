@@ -338,6 +338,8 @@ int lvm_shell(struct cmd_context *cmd, struct cmdline_context *cmdline)
 			_log_shell_command_status(cmd, ret);
 report_log:
 		log_set_report(NULL);
+		if (!report_format_add_perf(cmd))
+			stack;
 		dm_report_group_output_and_pop_all(cmd->cmd_report.report_group);
 
 		if (cmd->cmd_report.log_rh &&
@@ -348,6 +350,16 @@ report_log:
 			log_error("Failed to add log report.");
 			break;
 		}
+
+		if (cmd->cmd_report.perf_rh &&
+		    !(dm_report_group_push(cmd->cmd_report.report_group,
+					   cmd->cmd_report.perf_rh,
+					   (void *) cmd->cmd_report.perf_name))) {
+			log_error("Failed to add performance report.");
+			break;
+		}
+
+		perf_reset();
 	}
 
 	log_restore_report_state(saved_log_report_state);
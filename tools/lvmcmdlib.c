@@ -88,6 +88,11 @@ int lvm2_run(void *handle, const char *cmdline)
 	else if (!strcmp(cmdline, "_dmeventd_thin_command")) {
 		if (setenv(cmdline, find_config_tree_str(cmd, dmeventd_thin_command_CFG, NULL), 1))
 			ret = ECMD_FAILED;
+	} else if (!strcmp(cmdline, "_dmeventd_thin_forecast")) {
+		char val[16];
+		if ((dm_snprintf(val, sizeof(val), "%d", find_config_tree_int(cmd, dmeventd_thin_forecast_CFG, NULL)) < 0) ||
+		    setenv(cmdline, val, 1))
+			ret = ECMD_FAILED;
 	} else if (!strcmp(cmdline, "_dmeventd_vdo_command")) {
 		if (setenv(cmdline, find_config_tree_str(cmd, dmeventd_vdo_command_CFG, NULL), 1))
 			ret = ECMD_FAILED;
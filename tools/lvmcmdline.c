@@ -3216,6 +3216,7 @@ int lvm_run_command(struct cmd_context *cmd, int argc, char **argv)
 	log_debug("Processing command: %s", cmd->cmd_line);
 	log_debug("Command pid: %d", getpid());
 	log_debug("System ID: %s", cmd->system_id ? : "");
+	log_init_phases(cmd);
 
 #ifdef O_DIRECT_SUPPORT
 	log_debug("O_DIRECT will be used");
@@ -3340,6 +3341,7 @@ int lvm_run_command(struct cmd_context *cmd, int argc, char **argv)
 	 */
 	dm_list_init(&cmd->arg_value_groups);
 	dm_pool_empty(cmd->mem);
+	cmd_intern_reset(cmd);
 
 	reset_lvm_errno(1);
 	reset_log_duplicated();
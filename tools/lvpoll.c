@@ -47,6 +47,7 @@ static int _set_daemon_parms(struct cmd_context *cmd, struct daemon_parms *parms
 	parms->interval = arg_uint_value(cmd, interval_ARG, 0);
 	parms->aborting = arg_is_set(cmd, abort_ARG);
 	parms->progress_display = 1;
+	parms->rescan_vg_only = find_config_tree_bool(cmd, activation_polling_rescan_vg_only_CFG, NULL);
 	parms->wait_before_testing = (arg_sign_value(cmd, interval_ARG, SIGN_NONE) == SIGN_PLUS);
 
 	if (!strcmp(poll_oper, PVMOVE_POLL)) {
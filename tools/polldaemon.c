@@ -130,18 +130,56 @@ static int _nanosleep(unsigned secs, unsigned allow_zero_time)
 	return !sigint_caught();
 }
 
-static int _sleep_and_rescan_devices(struct cmd_context *cmd, struct daemon_parms *parms)
+/*
+ * Rescan only the PVs of the polled VG.  Returns 0 when the VG is not
+ * known or its metadata changed since the previous scan, so the caller
+ * needs a full rescan to catch added or removed PVs.
+ */
+static int _rescan_vg_devices(struct cmd_context *cmd, const char *vgname)
+{
+	uint32_t seqno;
+
+	if (!(seqno = lvmcache_vg_seqno(vgname, NULL)))
+		return 0;
+
+	if (!lvmcache_label_rescan_vg(cmd, vgname, NULL))
+		return 0;
+
+	if (lvmcache_vg_seqno(vgname, NULL) != seqno) {
+		log_debug("Metadata of VG %s changed from seqno %u, rescanning all devices.",
+			  vgname, seqno);
+		return 0;
+	}
+
+	return 1;
+}
+
+static int _sleep_and_rescan_devices(struct cmd_context *cmd, struct daemon_parms *parms,
+				     const char *vgname)
 {
-	if (!parms->aborting) {
+	if (parms->aborting)
+		return 1;
+
+	if (parms->rescan_vg_only) {
+		/* Keep lvmcache for the VG rescan, close device fds before sleeping. */
+		label_scan_drop(cmd);
+		if (!_nanosleep(parms->interval, 0))
+			return_0;
+		if (_rescan_vg_devices(cmd, vgname))
+			return 1;
+		lvmcache_destroy(cmd, 1, 0);
+		label_scan_drop(cmd);
+	} else {
 		/* Free stale cache and close device fds before sleeping. */
 		lvmcache_destroy(cmd, 1, 0);
 		label_scan_drop(cmd);
 		if (!_nanosleep(parms->interval, 0))
 			return_0;
-		if (!lvmcache_label_scan(cmd))
-			stack;
 	}
 
+	if (!lvmcache_label_scan(cmd))
+		stack;
+
 	return 1;
 }
 
@@ -170,7 +208,7 @@ int wait_for_single_lv(struct cmd_context *cmd, const struct poll_operation_id *
 		 * the LV exists immediately on entry.
 		 */
 		if (wait_before_testing && match_uuid &&
-		    !_sleep_and_rescan_devices(cmd, parms)) {
+		    !_sleep_and_rescan_devices(cmd, parms, id->vg_name)) {
 			log_error("ABORTING: Polling interrupted for %s.", id->display_name);
 			return 0;
 		}
@@ -746,6 +784,7 @@ static int _daemon_parms_init(struct cmd_context *cmd, struct daemon_parms *parm
 			    parms->interval);
 
 	parms->progress_display = parms->interval ? 1 : 0;
+	parms->rescan_vg_only = find_config_tree_bool(cmd, activation_polling_rescan_vg_only_CFG, NULL);
 
 	memset(parms->devicesfile, 0, sizeof(parms->devicesfile));
 	if (cmd->devicesfile) {
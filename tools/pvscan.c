@@ -219,55 +219,6 @@ out:
 	return ret;
 }
 
-/*
- * When a device goes offline we only know its major:minor, not its PVID.
- * Since the dev isn't around, we can't read it to get its PVID, so we have to
- * read the PVID files to find the one containing this major:minor and remove
- * that one. This means that the PVID files need to contain the devno's they
- * were created from.
- */
-
-static void _online_pvid_file_remove_devno(unsigned major, unsigned minor)
-{
-	char path[PATH_MAX];
-	char file_vgname[NAME_LEN];
-	DIR *dir;
-	struct dirent *de;
-	unsigned file_major, file_minor;
-
-	log_debug("Remove pv online devno %u:%u", major, minor);
-
-	if (!(dir = opendir(PVS_ONLINE_DIR)))
-		return;
-
-	while ((de = readdir(dir))) {
-		if (de->d_name[0] == '.')
-			continue;
-
-		memset(path, 0, sizeof(path));
-		snprintf(path, sizeof(path), "%s/%s", PVS_ONLINE_DIR, de->d_name);
-
-		file_major = 0;
-		file_minor = 0;
-		memset(file_vgname, 0, sizeof(file_vgname));
-
-		online_pvid_file_read(path, &file_major, &file_minor, file_vgname, NULL);
-
-		if ((file_major == major) && (file_minor == minor)) {
-			log_debug("Unlink pv online %s", path);
-			if (unlink(path) && (errno != ENOENT))
-				log_sys_debug("unlink", path);
-
-			if (file_vgname[0]) {
-				online_vg_file_remove(file_vgname);
-				online_lookup_file_remove(file_vgname);
-			}
-		}
-	}
-	if (closedir(dir))
-		log_sys_debug("closedir", PVS_ONLINE_DIR);
-}
-
 static void _online_files_remove(const char *dirpath)
 {
 	char path[PATH_MAX];
@@ -540,7 +491,6 @@ static int _pvscan_aa_single(struct cmd_context *cmd, const char *vg_name,
 static int _get_devs_from_saved_vg(struct cmd_context *cmd, const char *vgname,
 				   struct dm_list *devs)
 {
-	char path[PATH_MAX];
 	char file_vgname[NAME_LEN];
 	char file_devname[NAME_LEN];
 	char pvid[ID_LEN + 1] __attribute__((aligned(8))) = { 0 };
@@ -566,15 +516,12 @@ static int _get_devs_from_saved_vg(struct cmd_context *cmd, const char *vgname,
 	dm_list_iterate_items(pvl, &vg->pvs) {
 		memcpy(pvid, &pvl->pv->id.uuid, ID_LEN);
 
-		memset(path, 0, sizeof(path));
-		snprintf(path, sizeof(path), "%s/%s", PVS_ONLINE_DIR, pvid);
-
 		file_major = 0;
 		file_minor = 0;
 		memset(file_vgname, 0, sizeof(file_vgname));
 		memset(file_devname, 0, sizeof(file_devname));
 
-		online_pvid_file_read(path, &file_major, &file_minor, file_vgname, file_devname);
+		online_pvid_read(pvid, &file_major, &file_minor, file_vgname, file_devname);
 
 		if (file_vgname[0] && strcmp(vgname, file_vgname)) {
 			log_error_pvscan(cmd, "Wrong VG found for %u:%u PVID %s: %s vs %s",
@@ -951,7 +898,6 @@ static int _get_args_devs(struct cmd_context *cmd, struct dm_list *pvscan_args,
 
 static void _set_pv_devices_online(struct cmd_context *cmd, struct volume_group *vg)
 {
-	char path[PATH_MAX];
 	char file_vgname[NAME_LEN];
 	char file_devname[NAME_LEN];
 	char pvid[ID_LEN+1] = { 0 };
@@ -976,15 +922,12 @@ static void _set_pv_devices_online(struct cmd_context *cmd, struct volume_group
 			continue;
 		}
 
-		memset(path, 0, sizeof(path));
-		snprintf(path, sizeof(path), "%s/%s", PVS_ONLINE_DIR, pvid);
-
 		major = 0;
 		minor = 0;
 		memset(file_vgname, 0, sizeof(file_vgname));
 		memset(file_devname, 0, sizeof(file_devname));
 
-		online_pvid_file_read(path, &major, &minor, file_vgname, file_devname);
+		online_pvid_read(pvid, &major, &minor, file_vgname, file_devname);
 
 		if (file_vgname[0] && strcmp(vg->name, file_vgname)) {
 			log_warn("WARNING: VG %s PV %s wrong vgname in online file %s",
@@ -1009,6 +952,58 @@ static void _set_pv_devices_online(struct cmd_context *cmd, struct volume_group
 	}
 }
 
+/*
+ * Coalesce the autoactivation events of a VG.  Record the PV online using
+ * only the label scan summary, announce this arrival for the VG, and wait
+ * for the coalescing window.  If another PV of the VG arrives meanwhile,
+ * its pvscan takes over and this one is done without reading the VG
+ * metadata or checking the VG.  The last PV to arrive reads the metadata
+ * once and does the completeness check and activation for all of them.
+ *
+ * Returns 1 if this pvscan has handed the VG off to a later one.
+ */
+static int _coalesce_arrival(struct cmd_context *cmd, struct device *dev,
+			     struct lvmcache_info *info, int coalesce_ms)
+{
+	const char *vgname = lvmcache_vgname_from_info(info);
+	uint64_t devsize = 0;
+
+	if (!vgname || is_orphan_vg(vgname))
+		return 0;
+
+	/*
+	 * The md component check normally compares the PV size from the
+	 * metadata, use the size from the PV header instead.  If there is
+	 * any doubt, take the normal path that reads the metadata.
+	 */
+	if (!cmd->use_full_md_check && (cmd->dev_types->md_major != MAJOR(dev->dev)) &&
+	    (!dev_get_size(dev, &devsize) || (devsize != (lvmcache_device_size(info) >> SECTOR_SHIFT))))
+		return 0;
+
+	if (!online_pvid_file_create(cmd, dev, vgname))
+		return 0;
+
+	if (!online_vg_arrival_set(cmd, vgname))
+		return 0;
+
+	log_debug("Waiting %d ms for more PVs from VG %s.", coalesce_ms, vgname);
+	usleep(coalesce_ms * 1000);
+
+	if (online_vg_arrival_is_last(vgname))
+		return 0;
+
+	log_print_pvscan(cmd, "PV %s online, VG %s is handled by a later PV.", dev_name(dev), vgname);
+
+	if (arg_is_set(cmd, listvg_ARG) && arg_is_set(cmd, checkcomplete_ARG)) {
+		if (arg_is_set(cmd, udevoutput_ARG))
+			printf("LVM_VG_NAME_INCOMPLETE='%s'\n", vgname);
+		else
+			log_print("VG %s incomplete", vgname);
+	}
+
+	return 1;
+}
+
 static int _online_devs(struct cmd_context *cmd, int do_all, struct dm_list *pvscan_devs,
 			int *pv_count, struct dm_list *complete_vgnames)
 {
@@ -1035,8 +1030,17 @@ static int _online_devs(struct cmd_context *cmd, int do_all, struct dm_list *pvs
 	int pvs_unknown;
 	int vg_complete = 0;
 	int do_full_check;
+	int coalesce_ms = 0;
 	int ret = 1;
 
+	/*
+	 * Only a single device event that ends in a VG completeness
+	 * check is coalesced; listing LVs needs each device's metadata.
+	 */
+	if (!do_all && do_cache && !do_list_lvs && (dm_list_size(pvscan_devs) == 1) &&
+	    (do_activate || (do_list_vg && do_check_complete)))
+		coalesce_ms = find_config_tree_int(cmd, global_event_activation_coalesce_ms_CFG, NULL);
+
 	dm_list_iterate_items_safe(devl, devl2, pvscan_devs) {
 		dev = devl->dev;
 
@@ -1056,6 +1060,11 @@ static int _online_devs(struct cmd_context *cmd, int do_all, struct dm_list *pvs
 			continue;
 		}
 
+		if ((coalesce_ms > 0) && _coalesce_arrival(cmd, dev, info, coalesce_ms)) {
+			(*pv_count)++;
+			continue;
+		}
+
 		fmt = lvmcache_fmt(info);
 		if (!(fid = fmt->ops->create_instance(fmt, &fic))) {
 			log_error("pvscan[%d] failed to create format instance.", getpid());
@@ -1359,6 +1368,7 @@ static int _pvscan_cache_all(struct cmd_context *cmd, int argc, char **argv,
 	dm_list_init(&pvscan_devs);
 
 	_online_files_remove(PVS_ONLINE_DIR);
+	online_pvid_table_clear();
 	_online_files_remove(VGS_ONLINE_DIR);
 	_online_files_remove(PVS_LOOKUP_DIR);
 
@@ -1458,7 +1468,7 @@ static int _pvscan_cache_args(struct cmd_context *cmd, int argc, char **argv,
 	dm_list_iterate_items(arg, &pvscan_args) {
 		if (arg->dev || !arg->devno)
 			continue;
-		_online_pvid_file_remove_devno(MAJOR(arg->devno), MINOR(arg->devno));
+		online_pvid_remove_devno(MAJOR(arg->devno), MINOR(arg->devno));
 	}
 
 	/*
@@ -1492,6 +1492,20 @@ int devtypes(struct cmd_context *cmd, int argc, char **argv)
 	return _report(cmd, argc, argv, DEVTYPES);
 }
 
+static struct dm_report *_perf_report_init(struct cmd_context *cmd)
+{
+	unsigned report_type = CMDPERF;
+
+	return report_init(NULL, find_config_tree_str(cmd, log_command_perf_cols_CFG, NULL), "",
+			   &report_type, find_config_tree_str(cmd, report_separator_CFG, NULL),
+			   find_config_tree_bool(cmd, report_aligned_CFG, NULL), 1,
+			   (report_headings_t) find_config_tree_int(cmd, report_headings_CFG, NULL),
+			   find_config_tree_bool(cmd, report_prefixes_CFG, NULL),
+			   find_config_tree_bool(cmd, report_quoted_CFG, NULL),
+			   find_config_tree_bool(cmd, report_columns_as_rows_CFG, NULL),
+			   NULL, 1);
+}
+
 #define REPORT_FORMAT_NAME_BASIC "basic"
 #define REPORT_FORMAT_NAME_JSON "json"
 #define REPORT_FORMAT_NAME_JSON_STD "json_std"
@@ -1502,18 +1516,21 @@ int report_format_init(struct cmd_context *cmd)
 	const char *format_str = arg_str_value(cmd, reportformat_ARG, config_format_str);
 	int report_command_log_config_set = find_config_tree_node(cmd, log_report_command_log_CFG, NULL) != NULL;
 	int report_command_log;
+	int report_command_perf;
 	struct report_args args = {0};
 	struct single_report_args *single_args;
 	struct dm_report_group *new_report_group;
 	struct dm_report *tmp_log_rh = NULL;
+	struct dm_report *tmp_perf_rh = NULL;
 	const char * radixchar;
 
 	args.log_only = arg_is_set(cmd, logonly_ARG);
 	report_command_log = args.log_only || find_config_tree_bool(cmd, log_report_command_log_CFG, NULL);
+	report_command_perf = find_config_tree_bool(cmd, log_report_command_perf_CFG, NULL);
 
 	if (!format_str || !strcmp(format_str, REPORT_FORMAT_NAME_BASIC)) {
-		args.report_group_type = (report_command_log && !args.log_only) ? DM_REPORT_GROUP_BASIC
-										: DM_REPORT_GROUP_SINGLE;
+		args.report_group_type = ((report_command_log && !args.log_only) || report_command_perf) ?
+						DM_REPORT_GROUP_BASIC : DM_REPORT_GROUP_SINGLE;
 		cmd->report_strict_type_mode = 0;
 	} else if (!strcmp(format_str, REPORT_FORMAT_NAME_JSON)) {
 		args.report_group_type = DM_REPORT_GROUP_JSON;
@@ -1585,6 +1602,23 @@ int report_format_init(struct cmd_context *cmd)
 		}
 	}
 
+	if (report_command_perf) {
+		if (!(tmp_perf_rh = _perf_report_init(cmd))) {
+			log_error("Failed to create performance report.");
+			goto bad;
+		}
+
+		cmd->cmd_report.perf_name = (args.report_group_type == DM_REPORT_GROUP_BASIC) ?
+						"Command Performance" : "perf";
+
+		if (!(dm_report_group_push(new_report_group, tmp_perf_rh, (void *) cmd->cmd_report.perf_name))) {
+			log_error("Failed to add performance report to report group.");
+			goto bad;
+		}
+
+		cmd->cmd_report.perf_rh = tmp_perf_rh;
+	}
+
 	cmd->cmd_report.report_group = new_report_group;
 	cmd->cmd_report.saved_log_report_state = log_get_report_state();
 	log_set_report(cmd->cmd_report.log_rh);
@@ -1595,11 +1629,31 @@ bad:
 		stack;
 	if (tmp_log_rh)
 		dm_report_free(tmp_log_rh);
+	if (tmp_perf_rh)
+		dm_report_free(tmp_perf_rh);
+	cmd->cmd_report.log_rh = NULL;
 	return 0;
 }
 
+/*
+ * Performance counters are filled in just before the report
+ * group is output so they cover the whole command.
+ */
+int report_format_add_perf(struct cmd_context *cmd)
+{
+	if (!cmd->cmd_report.perf_rh)
+		return 1;
+
+	dm_report_destroy_rows(cmd->cmd_report.perf_rh);
+
+	return report_cmdperf(cmd->cmd_report.perf_rh);
+}
+
 void report_format_destroy(struct cmd_context *cmd)
 {
+	if (!report_format_add_perf(cmd))
+		stack;
+
 	if (!dm_report_group_destroy(cmd->cmd_report.report_group))
 		stack;
 	cmd->cmd_report.report_group = NULL;
@@ -1609,6 +1663,11 @@ void report_format_destroy(struct cmd_context *cmd)
 		cmd->cmd_report.log_rh = NULL;
 	}
 
+	if (cmd->cmd_report.perf_rh) {
+		dm_report_free(cmd->cmd_report.perf_rh);
+		cmd->cmd_report.perf_rh = NULL;
+	}
+
 	if (cmd->cmd_report.lc_numeric_override) {
 		setlocale(LC_NUMERIC, "");
 		cmd->cmd_report.lc_numeric_override = 0;
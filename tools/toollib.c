@@ -2297,6 +2297,42 @@ static int _select_matches(struct processing_handle *handle)
 	return handle->selection_handle->selected;
 }
 
+/*
+ * Commands that only read VGs can have the metadata of the next VGs
+ * parsed on worker threads (report/vg_read_threads) while the current
+ * one is processed.  VGs are still read and processed in list order.
+ */
+static unsigned _vg_prefetch_threads(struct cmd_context *cmd, uint32_t read_flags,
+				     struct dm_list *vgnameids)
+{
+	int threads;
+
+	if (!cmd->can_use_one_scan || (read_flags & (READ_FOR_UPDATE | READ_FOR_ACTIVATE)) ||
+	    (dm_list_size(vgnameids) < 2))
+		return 0;
+
+	threads = find_config_tree_int(cmd, report_vg_read_threads_CFG, NULL);
+
+	if (threads < 2)
+		return 0;
+
+	return (threads > DEFAULT_REP_VG_READ_THREADS_MAX) ? DEFAULT_REP_VG_READ_THREADS_MAX : threads;
+}
+
+static void _vg_prefetch_next(struct cmd_context *cmd, struct dm_list *vgnameids,
+			      struct vgnameid_list *vgnl, unsigned threads, unsigned *left)
+{
+	if (!threads)
+		return;
+
+	if (!*left) {
+		*left = threads * 4;
+		vg_read_prefetch(cmd, vgnameids, vgnl, *left, threads);
+	}
+
+	(*left)--;
+}
+
 static int _process_vgnameid_list(struct cmd_context *cmd, uint32_t read_flags,
 				  struct dm_list *vgnameids_to_process,
 				  struct dm_list *arg_vgnames,
@@ -2321,6 +2357,8 @@ static int _process_vgnameid_list(struct cmd_context *cmd, uint32_t read_flags,
 	int is_lockd;
 	int process_all = 0;
 	int do_report_ret_code = 1;
+	unsigned prefetch_threads = _vg_prefetch_threads(cmd, read_flags, vgnameids_to_process);
+	unsigned prefetch_left = 0;
 
 	log_set_report_object_type(LOG_REPORT_OBJECT_TYPE_VG);
 
@@ -2339,6 +2377,8 @@ static int _process_vgnameid_list(struct cmd_context *cmd, uint32_t read_flags,
 			goto_out;
 		}
 
+		_vg_prefetch_next(cmd, vgnameids_to_process, vgnl, prefetch_threads, &prefetch_left);
+
 		vg_name = vgnl->vg_name;
 		vg_uuid = vgnl->vgid;
 		skip = 0;
@@ -2417,6 +2457,8 @@ endvg:
 	_set_final_selection_result(handle, whole_selected);
 	do_report_ret_code = 0;
 out:
+	if (prefetch_threads)
+		vg_read_prefetch_drop();
 	if (do_report_ret_code)
 		report_log_ret_code(ret_max);
 	log_restore_report_state(saved_log_report_state);
@@ -4017,6 +4059,8 @@ static int _process_lv_vgnameid_list(struct cmd_context *cmd, uint32_t read_flag
 	int notfound;
 	int is_lockd;
 	int do_report_ret_code = 1;
+	unsigned prefetch_threads = _vg_prefetch_threads(cmd, read_flags, vgnameids_to_process);
+	unsigned prefetch_left = 0;
 
 	log_set_report_object_type(LOG_REPORT_OBJECT_TYPE_VG);
 
@@ -4026,6 +4070,8 @@ static int _process_lv_vgnameid_list(struct cmd_context *cmd, uint32_t read_flag
 			goto_out;
 		}
 
+		_vg_prefetch_next(cmd, vgnameids_to_process, vgnl, prefetch_threads, &prefetch_left);
+
 		vg_name = vgnl->vg_name;
 		vg_uuid = vgnl->vgid;
 		skip = 0;
@@ -4119,6 +4165,8 @@ endvg:
 	}
 	do_report_ret_code = 0;
 out:
+	if (prefetch_threads)
+		vg_read_prefetch_drop();
 	if (do_report_ret_code)
 		report_log_ret_code(ret_max);
 	log_restore_report_state(saved_log_report_state);
@@ -4681,6 +4729,8 @@ static int _process_pvs_in_vgs(struct cmd_context *cmd, uint32_t read_flags,
 	int notfound;
 	int is_lockd;
 	int do_report_ret_code = 1;
+	unsigned prefetch_threads = _vg_prefetch_threads(cmd, read_flags, all_vgnameids);
+	unsigned prefetch_left = 0;
 
 	log_set_report_object_type(LOG_REPORT_OBJECT_TYPE_VG);
 
@@ -4690,6 +4740,8 @@ static int _process_pvs_in_vgs(struct cmd_context *cmd, uint32_t read_flags,
 			goto_out;
 		}
 
+		_vg_prefetch_next(cmd, all_vgnameids, vgnl, prefetch_threads, &prefetch_left);
+
 		vg_name = vgnl->vg_name;
 		vg_uuid = vgnl->vgid;
 		skip = 0;
@@ -4770,6 +4822,8 @@ endvg:
 	}
 	do_report_ret_code = 0;
 out:
+	if (prefetch_threads)
+		vg_read_prefetch_drop();
 	if (do_report_ret_code)
 		report_log_ret_code(ret_max);
 	log_restore_report_state(saved_log_report_state);
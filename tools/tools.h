@@ -37,6 +37,7 @@
 #include "lib/locking/locking.h"
 #include "lib/misc/lvm-exec.h"
 #include "lib/misc/lvm-file.h"
+#include "lib/misc/lvm-perf.h"
 #include "lib/misc/lvm-signal.h"
 #include "lib/misc/lvm-string.h"
 #include "lib/metadata/segtype.h"
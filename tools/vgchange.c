@@ -87,14 +87,28 @@ static int _poll_lvs_in_vg(struct cmd_context *cmd,
 static int _activate_lvs_in_vg(struct cmd_context *cmd, struct volume_group *vg,
 			       activation_change_t activate)
 {
-	struct lv_list *lvl;
+	struct lv_list *lvl, *batch_lvl;
 	struct logical_volume *lv;
+	struct dm_list batch;
+	unsigned batch_count;
 	int count = 0, expected_count = 0, r = 1;
+	int use_batch;
+
+	/*
+	 * Simple LVs of a local VG are activated together through one
+	 * deptree instead of building a tree per LV.  Shared VGs need
+	 * per-LV locks and duplicate PVs need the per-LV checks.
+	 */
+	dm_list_init(&batch);
+	use_batch = is_change_activating(activate) && !vg_is_shared(vg) &&
+		!(lvmcache_has_duplicate_devs() && vg_has_duplicate_pvs(vg));
 
 	sigint_allow();
 	dm_list_iterate_items(lvl, &vg->lvs) {
-		if (sigint_caught())
-			return_0;
+		if (sigint_caught()) {
+			r = 0;
+			goto_out;
+		}
 
 		lv = lvl->lv;
 
@@ -129,6 +143,18 @@ static int _activate_lvs_in_vg(struct cmd_context *cmd, struct volume_group *vg,
 
 		expected_count++;
 
+		if (use_batch && lv_can_activate_in_batch(lv)) {
+			if (!(batch_lvl = dm_pool_alloc(cmd->mem, sizeof(*batch_lvl)))) {
+				log_error("Failed to allocate LV list item.");
+				r = 0;
+				goto out;
+			}
+			batch_lvl->lv = lv;
+			dm_list_add(&batch, &batch_lvl->list);
+			log_verbose("Activating logical volume %s.", display_lvname(lv));
+			continue;
+		}
+
 		if (!lv_change_activate(cmd, lv, activate)) {
 			stack;
 			r = 0;
@@ -138,6 +164,15 @@ static int _activate_lvs_in_vg(struct cmd_context *cmd, struct volume_group *vg,
 		count++;
 	}
 
+	if (!dm_list_empty(&batch)) {
+		if (!lv_activate_list(cmd, &batch, &batch_count)) {
+			stack;
+			r = 0;
+		}
+		count += batch_count;
+		set_lv_notify(cmd);
+	}
+out:
 	sigint_restore();
 
 	if (expected_count)